@@ -40,6 +40,7 @@ SOFTWARE.
 #include <gmath/obox.h>
 #include <gmath/frustum.h>
 #include <gmath/sphere.h>
+#include <gmath/bvh.h>
 #include <gmath/polynomial.h>
 #include <gmath/integration.h>
 #include <gmath/linsys.h>
@@ -49,8 +50,21 @@ SOFTWARE.
 #include <gmath/complex.h>
 #include <gmath/curve.h>
 #include <gmath/fft.h>
+#include <gmath/convolution.h>
+#include <gmath/stft.h>
+#include <gmath/dct.h>
+#include <gmath/half.h>
 #include <gmath/color.h>
+#include <gmath/gamut.h>
+#include <gmath/grader.h>
+#include <gmath/colorpipeline.h>
+#include <gmath/lut3d.h>
+#include <gmath/colorstats.h>
+#include <gmath/colordiff.h>
+#include <gmath/quantizer.h>
+#include <gmath/spectrum.h>
 #include <gmath/params.h>
+#include <gmath/parallel.h>
 
 #endif
 
@@ -0,0 +1,126 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_bvh_h_
+#define __gmath_bvh_h_
+
+#include <gmath/aabox.h>
+#include <gmath/ray.h>
+#include <gmath/frustum.h>
+#include <vector>
+
+namespace gmath {
+  
+  // Bounding volume hierarchy over an array of axis aligned boxes.
+  //
+  // Built top-down with the surface area heuristic evaluated over 16 centroid bins per
+  // axis. Top levels bin large ranges in parallel chunks, subtrees below 4096 boxes are
+  // then built in parallel (see Parallel), the result does not depend on the thread count.
+  // Nodes are stored depth first in a flat array of 32 bytes nodes: the first child of
+  // an inner node follows it, the node keeps the index of the second one.
+  //
+  // Queries report indices in the box array given to build(). Ray queries test boxes
+  // unless a primitive callback is given (to test the actual geometry inside a box).
+  
+  class GMATH_API BVH {
+    public:
+      
+      static const size_t InvalidIndex = size_t(-1);
+      
+      struct Node {
+        float bmin[3];
+        // inner node: second child index, leaf: first entry in getIndices()
+        unsigned int offset;
+        float bmax[3];
+        // leaf: number of boxes (inner nodes have 0)
+        unsigned short count;
+        // inner node: split axis (children are visited front to back along it)
+        unsigned short axis;
+      };
+      
+      // Returns true if primitive i is hit at a distance below *dist, updating *dist
+      typedef bool (*RayPrimitiveFunc)(size_t i, const Ray &ray, float *dist, void *userData);
+      
+      BVH();
+      ~BVH();
+      
+      void clear();
+      
+      // maxLeafSize in [1, 255]
+      bool build(const AABox *boxes, size_t n, size_t maxLeafSize=4);
+      // Updates node bounds for moved boxes, keeping the tree topology (same boxes
+      // count and order as build). Quality degrades as boxes move away from their
+      // original place, build again then.
+      bool refit(const AABox *boxes, size_t n);
+      
+      inline size_t getNodeCount() const {
+        return mNodes.size();
+      }
+      
+      inline const Node& getNode(size_t i) const {
+        return mNodes[i];
+      }
+      
+      inline size_t getBoxCount() const {
+        return mIndices.size();
+      }
+      
+      // Box indices referenced by leaves
+      inline const unsigned int* getIndices() const {
+        return (mIndices.empty() ? 0 : &mIndices[0]);
+      }
+      
+      AABox getBounds() const;
+      
+      // Closest box (or primitive) hit by the ray within maxDist, InvalidIndex if none.
+      // Boxes containing the ray origin are hit at distance 0. dist is optional.
+      size_t closestHit(const Ray &ray, float maxDist, float *dist=0, RayPrimitiveFunc func=0, void *userData=0) const;
+      // Any box (or primitive) hit within maxDist, stops at the first one found
+      bool anyHit(const Ray &ray, float maxDist, RayPrimitiveFunc func=0, void *userData=0) const;
+      
+      // Append to indices the boxes that are not outside the frustum (see Frustum::classify),
+      // returns the number of boxes appended
+      size_t query(const Frustum &f, std::vector<size_t> &indices) const;
+      // Append to indices the boxes overlapping box (touching counts)
+      size_t query(const AABox &box, std::vector<size_t> &indices) const;
+      
+    public:
+      
+      struct Bounds {
+        float bmin[3];
+        float bmax[3];
+      };
+      
+    private:
+      
+      std::vector<Node> mNodes;
+      std::vector<unsigned int> mIndices;
+      std::vector<Bounds> mBoxes;
+  };
+  
+}
+
+#endif
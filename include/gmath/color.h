@@ -30,6 +30,7 @@ SOFTWARE.
 #include <gmath/config.h>
 #include <gmath/vector.h>
 #include <gmath/matrix.h>
+#include <gmath/half.h>
 #include <gmath/details/color.h>
 #include <gmath/params.h>
 
@@ -120,6 +121,28 @@ namespace gmath
       // To use LogC gamma with el 160 -> LogC + EL160
       static RGB Linearize(const RGB &c, Function gf=sRGB);
       static RGB Unlinearize(const RGB &c, Function gf=sRGB);
+      
+      // Batch versions working on n values (channels are independent so any pixel layout
+      // works as long as all the values go through the same function). Large batches are
+      // split over threads (see Parallel). in and out may be the same buffer.
+      //
+      // Float values are looked up in per-function tables built on first use: values in
+      // [2^-14, 2^8) are linearly interpolated over 256 segments per octave, 0 is exact and
+      // anything else (negative, tiny, huge, nan) goes through the scalar functions above.
+      // Max error versus the scalar functions, relative to max(1, |value|), is 5e-5: table
+      // segments that would exceed it (around function discontinuities) use the scalar path.
+      // In practice LogC, Cineon and Rec709 Linearize reach 5e-5, all other cases stay below 2e-6.
+      static void Linearize(const float *in, float *out, size_t n, Function gf=sRGB);
+      static void Unlinearize(const float *in, float *out, size_t n, Function gf=sRGB);
+      
+      // Integer code values, c / (2^bits - 1), bits in [1, 16]. Exact (one table entry per code).
+      static void Linearize(const unsigned char *in, float *out, size_t n, Function gf=sRGB);
+      static void Linearize(const unsigned short *in, int bits, float *out, size_t n, Function gf=sRGB);
+      
+      // Quantized to [0, 2^bits - 1] (rounded, clamped) after the float batch path above.
+      // May be one code off the scalar function where it falls right on a rounding boundary.
+      static void Unlinearize(const float *in, unsigned char *out, size_t n, Function gf=sRGB);
+      static void Unlinearize(const float *in, unsigned short *out, int bits, size_t n, Function gf=sRGB);
    };
 
    class GMATH_API ColorSpace
@@ -150,6 +173,41 @@ namespace gmath
       LUV XYZtoLUV(const XYZ &xyz, const Chromaticity &w) const;
       XYZ LUVtoXYZ(const LUV &luv) const;
       XYZ LUVtoXYZ(const LUV &luv, const Chromaticity &w) const;
+      
+      // Batch conversions
+      //   Interleaved: stride is the number of floats from one pixel to the next (3 for RGB,
+      //                4 for RGBA, ...), only the first 3 channels are read and written
+      //   Planar:      one array per channel
+      // in and out may be the same buffer. Large spans are split over threads (see Parallel).
+      // Return false on invalid arguments.
+      bool RGBtoXYZ(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool RGBtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool XYZtoRGB(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool XYZtoRGB(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool RGBtoYUV(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool RGBtoYUV(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool YUVtoRGB(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool YUVtoRGB(const float *const in[3], float *const out[3], size_t npixels) const;
+      // Half float pixels, stride in halves (computations still run in float)
+      bool RGBtoXYZ(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool RGBtoXYZ(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      bool XYZtoRGB(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool XYZtoRGB(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      bool RGBtoYUV(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool RGBtoYUV(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      bool YUVtoRGB(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool YUVtoRGB(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      // LAB and LUV use the color space white point. Cube roots are approximated (relative
+      //   error below 3e-7, L, a, b, u and v within 2e-4 of the scalar versions). Black, which
+      //   has no LUV chromaticity, maps to LUV (0, 0, 0) and back.
+      bool XYZtoLAB(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool XYZtoLAB(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool LABtoXYZ(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool LABtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool XYZtoLUV(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool XYZtoLUV(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool LUVtoXYZ(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool LUVtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const;
 
       const std::string& getName() const;
 
@@ -161,6 +219,9 @@ namespace gmath
       // RGB_Vector = XYZtoRGB_Matrix * XYZ_Vector
       const Matrix3& getRGBtoXYZMatrix() const;
       const Matrix3& getXYZtoRGBMatrix() const;
+      // YUV = RGBtoYUV_Matrix * RGB_Vector
+      Matrix3 getRGBtoYUVMatrix() const;
+      Matrix3 getYUVtoRGBMatrix() const;
 
    public:
 
@@ -211,6 +272,16 @@ namespace gmath
          T Lavg;
          T Lwht;
       };
+      
+      template <typename T>
+      struct ReinhardLocalParamsT
+      {
+         T key;
+         T Lavg;
+         T Lwht;
+         T phi;
+         T threshold;
+      };
    
    public:
       enum Method
@@ -219,7 +290,12 @@ namespace gmath
          Simple,  // params: -                       [L' = L / (1 + L)]
          Linear,  // params: Lmax (0.0)              [L' = L / Lmax]
          Gamma,   // params: gain (1.0), gamma (1.0) [L' = gain * L^gamma]
-         Reinhard // params: key (0.18), Lavg (0.0), Lwht (0.0) (<=0 to disable)
+         Reinhard, // params: key (0.18), Lavg (0.0), Lwht (0.0) (<=0 to disable)
+         ReinhardLocal // params: key (0.18), Lavg (0.0), Lwht (0.0), phi (8.0), threshold (0.05)
+                       //   Reinhard with dodge-and-burn: L' = L * (1 + L / Lwht^2) / (1 + Ladapt)
+                       //   where Ladapt is L averaged over the largest gaussian neighbourhood (8
+                       //   scales, 1.6 ratio) with a center-surround difference below threshold.
+                       //   Only applyImage sees neighbourhoods, per pixel functions use Ladapt = L
       };
       
       typedef LinearParamsT<Params::accessor> LinearParams;
@@ -231,6 +307,9 @@ namespace gmath
       typedef ReinhardParamsT<Params::accessor> ReinhardParams;
       typedef ReinhardParamsT<Params::const_accessor> ReinhardConstParams;
       
+      typedef ReinhardLocalParamsT<Params::accessor> ReinhardLocalParams;
+      typedef ReinhardLocalParamsT<Params::const_accessor> ReinhardLocalConstParams;
+      
    public:
       
       ToneMappingOperator(const ColorSpace &cs=ColorSpace::Rec709);
@@ -243,6 +322,7 @@ namespace gmath
       
       bool isValid() const;
       Method getMethod() const;
+      const ColorSpace& getColorSpace() const;
       void copyParams(Params &params) const;
       
       // when accessing params via the returned pointer don't forget to call
@@ -252,15 +332,58 @@ namespace gmath
       
       RGB operator()(const RGB &input) const;
       XYZ operator()(const XYZ &input) const;
+      
+      // Batch versions of operator()(const RGB&), pixel layouts as ColorSpace batch conversions.
+      //   Parameters are resolved to plain floats by setMethod, updateParams and validate, and
+      //   pixels go from RGB to RGB directly: keeping chromaticity while remapping luminance
+      //   is a scale of the XYZ color by L'/L, which commutes with the RGB/XYZ matrices.
+      void apply(RGB *pixels, size_t n) const;
+      bool apply(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool apply(const float *const in[3], float *const out[3], size_t npixels) const;
+      bool apply(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool apply(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      
+      // Image versions, width * height pixels, rows stored one after the other. Same as apply
+      //   for global methods. Intermediate luminance planes (5 floats per pixel) are allocated
+      //   for ReinhardLocal.
+      bool applyImage(const float *in, float *out, size_t width, size_t height, size_t stride=3) const;
+      bool applyImage(const float *const in[3], float *const out[3], size_t width, size_t height) const;
+      
+      // Block kernel used by the batch functions above (single threaded, in and out may alias)
+      //   Input and output are XYZ if xyz is true, operator color space RGB otherwise
+      void eval(const float *const in[3], float *const out[3], size_t count, bool xyz=false) const;
    
    private:
       ToneMappingOperator& operator=(const ToneMappingOperator&);
-   
+      
+      void compile();
+      
    private:
+      // Resolved parameters, L' = L * scale(L):
+      //   Simple: 1 / (1 + L)
+      //   Linear: k0
+      //   Gamma: k0 * L^k1
+      //   Reinhard: k0 * (1 + k0 * L * k1) / (1 + k0 * L)
+      //   ReinhardLocal: as Reinhard, k2 = 2^phi * key, k3 = threshold
+      struct Compiled
+      {
+         float k0;
+         float k1;
+         float k2;
+         float k3;
+         // RGB to Y, RGB to X + Y + Z and white point RGB (Y = 1) for the XYZ fallback
+         //   of colors too dark to have a chromaticity
+         float lum[3];
+         float sum[3];
+         float white[3];
+         float whiteXYZ[3];
+      };
+      
       const ColorSpace &mColorSpace;
       Method mMethod;
       void *mImpl;
       bool mValid;
+      Compiled mCompiled;
    };
    
    namespace details
@@ -394,6 +517,48 @@ namespace gmath
             return true;
          }
       };
+      
+      template <> struct ToneMappingParams<ToneMappingOperator::ReinhardLocalParams>
+      {
+         static bool Bind(ToneMappingOperator &tmo, void *impl, ToneMappingOperator::ReinhardLocalParams &p)
+         {
+            if (tmo.getMethod() != ToneMappingOperator::ReinhardLocal || !impl)
+            {
+               return false;
+            }
+            ToneMappingOperator::ReinhardLocalParams *pp = (ToneMappingOperator::ReinhardLocalParams *)impl;
+            p = *pp;
+            return true;
+         }
+         
+         static bool Bind(const ToneMappingOperator &, void *, ToneMappingOperator::ReinhardLocalParams &)
+         {
+            return false;
+         }
+      };
+      
+      template <> struct ToneMappingParams<ToneMappingOperator::ReinhardLocalConstParams>
+      {
+         static bool Bind(ToneMappingOperator &tmo, void *impl, ToneMappingOperator::ReinhardLocalConstParams &p)
+         {
+            return Bind((const ToneMappingOperator&)tmo, impl, p);
+         }
+         
+         static bool Bind(const ToneMappingOperator &tmo, void *impl, ToneMappingOperator::ReinhardLocalConstParams &p)
+         {
+            if (tmo.getMethod() != ToneMappingOperator::ReinhardLocal || !impl)
+            {
+               return false;
+            }
+            ToneMappingOperator::ReinhardLocalParams *pp = (ToneMappingOperator::ReinhardLocalParams *)impl;
+            p.key = pp->key;
+            p.Lavg = pp->Lavg;
+            p.Lwht = pp->Lwht;
+            p.phi = pp->phi;
+            p.threshold = pp->threshold;
+            return true;
+         }
+      };
    }
    
    template <class P>
@@ -418,7 +583,8 @@ namespace gmath
       float temperature;
 
       // Note: Using Blackbody::GetXYZ rather than IntegrateVisibleSpectrum(Blackbody(temp))
-      //       enables the use of a cache (1K steps)
+      //       enables the use of a cache (1K steps), filled on demand by blocks of 16K
+      //       (thread safe)
       //   The following environment variable controls the caching
       //     GMATH_BLACKBODY_CACHE: enables blackbody cache (0 or 1, 1 by default)
       //     GMATH_BLACKBODY_CACHE_MAX_TEMPERATURE: set the cache max temperature (20000 by default)
@@ -442,6 +608,49 @@ namespace gmath
       static void OutOfGamutRemap(RGB &col);
       static void Normalize(RGB &col);
    };
+   
+   // Baked Blackbody::GetRGB for fast lookups of many temperatures.
+   //
+   // Colors are sampled uniformly in reciprocal temperature (mired) between minTemp and
+   // maxTemp, where blackbody chromaticity changes at a steady rate, and linearly
+   // interpolated. Temperatures outside the range (and NaNs) are clamped. With normalized
+   // colors and the default 1024 entries over [1000, 40000], channels are within 2e-3 of
+   // GetRGB (the error halves when size doubles, normalization and gamut remapping are
+   // not smooth).
+   class GMATH_API BlackbodyTable
+   {
+   public:
+      BlackbodyTable();
+      ~BlackbodyTable();
+      
+      bool build(const ColorSpace &cs, bool normalize=true, float minTemp=1000.0f, float maxTemp=40000.0f, size_t size=1024);
+      void clear();
+      
+      size_t size() const;
+      float getMinTemperature() const;
+      float getMaxTemperature() const;
+      
+      RGB operator()(float temp) const;
+      
+      // n temperatures to n RGB colors, output layouts as for ColorSpace batch conversions
+      //   Split over threads (see Parallel). Return false on invalid arguments.
+      bool apply(const float *temps, float *rgb, size_t n, size_t stride=3) const;
+      bool apply(const float *temps, float *const rgb[3], size_t n) const;
+   
+   private:
+      BlackbodyTable(const BlackbodyTable&);
+      BlackbodyTable& operator=(const BlackbodyTable&);
+      
+   private:
+      float mMinTemp;
+      float mMaxTemp;
+      // mired of the first entry, entries per mired
+      float mMired0;
+      float mScale;
+      size_t mSize;
+      // size + 1 entries of 4 floats (r, g, b, 0), the last one repeated
+      std::vector<float> mTable;
+   };
 
    // ---
 
@@ -450,6 +659,17 @@ namespace gmath
 
    GMATH_API HSL RGBtoHSL(const RGB &rgb, float epsilon=EPS6);
    GMATH_API HSV RGBtoHSV(const RGB &rgb, float epsilon=EPS6);
+   
+   // Batch versions, same layouts and threading as ColorSpace batch conversions (epsilon is EPS6)
+   GMATH_API bool HSLtoRGB(const float *in, float *out, size_t npixels, size_t stride=3);
+   GMATH_API bool HSLtoRGB(const float *const in[3], float *const out[3], size_t npixels);
+   GMATH_API bool HSVtoRGB(const float *in, float *out, size_t npixels, size_t stride=3);
+   GMATH_API bool HSVtoRGB(const float *const in[3], float *const out[3], size_t npixels);
+   
+   GMATH_API bool RGBtoHSL(const float *in, float *out, size_t npixels, size_t stride=3);
+   GMATH_API bool RGBtoHSL(const float *const in[3], float *const out[3], size_t npixels);
+   GMATH_API bool RGBtoHSV(const float *in, float *out, size_t npixels, size_t stride=3);
+   GMATH_API bool RGBtoHSV(const float *const in[3], float *const out[3], size_t npixels);
 
    GMATH_API RGBA RGBtoRGBA(const RGB &rgb, float a=1.0f);
    GMATH_API RGB RGBAtoRGB(const RGBA &rgba, bool premult=false);
@@ -465,6 +685,15 @@ namespace gmath
    GMATH_API LMS XYZtoLMS(const XYZ &xyz, ChromaticAdaptationTransform cat=CAT_VonKries);
    GMATH_API XYZ LMStoXYZ(const LMS &lms, ChromaticAdaptationTransform cat=CAT_VonKries);
    GMATH_API Matrix3 ChromaticAdaptationMatrix(const XYZ &from, const XYZ &to, ChromaticAdaptationTransform cat=CAT_VonKries);
+   
+   // RGB in color space from to RGB in color space to:
+   //   to.getXYZtoRGBMatrix() * from.getRGBtoXYZMatrix()
+   // or, adapting from white point to white point (both with Y = 1):
+   //   to.getXYZtoRGBMatrix() * ChromaticAdaptationMatrix(fromW, toW, cat) * from.getRGBtoXYZMatrix()
+   // Matrices for all pairs of built-in color spaces are computed once, on first call.
+   // Other pairs are computed on first use and cached (thread safe).
+   GMATH_API Matrix3 RGBtoRGBMatrix(const ColorSpace &from, const ColorSpace &to);
+   GMATH_API Matrix3 RGBtoRGBMatrix(const ColorSpace &from, const ColorSpace &to, ChromaticAdaptationTransform cat);
     
    template <class SpectralPowerDensityFunc>
    XYZ IntegrateVisibleSpectrum(const SpectralPowerDensityFunc &spd, const float stdobs[81][3]=0)
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_colordiff_h_
+#define __gmath_colordiff_h_
+
+#include <gmath/color.h>
+
+namespace gmath
+{
+   enum DeltaEFormula
+   {
+      DeltaE_CIE76 = 0,  // euclidean distance in LAB
+      DeltaE_CIE94,      // graphic arts weights, first color is the reference
+      DeltaE_CIEDE2000
+   };
+   
+   GMATH_API float DeltaE76(const LAB &c0, const LAB &c1);
+   // Graphic arts: kL=1, K1=0.045, K2=0.015. Textiles: kL=2, K1=0.048, K2=0.014
+   GMATH_API float DeltaE94(const LAB &reference, const LAB &sample, float kL=1.0f, float K1=0.045f, float K2=0.015f);
+   GMATH_API float DeltaE2000(const LAB &c0, const LAB &c1, float kL=1.0f, float kC=1.0f, float kH=1.0f);
+   GMATH_API float DeltaE(DeltaEFormula f, const LAB &c0, const LAB &c1);
+   
+   // Batch versions, out[i] = DeltaE(f, lab0[i], lab1[i]) with default weights
+   //   Pixel layouts as for ColorSpace batch conversions, split over threads (see Parallel)
+   GMATH_API bool DeltaE(DeltaEFormula f, const float *lab0, const float *lab1, float *out, size_t n, size_t stride=3);
+   GMATH_API bool DeltaE(DeltaEFormula f, const float *const lab0[3], const float *const lab1[3], float *out, size_t n);
+   
+   // Nearest palette color search in LAB (CIE76 distance).
+   //
+   // The LAB range covering the palette and [0, 100]x[-128, 128]x[-128, 128] is split in a
+   // regular grid of cubic cells (about 16 per palette color, at most 2^20). Each cell keeps
+   // the palette colors that can be the nearest to one of its points: the ones closer to
+   // the cell than the smallest farthest distance from the cell to a palette color. Queries
+   // scan the candidates of their cell 4 at a time, colors outside the grid scan the whole
+   // palette. Ties go to the lowest palette index.
+   
+   class GMATH_API PaletteIndex
+   {
+   public:
+      
+      PaletteIndex();
+      ~PaletteIndex();
+      
+      void clear();
+      
+      // Layout as for ColorSpace batch conversions
+      bool build(const float *lab, size_t n, size_t stride=3);
+      bool build(const LAB *palette, size_t n);
+      
+      size_t size() const;
+      LAB getColor(size_t i) const;
+      
+      // Returns the palette index (size() if the palette is empty), distance is optional
+      size_t nearest(const LAB &c, float *distance=0) const;
+      
+      // Batch versions, distances may be null
+      bool nearest(const float *lab, size_t n, unsigned int *indices, float *distances=0, size_t stride=3) const;
+      bool nearest(const float *const lab[3], size_t n, unsigned int *indices, float *distances=0) const;
+      
+   public:
+      
+      struct Entry
+      {
+         float L;
+         float a;
+         float b;
+         unsigned int index;
+      };
+      
+   private:
+      
+      PaletteIndex(const PaletteIndex&);
+      PaletteIndex& operator=(const PaletteIndex&);
+      
+      size_t cell(float L, float a, float b) const;
+      
+   private:
+      
+      std::vector<Entry> mPalette;
+      // Candidates of cell c in [mCellStart[c], mCellStart[c+1]), padded to a multiple of 4
+      std::vector<float> mCandidates[3];
+      std::vector<unsigned int> mCandidateIndices;
+      std::vector<size_t> mCellStart;
+      size_t mRes[3];
+      float mMin[3];
+      float mCellSize;
+   };
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_colorpipeline_h_
+#define __gmath_colorpipeline_h_
+
+#include <gmath/color.h>
+#include <gmath/gamut.h>
+#include <gmath/grader.h>
+
+namespace gmath
+{
+   // Chain of color transforms applied to batches of pixels in a single pass.
+   //
+   // Stages are applied in the order they are added. Consecutive affine stages
+   // (transform, RGBtoXYZ, XYZtoRGB, adapt and grades without gamma) are folded into
+   // a single matrix and offset as they are added, and those that fold to identity are
+   // dropped. Tone mapping stages use the operator batch kernel (RGB to RGB for toneMap,
+   // XYZ to XYZ for toneMapXYZ). Gamut mapping and gamma grading stages use the mapper
+   // and grader batch kernels.
+   //
+   // apply() runs the whole chain on small blocks of pixels kept in cache, so no
+   // intermediate image is ever written. Pixel layouts follow ColorSpace batch
+   // conversions (interleaved with a pixel stride, or planar). Gamma stages use the
+   // table driven Gamma batch functions (see their error bounds).
+   //
+   // The pipeline keeps a reference to tone mapping operators, gamut mappers and graders
+   // with gamma, they must outlive it.
+   
+   class GMATH_API ColorPipeline
+   {
+   public:
+      
+      enum StageType
+      {
+         Linearize = 0,
+         Unlinearize,
+         Transform,
+         ToneMap,
+         ToneMapRGB,
+         GamutMap,
+         Grade
+      };
+      
+      ColorPipeline();
+      ColorPipeline(const ColorPipeline &rhs);
+      ~ColorPipeline();
+      
+      ColorPipeline& operator=(const ColorPipeline &rhs);
+      
+      void clear();
+      
+      ColorPipeline& linearize(Gamma::Function gf);
+      ColorPipeline& unlinearize(Gamma::Function gf);
+      // c' = m * c
+      ColorPipeline& transform(const Matrix3 &m);
+      ColorPipeline& RGBtoXYZ(const ColorSpace &cs);
+      ColorPipeline& XYZtoRGB(const ColorSpace &cs);
+      // RGB to RGB, see RGBtoRGBMatrix
+      ColorPipeline& RGBtoRGB(const ColorSpace &from, const ColorSpace &to);
+      ColorPipeline& RGBtoRGB(const ColorSpace &from, const ColorSpace &to, ChromaticAdaptationTransform cat);
+      // XYZ to XYZ, see ChromaticAdaptationMatrix
+      ColorPipeline& adapt(const XYZ &from, const XYZ &to, ChromaticAdaptationTransform cat=CAT_VonKries);
+      // RGB to RGB in the operator color space, same as ToneMappingOperator::operator()(const RGB&)
+      ColorPipeline& toneMap(const ToneMappingOperator &tmo);
+      // XYZ to XYZ, same as ToneMappingOperator::operator()(const XYZ&)
+      ColorPipeline& toneMapXYZ(const ToneMappingOperator &tmo);
+      // RGB to RGB in the mapper color space, see GamutMapper
+      ColorPipeline& gamutMap(const GamutMapper &gm);
+      // See Grader, folded into a transform stage unless the grader has a gamma
+      ColorPipeline& grade(const Grader &g);
+      
+      size_t getStageCount() const;
+      StageType getStageType(size_t i) const;
+      
+      RGB operator()(const RGB &input) const;
+      
+      bool apply(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool apply(const float *const in[3], float *const out[3], size_t npixels) const;
+      // Half float pixels, stride in halves
+      bool apply(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool apply(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      
+   public:
+      
+      struct Stage
+      {
+         StageType type;
+         Gamma::Function gamma;
+         // c' = matrix * c + offset
+         Matrix3 matrix;
+         Vector3 offset;
+         const ToneMappingOperator *tmo;
+         const GamutMapper *gamut;
+         const Grader *grader;
+      };
+      
+   private:
+      
+      void add(const Stage &stage);
+      
+   private:
+      
+      std::vector<Stage> mStages;
+   };
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_colorstats_h_
+#define __gmath_colorstats_h_
+
+#include <gmath/color.h>
+
+namespace gmath
+{
+   // Luminance statistics of an image, computed in parallel (see Parallel).
+   //
+   // Percentiles come from a histogram of 128 bins per octave over [2^-16, 2^16]
+   // (bins under 0.8% relative width, interpolated), values below go in a single zero
+   // bin, values above in the last bin. Results are clamped to [min, max].
+   // The log-average is exp(mean(log(LogDelta + max(0, L)))).
+   
+   class GMATH_API LuminanceStats
+   {
+   public:
+      
+      static const float LogDelta;
+      
+      LuminanceStats();
+      
+      void clear();
+      
+      // Pixel layouts as for ColorSpace batch conversions, L = ColorSpace::luminance
+      bool compute(const ColorSpace &cs, const float *rgb, size_t npixels, size_t stride=3);
+      bool compute(const ColorSpace &cs, const float *const rgb[3], size_t npixels);
+      // Luminance values
+      bool compute(const float *L, size_t n);
+      
+      size_t getCount() const;
+      float getMin() const;
+      float getMax() const;
+      float getAverage() const;
+      float getLogAverage() const;
+      // p in [0, 100]
+      float getPercentile(float p) const;
+      
+      // Linear: Lmax = white percentile
+      // Reinhard, ReinhardLocal: Lavg = log-average, Lwht = white percentile scaled by key / Lavg
+      //   (the operator's own key is kept), so it lives in the same space as key * L / Lavg
+      // Other methods are left untouched. Returns tmo validity.
+      bool updateToneMapping(ToneMappingOperator &tmo, float whitePercentile=99.0f) const;
+      
+   public:
+      
+      struct Accumulator
+      {
+         size_t count;
+         float min;
+         float max;
+         double sum;
+         double logSum;
+         std::vector<unsigned int> histogram;
+         
+         void reset();
+         void add(const float *L, size_t n);
+         void merge(const Accumulator &rhs);
+      };
+      
+   private:
+      
+      template <class Source>
+      bool reduce(const Source &src, size_t n);
+      
+   private:
+      
+      Accumulator mAcc;
+   };
+}
+
+#endif
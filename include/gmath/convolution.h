@@ -0,0 +1,627 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_convolution_h_
+#define __gmath_convolution_h_
+
+#include <gmath/fft.h>
+
+namespace gmath
+{
+   // Real valued 1D/2D/3D convolution and cross-correlation.
+   //
+   // The kernel spectrum is computed once per padded transform size and reused
+   // by subsequent calls. Small kernels are convolved directly (see Method).
+   // 1D signals can also be streamed block by block using overlap-add.
+   
+   template <typename T>
+   class Convolver
+   {
+   public:
+      
+      enum Mode
+      {
+         Convolution = 0, // out[i] = sum_j in[i-j] * k[j]
+         Correlation      // out[i] = sum_j in[i+j] * k[j]
+      };
+      
+      enum Output
+      {
+         Full = 0, // (N + K - 1) samples per dimension
+         Same      // N samples per dimension, centered on the full output
+      };
+      
+      enum Method
+      {
+         Auto = 0, // pick the cheapest of Direct and FFT for each call
+         Direct,
+         Spectral
+      };
+      
+   public:
+      
+      Convolver();
+      ~Convolver();
+      
+      bool setKernel(int K, const T *kernel, Mode mode=Convolution);
+      bool setKernel(int KW, int KH, const T *kernel, Mode mode=Convolution);
+      bool setKernel(int KW, int KH, int KD, const T *kernel, Mode mode=Convolution);
+      
+      void setMethod(Method m);
+      Method getMethod() const;
+      
+      int getDimensions() const;
+      
+      // out must hold the number of samples specified by the output mode
+      bool convolve(int N, const T *in, T *out, Output output=Full);
+      bool convolve(int W, int H, const T *in, T *out, Output output=Full);
+      bool convolve(int W, int H, int D, const T *in, T *out, Output output=Full);
+      
+      // Streaming (1D kernels only)
+      // Each call consumes and outputs n samples. Output sample i is the full
+      // convolution sample (i - getLatency()) of the stream processed since reset().
+      void reset();
+      int getLatency() const;
+      bool process(int n, const T *in, T *out);
+      
+   private:
+      
+      Convolver(const Convolver<T>&);
+      Convolver<T>& operator=(const Convolver<T>&);
+      
+      struct DirectTask
+      {
+         const Convolver<T> *self;
+         const T *in;
+         T *out;
+         int W, H, D;
+         int OW, OH;
+         int offX, offY, offZ;
+         
+         void operator()(size_t begin, size_t end) const;
+      };
+      
+      static int NextPowerOf2(int n);
+      static bool DirectIsCheaper(double outSamples, double kernelSamples, double fftSize);
+      
+      bool setKernel(int KW, int KH, int KD, int dims, const T *kernel, Mode mode);
+      bool convolve(int W, int H, int D, int dims, const T *in, T *out, Output output);
+      void transform(int PW, int PH, int PD, Complex<T> *data, bool inverse) const;
+      const Complex<T>* getSpectrum(int PW, int PH, int PD);
+      void setupStream();
+      
+   private:
+      
+      int mDims;
+      int mKW;
+      int mKH;
+      int mKD;
+      std::vector<T> mKernel;
+      Method mMethod;
+      
+      // cached kernel spectrum
+      int mSpecW;
+      int mSpecH;
+      int mSpecD;
+      std::vector<Complex<T> > mSpectrum;
+      std::vector<Complex<T> > mWork;
+      
+      // overlap-add streaming state
+      bool mStreamDirect;
+      int mBlockSize;
+      int mBlockFill;
+      std::vector<T> mBlock;
+      std::vector<T> mReady;
+      std::vector<T> mTail;
+      std::vector<T> mHistory;
+   };
+}
+
+// ---
+
+template <typename T>
+gmath::Convolver<T>::Convolver()
+   : mDims(0), mKW(0), mKH(0), mKD(0), mMethod(Auto)
+   , mSpecW(0), mSpecH(0), mSpecD(0)
+   , mStreamDirect(true), mBlockSize(0), mBlockFill(0)
+{
+}
+
+template <typename T>
+gmath::Convolver<T>::~Convolver()
+{
+}
+
+template <typename T>
+int gmath::Convolver<T>::NextPowerOf2(int n)
+{
+   int p = 1;
+   while (p < n)
+   {
+      p <<= 1;
+   }
+   return p;
+}
+
+template <typename T>
+bool gmath::Convolver<T>::DirectIsCheaper(double outSamples, double kernelSamples, double fftSize)
+{
+   // forward + inverse transforms and spectrum product, the kernel spectrum is cached
+   double fftCost = fftSize * (10.0 * log(fftSize) / log(2.0) + 6.0);
+   return (outSamples * kernelSamples <= fftCost);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::setKernel(int K, const T *kernel, Mode mode)
+{
+   return setKernel(K, 1, 1, 1, kernel, mode);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::setKernel(int KW, int KH, const T *kernel, Mode mode)
+{
+   return setKernel(KW, KH, 1, 2, kernel, mode);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::setKernel(int KW, int KH, int KD, const T *kernel, Mode mode)
+{
+   return setKernel(KW, KH, KD, 3, kernel, mode);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::setKernel(int KW, int KH, int KD, int dims, const T *kernel, Mode mode)
+{
+   if (!kernel || KW <= 0 || KH <= 0 || KD <= 0)
+   {
+      return false;
+   }
+   
+   int K = KW * KH * KD;
+   
+   mDims = dims;
+   mKW = KW;
+   mKH = KH;
+   mKD = KD;
+   mKernel.resize(K);
+   
+   if (mode == Correlation)
+   {
+      // correlation is a convolution with the reversed kernel
+      for (int i=0; i<K; ++i)
+      {
+         mKernel[i] = kernel[K - 1 - i];
+      }
+   }
+   else
+   {
+      std::copy(kernel, kernel + K, mKernel.begin());
+   }
+   
+   mSpecW = mSpecH = mSpecD = 0;
+   mSpectrum.clear();
+   
+   reset();
+   
+   return true;
+}
+
+template <typename T>
+void gmath::Convolver<T>::setMethod(Method m)
+{
+   mMethod = m;
+   reset();
+}
+
+template <typename T>
+typename gmath::Convolver<T>::Method gmath::Convolver<T>::getMethod() const
+{
+   return mMethod;
+}
+
+template <typename T>
+int gmath::Convolver<T>::getDimensions() const
+{
+   return mDims;
+}
+
+template <typename T>
+void gmath::Convolver<T>::transform(int PW, int PH, int PD, Complex<T> *data, bool inverse) const
+{
+   switch (mDims)
+   {
+   case 1:
+      if (inverse)
+      {
+         FFT::Inverse(PW, data);
+      }
+      else
+      {
+         FFT::Forward(PW, data);
+      }
+      break;
+   case 2:
+      if (inverse)
+      {
+         FFT::Inverse(PW, PH, data);
+      }
+      else
+      {
+         FFT::Forward(PW, PH, data);
+      }
+      break;
+   default:
+      if (inverse)
+      {
+         FFT::Inverse(PW, PH, PD, data);
+      }
+      else
+      {
+         FFT::Forward(PW, PH, PD, data);
+      }
+      break;
+   }
+}
+
+template <typename T>
+const gmath::Complex<T>* gmath::Convolver<T>::getSpectrum(int PW, int PH, int PD)
+{
+   if (PW != mSpecW || PH != mSpecH || PD != mSpecD)
+   {
+      mSpectrum.assign(size_t(PW) * PH * PD, Complex<T>(T(0)));
+      
+      for (int z=0, k=0; z<mKD; ++z)
+      {
+         for (int y=0; y<mKH; ++y)
+         {
+            Complex<T> *row = &mSpectrum[(size_t(z) * PH + y) * PW];
+            for (int x=0; x<mKW; ++x, ++k)
+            {
+               row[x].re = mKernel[k];
+            }
+         }
+      }
+      
+      transform(PW, PH, PD, &mSpectrum[0], false);
+      
+      mSpecW = PW;
+      mSpecH = PH;
+      mSpecD = PD;
+   }
+   
+   return &mSpectrum[0];
+}
+
+template <typename T>
+void gmath::Convolver<T>::DirectTask::operator()(size_t begin, size_t end) const
+{
+   // one task item per output row
+   for (size_t r=begin; r<end; ++r)
+   {
+      int oy = int(r) % OH;
+      int oz = int(r) / OH;
+      int fy = oy + offY;
+      int fz = oz + offZ;
+      
+      T *orow = out + r * OW;
+      
+      for (int ox=0; ox<OW; ++ox)
+      {
+         int fx = ox + offX;
+         T sum = T(0);
+         
+         for (int kz=0; kz<self->mKD; ++kz)
+         {
+            int iz = fz - kz;
+            if (iz < 0 || iz >= D)
+            {
+               continue;
+            }
+            for (int ky=0; ky<self->mKH; ++ky)
+            {
+               int iy = fy - ky;
+               if (iy < 0 || iy >= H)
+               {
+                  continue;
+               }
+               
+               const T *krow = &(self->mKernel[(size_t(kz) * self->mKH + ky) * self->mKW]);
+               const T *irow = in + (size_t(iz) * H + iy) * W;
+               
+               int kx0 = std::max(0, fx - W + 1);
+               int kx1 = std::min(self->mKW - 1, fx);
+               
+               for (int kx=kx0; kx<=kx1; ++kx)
+               {
+                  sum += krow[kx] * irow[fx - kx];
+               }
+            }
+         }
+         
+         orow[ox] = sum;
+      }
+   }
+}
+
+template <typename T>
+bool gmath::Convolver<T>::convolve(int N, const T *in, T *out, Output output)
+{
+   return convolve(N, 1, 1, 1, in, out, output);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::convolve(int W, int H, const T *in, T *out, Output output)
+{
+   return convolve(W, H, 1, 2, in, out, output);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::convolve(int W, int H, int D, const T *in, T *out, Output output)
+{
+   return convolve(W, H, D, 3, in, out, output);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::convolve(int W, int H, int D, int dims, const T *in, T *out, Output output)
+{
+   if (!in || !out || dims != mDims || W <= 0 || H <= 0 || D <= 0)
+   {
+      return false;
+   }
+   
+   int FW = W + mKW - 1;
+   int FH = H + mKH - 1;
+   int FD = D + mKD - 1;
+   
+   int OW = (output == Same ? W : FW);
+   int OH = (output == Same ? H : FH);
+   int OD = (output == Same ? D : FD);
+   
+   int offX = (output == Same ? mKW / 2 : 0);
+   int offY = (output == Same ? mKH / 2 : 0);
+   int offZ = (output == Same ? mKD / 2 : 0);
+   
+   int PW = NextPowerOf2(FW);
+   int PH = NextPowerOf2(FH);
+   int PD = NextPowerOf2(FD);
+   
+   double outSamples = double(OW) * OH * OD;
+   double fftSize = double(PW) * PH * PD;
+   
+   bool direct = (mMethod == Direct || (mMethod == Auto && DirectIsCheaper(outSamples, double(mKernel.size()), fftSize)));
+   
+   if (direct)
+   {
+      DirectTask task;
+      
+      task.self = this;
+      task.in = in;
+      task.out = out;
+      task.W = W;
+      task.H = H;
+      task.D = D;
+      task.OW = OW;
+      task.OH = OH;
+      task.offX = offX;
+      task.offY = offY;
+      task.offZ = offZ;
+      
+      size_t rowCost = size_t(OW) * mKernel.size();
+      size_t grain = (rowCost >= 16384 ? 1 : 16384 / rowCost);
+      
+      Parallel::For(size_t(OH) * OD, grain, task);
+   }
+   else
+   {
+      const Complex<T> *spectrum = getSpectrum(PW, PH, PD);
+      
+      mWork.assign(size_t(PW) * PH * PD, Complex<T>(T(0)));
+      
+      for (int z=0; z<D; ++z)
+      {
+         for (int y=0; y<H; ++y)
+         {
+            const T *irow = in + (size_t(z) * H + y) * W;
+            Complex<T> *wrow = &mWork[(size_t(z) * PH + y) * PW];
+            for (int x=0; x<W; ++x)
+            {
+               wrow[x].re = irow[x];
+            }
+         }
+      }
+      
+      transform(PW, PH, PD, &mWork[0], false);
+      
+      for (size_t i=0; i<mWork.size(); ++i)
+      {
+         mWork[i] *= spectrum[i];
+      }
+      
+      transform(PW, PH, PD, &mWork[0], true);
+      
+      for (int z=0; z<OD; ++z)
+      {
+         for (int y=0; y<OH; ++y)
+         {
+            const Complex<T> *wrow = &mWork[(size_t(z + offZ) * PH + (y + offY)) * PW + offX];
+            T *orow = out + (size_t(z) * OH + y) * OW;
+            for (int x=0; x<OW; ++x)
+            {
+               orow[x] = wrow[x].re;
+            }
+         }
+      }
+   }
+   
+   return true;
+}
+
+template <typename T>
+void gmath::Convolver<T>::setupStream()
+{
+   int K = int(mKernel.size());
+   
+   // block FFT size: at least twice the kernel length
+   int M = NextPowerOf2(2 * K);
+   
+   mBlockSize = M - K + 1;
+   mStreamDirect = (mMethod == Direct || (mMethod == Auto && DirectIsCheaper(double(mBlockSize), double(K), double(M))));
+   mBlockFill = 0;
+   
+   if (mStreamDirect)
+   {
+      mHistory.assign(K > 1 ? K - 1 : 0, T(0));
+      mBlock.clear();
+      mReady.clear();
+      mTail.clear();
+   }
+   else
+   {
+      mHistory.clear();
+      mBlock.assign(mBlockSize, T(0));
+      mReady.assign(mBlockSize, T(0));
+      mTail.assign(K - 1, T(0));
+      getSpectrum(M, 1, 1);
+   }
+}
+
+template <typename T>
+void gmath::Convolver<T>::reset()
+{
+   if (mDims == 1)
+   {
+      setupStream();
+   }
+   else
+   {
+      mBlockSize = 0;
+      mBlockFill = 0;
+      mBlock.clear();
+      mReady.clear();
+      mTail.clear();
+      mHistory.clear();
+   }
+}
+
+template <typename T>
+int gmath::Convolver<T>::getLatency() const
+{
+   return (mStreamDirect ? 0 : mBlockSize);
+}
+
+template <typename T>
+bool gmath::Convolver<T>::process(int n, const T *in, T *out)
+{
+   if (mDims != 1 || !in || !out || n < 0)
+   {
+      return false;
+   }
+   
+   int K = int(mKernel.size());
+   
+   if (mStreamDirect)
+   {
+      // mHistory holds the last K-1 input samples, oldest first
+      int nh = K - 1;
+      
+      for (int i=0; i<n; ++i)
+      {
+         T sum = mKernel[0] * in[i];
+         
+         for (int k=1; k<K; ++k)
+         {
+            int j = i - k;
+            sum += mKernel[k] * (j >= 0 ? in[j] : mHistory[nh + j]);
+         }
+         
+         out[i] = sum;
+      }
+      
+      if (nh > 0)
+      {
+         if (n >= nh)
+         {
+            std::copy(in + n - nh, in + n, mHistory.begin());
+         }
+         else
+         {
+            std::copy(mHistory.begin() + n, mHistory.end(), mHistory.begin());
+            std::copy(in, in + n, mHistory.end() - n);
+         }
+      }
+   }
+   else
+   {
+      int M = mBlockSize + K - 1;
+      
+      for (int i=0; i<n; ++i)
+      {
+         out[i] = mReady[mBlockFill];
+         mBlock[mBlockFill] = in[i];
+         
+         if (++mBlockFill == mBlockSize)
+         {
+            const Complex<T> *spectrum = getSpectrum(M, 1, 1);
+            
+            mWork.assign(M, Complex<T>(T(0)));
+            
+            for (int j=0; j<mBlockSize; ++j)
+            {
+               mWork[j].re = mBlock[j];
+            }
+            
+            FFT::Forward(M, &mWork[0]);
+            
+            for (int j=0; j<M; ++j)
+            {
+               mWork[j] *= spectrum[j];
+            }
+            
+            FFT::Inverse(M, &mWork[0]);
+            
+            // overlap-add previous block tail
+            for (int j=0; j<K-1; ++j)
+            {
+               mWork[j].re += mTail[j];
+            }
+            for (int j=0; j<mBlockSize; ++j)
+            {
+               mReady[j] = mWork[j].re;
+            }
+            for (int j=0; j<K-1; ++j)
+            {
+               mTail[j] = mWork[mBlockSize + j].re;
+            }
+            
+            mBlockFill = 0;
+         }
+      }
+   }
+   
+   return true;
+}
+
+#endif
@@ -0,0 +1,422 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_dct_h_
+#define __gmath_dct_h_
+
+#include <gmath/fft.h>
+
+namespace gmath
+{
+   // Discrete cosine and sine transforms of real 1D or 2D (row major) data.
+   //
+   // Each line of N samples is transformed with a single N/2 points complex FFT
+   // (real input packing) plus pre and post twiddles. Twiddle tables and FFT plans
+   // are computed once in setup(). Sizes must be powers of 2.
+   //
+   // Conventions (1D, applied on each axis in 2D)
+   //   forward:      DCT-II  X[k] = sum_n x[n] cos(pi (2n+1) k / 2N)
+   //   inverse:      DCT-III, exact inverse of forward
+   //                 x[n] = (X[0] + 2 sum_k>0 X[k] cos(pi (2n+1) k / 2N)) / N
+   //   forwardSine:  DST-II  X[k] = sum_n x[n] sin(pi (2n+1) (k+1) / 2N)
+   //   inverseSine:  DST-III, exact inverse of forwardSine
+   // src and dst may be the same buffer.
+   
+   template <typename T>
+   class DCT
+   {
+   public:
+      
+      DCT();
+      DCT(int N);
+      DCT(int W, int H);
+      
+      bool setup(int N);
+      bool setup(int W, int H);
+      
+      int getWidth() const;
+      int getHeight() const;
+      
+      bool forward(const T *src, T *dst);
+      bool inverse(const T *src, T *dst);
+      bool forwardSine(const T *src, T *dst);
+      bool inverseSine(const T *src, T *dst);
+      
+   private:
+      
+      enum Kind
+      {
+         CosineII = 0,
+         CosineIII,
+         SineII,
+         SineIII
+      };
+      
+      class Line
+      {
+      public:
+         Line();
+         
+         bool setup(int N);
+         int size() const;
+         void transform(const T *src, int srcStride, T *dst, int dstStride, Kind kind);
+         
+      private:
+         void forward(const T *src, int srcStride, T *dst, int dstStride, bool sine);
+         void inverse(const T *src, int srcStride, T *dst, int dstStride, bool sine);
+         
+         int mN;
+         FFTPlan<T> mPlan;
+         // exp(-2 i pi k / N) and exp(-i pi k / 2N), k in [0, N/2]
+         std::vector<Complex<T> > mSplit;
+         std::vector<Complex<T> > mShift;
+         std::vector<Complex<T> > mZ;
+         std::vector<Complex<T> > mV;
+      };
+      
+      struct LinesTask
+      {
+         const Line *proto;
+         const T *src;
+         T *dst;
+         int stride;
+         int step;
+         Kind kind;
+         
+         void operator()(size_t begin, size_t end) const;
+      };
+      
+      bool transform(const T *src, T *dst, Kind kind);
+      
+   private:
+      
+      int mW;
+      int mH;
+      Line mRow;
+      Line mCol;
+   };
+}
+
+// ---
+
+template <typename T>
+gmath::DCT<T>::Line::Line()
+   : mN(0)
+{
+}
+
+template <typename T>
+bool gmath::DCT<T>::Line::setup(int N)
+{
+   if (N <= 0 || (N & (N - 1)) != 0)
+   {
+      return false;
+   }
+   
+   if (N == mN)
+   {
+      return true;
+   }
+   
+   mN = N;
+   
+   if (N == 1)
+   {
+      return true;
+   }
+   
+   int hN = N / 2;
+   
+   mPlan.setup(hN, FFTPlan<T>::Stockham);
+   
+   mSplit.resize(hN + 1);
+   mShift.resize(hN + 1);
+   
+   for (int k=0; k<=hN; ++k)
+   {
+      double a0 = -2.0 * M_PI * k / double(N);
+      double a1 = -0.5 * M_PI * k / double(N);
+      mSplit[k] = Complex<T>(T(cos(a0)), T(sin(a0)));
+      mShift[k] = Complex<T>(T(cos(a1)), T(sin(a1)));
+   }
+   
+   mZ.resize(hN);
+   mV.resize(hN + 1);
+   
+   return true;
+}
+
+template <typename T>
+int gmath::DCT<T>::Line::size() const
+{
+   return mN;
+}
+
+template <typename T>
+void gmath::DCT<T>::Line::transform(const T *src, int srcStride, T *dst, int dstStride, Kind kind)
+{
+   if (mN == 1)
+   {
+      dst[0] = src[0];
+      return;
+   }
+   
+   switch (kind)
+   {
+   case CosineII:
+      forward(src, srcStride, dst, dstStride, false);
+      break;
+   case CosineIII:
+      inverse(src, srcStride, dst, dstStride, false);
+      break;
+   case SineII:
+      forward(src, srcStride, dst, dstStride, true);
+      break;
+   case SineIII:
+   default:
+      inverse(src, srcStride, dst, dstStride, true);
+      break;
+   }
+}
+
+template <typename T>
+void gmath::DCT<T>::Line::forward(const T *src, int srcStride, T *dst, int dstStride, bool sine)
+{
+   // DST-II(x)[k] = DCT-II((-1)^n x[n])[N-1-k]
+   
+   int N = mN;
+   int hN = N / 2;
+   T odd = (sine ? T(-1) : T(1));
+   
+   // v[n] = x[2n], v[N-1-n] = x[2n+1] (n < N/2), packed as z[k] = v[2k] + i v[2k+1]
+   for (int k=0; k<hN; ++k)
+   {
+      int m0 = 2 * k;
+      int m1 = m0 + 1;
+      int n0 = (m0 < hN ? 2 * m0 : 2 * (N - 1 - m0) + 1);
+      int n1 = (m1 < hN ? 2 * m1 : 2 * (N - 1 - m1) + 1);
+      mZ[k].re = src[n0 * srcStride] * ((n0 & 1) ? odd : T(1));
+      mZ[k].im = src[n1 * srcStride] * ((n1 & 1) ? odd : T(1));
+   }
+   
+   mPlan.forward(&mZ[0]);
+   
+   for (int k=0; k<=hN; ++k)
+   {
+      // split the half size spectrum into the spectrum V of the real sequence v
+      Complex<T> Zk = mZ[k < hN ? k : 0];
+      Complex<T> Zc = mZ[k > 0 ? hN - k : 0].conjugate();
+      Complex<T> E = (Zk + Zc) * T(0.5);
+      Complex<T> O = (Zk - Zc) * T(0.5);
+      // O / i
+      O = Complex<T>(O.im, -O.re);
+      
+      Complex<T> u = mShift[k] * (E + mSplit[k] * O);
+      
+      int k0 = (sine ? N - 1 - k : k);
+      dst[k0 * dstStride] = u.re;
+      
+      if (k > 0 && k < hN)
+      {
+         int k1 = (sine ? k - 1 : N - k);
+         dst[k1 * dstStride] = -u.im;
+      }
+   }
+}
+
+template <typename T>
+void gmath::DCT<T>::Line::inverse(const T *src, int srcStride, T *dst, int dstStride, bool sine)
+{
+   int N = mN;
+   int hN = N / 2;
+   T odd = (sine ? T(-1) : T(1));
+   
+   // V[k] = exp(i pi k / 2N) (X[k] - i X[N-k]), with X[N] = 0
+   for (int k=0; k<=hN; ++k)
+   {
+      int k0 = (sine ? N - 1 - k : k);
+      T Xk = src[k0 * srcStride];
+      T Xc = T(0);
+      
+      if (k > 0)
+      {
+         int k1 = (sine ? k - 1 : N - k);
+         Xc = src[k1 * srcStride];
+      }
+      
+      mV[k] = mShift[k].conjugate() * Complex<T>(Xk, -Xc);
+   }
+   
+   for (int k=0; k<hN; ++k)
+   {
+      // even / odd samples spectra, recombined as Z = E + i O
+      Complex<T> Vc = mV[hN - k].conjugate();
+      Complex<T> E = (mV[k] + Vc) * T(0.5);
+      Complex<T> O = (mV[k] - Vc) * T(0.5) * mSplit[k].conjugate();
+      mZ[k] = Complex<T>(E.re - O.im, E.im + O.re);
+   }
+   
+   mPlan.inverse(&mZ[0]);
+   
+   for (int k=0; k<hN; ++k)
+   {
+      int m0 = 2 * k;
+      int m1 = m0 + 1;
+      int n0 = (m0 < hN ? 2 * m0 : 2 * (N - 1 - m0) + 1);
+      int n1 = (m1 < hN ? 2 * m1 : 2 * (N - 1 - m1) + 1);
+      dst[n0 * dstStride] = mZ[k].re * ((n0 & 1) ? odd : T(1));
+      dst[n1 * dstStride] = mZ[k].im * ((n1 & 1) ? odd : T(1));
+   }
+}
+
+// ---
+
+template <typename T>
+gmath::DCT<T>::DCT()
+   : mW(0), mH(0)
+{
+}
+
+template <typename T>
+gmath::DCT<T>::DCT(int N)
+   : mW(0), mH(0)
+{
+   setup(N);
+}
+
+template <typename T>
+gmath::DCT<T>::DCT(int W, int H)
+   : mW(0), mH(0)
+{
+   setup(W, H);
+}
+
+template <typename T>
+bool gmath::DCT<T>::setup(int N)
+{
+   return setup(N, 1);
+}
+
+template <typename T>
+bool gmath::DCT<T>::setup(int W, int H)
+{
+   if (!mRow.setup(W) || !mCol.setup(H))
+   {
+      mW = mH = 0;
+      return false;
+   }
+   mW = W;
+   mH = H;
+   return true;
+}
+
+template <typename T>
+int gmath::DCT<T>::getWidth() const
+{
+   return mW;
+}
+
+template <typename T>
+int gmath::DCT<T>::getHeight() const
+{
+   return mH;
+}
+
+template <typename T>
+void gmath::DCT<T>::LinesTask::operator()(size_t begin, size_t end) const
+{
+   // full per-chunk copy (plan, twiddle tables and work buffers): Line::transform writes
+   //   to its buffers, so chunks running concurrently cannot share one
+   Line line(*proto);
+   
+   for (size_t i=begin; i<end; ++i)
+   {
+      line.transform(src + i * step, stride, dst + i * step, stride, kind);
+   }
+}
+
+template <typename T>
+bool gmath::DCT<T>::transform(const T *src, T *dst, Kind kind)
+{
+   if (!src || !dst || mW == 0)
+   {
+      return false;
+   }
+   
+   if (mH == 1)
+   {
+      mRow.transform(src, 1, dst, 1, kind);
+   }
+   else
+   {
+      LinesTask task;
+      
+      task.kind = kind;
+      
+      // rows
+      task.proto = &mRow;
+      task.src = src;
+      task.dst = dst;
+      task.stride = 1;
+      task.step = mW;
+      Parallel::For(size_t(mH), size_t(std::max(1, FFT::ParallelGrainSize / mW)), task);
+      
+      // columns
+      task.proto = &mCol;
+      task.src = dst;
+      task.stride = mW;
+      task.step = 1;
+      Parallel::For(size_t(mW), size_t(std::max(1, FFT::ParallelGrainSize / mH)), task);
+   }
+   
+   return true;
+}
+
+template <typename T>
+bool gmath::DCT<T>::forward(const T *src, T *dst)
+{
+   return transform(src, dst, CosineII);
+}
+
+template <typename T>
+bool gmath::DCT<T>::inverse(const T *src, T *dst)
+{
+   return transform(src, dst, CosineIII);
+}
+
+template <typename T>
+bool gmath::DCT<T>::forwardSine(const T *src, T *dst)
+{
+   return transform(src, dst, SineII);
+}
+
+template <typename T>
+bool gmath::DCT<T>::inverseSine(const T *src, T *dst)
+{
+   return transform(src, dst, SineIII);
+}
+
+#endif
@@ -28,6 +28,7 @@ SOFTWARE.
 #define __gmath_fft_h_
 
 #include <gmath/complex.h>
+#include <gmath/parallel.h>
 
 namespace gmath
 {
@@ -48,8 +49,44 @@ namespace gmath
       template <typename T>
       static void Transform(int N, Complex<T> *data, bool inverse, int stride=1);
       
+      // Set of 1D transforms of size N whose first element offsets are
+      //   (i % inner) * innerStep + (i / inner) * outerStep, for i in [0, count)
+      // Lines are distributed over gmath::Parallel threads. src == dst for in-place.
+      template <typename T>
+      struct Lines
+      {
+         int N;
+         const T *src;
+         T *dst;
+         int srcStride;
+         int dstStride;
+         int inner;
+         int srcInnerStep;
+         int srcOuterStep;
+         int dstInnerStep;
+         int dstOuterStep;
+         bool inverse;
+         
+         static void Run(size_t begin, size_t end, void *data);
+      };
+      
+      template <typename T>
+      static void TransformLines(int N, int count, const T *src, T *dst, int srcStride, int dstStride,
+                                 int inner, int srcInnerStep, int srcOuterStep,
+                                 int dstInnerStep, int dstOuterStep, bool inverse);
+      
+      template <typename T>
+      static void Transform2D(int W, int H, const T *src, T *dst, int srcStride, int dstStride, bool inverse);
+      
+      template <typename T>
+      static void Transform3D(int W, int H, int D, const T *src, T *dst, int srcStride, int dstStride, bool inverse);
+      
    public:
       
+      // Minimum number of samples processed per thread task by batched, 2D and 3D
+      // transforms. Thread count is controlled through gmath::Parallel.
+      static const int ParallelGrainSize = 16384;
+      
       // Utilities
       
       template <typename T>
@@ -72,6 +109,22 @@ namespace gmath
       template <typename T>
       static bool Inverse(int N, Complex<T> *data, int stride=1);
       
+      // 1D batch
+      // howmany transforms of size N, the first sample of transform i being at offset i * dist
+      // (dist <= 0 for contiguous transforms: N * stride)
+      
+      template <typename T>
+      static bool ForwardBatch(int N, int howmany, const Complex<T> *src, Complex<T> *dst, int srcDist=0, int dstDist=0, int srcStride=1, int dstStride=1);
+      
+      template <typename T>
+      static bool ForwardBatch(int N, int howmany, Complex<T> *data, int dist=0, int stride=1);
+      
+      template <typename T>
+      static bool InverseBatch(int N, int howmany, const Complex<T> *src, Complex<T> *dst, int srcDist=0, int dstDist=0, int srcStride=1, int dstStride=1);
+      
+      template <typename T>
+      static bool InverseBatch(int N, int howmany, Complex<T> *data, int dist=0, int stride=1);
+      
       // 2D
       // takes a 1D array whose elements are arranged row major format (dimension W)
       
@@ -102,6 +155,60 @@ namespace gmath
       template <typename T>
       static bool Inverse(int W, int H, int D, T *data, int stride=1);
    };
+
+   // Precomputed transform of a fixed power of 2 size.
+   //
+   // A plan holds its twiddle factors table and a scratch buffer, the out-of-place
+   // algorithm is selectable:
+   //   BitReversal: bit reversal permutation of the input to the output followed by
+   //                log2(N) in-place radix-2 passes (same as FFT::Forward/Inverse)
+   //   Stockham:    log2(N) self-sorting radix-2 passes ping-ponging between the
+   //                output and the scratch buffer, reading the input in the first
+   //                one. This saves the permutation pass and its scattered writes,
+   //                and the inverse scaling is fused into the last pass.
+   // A plan must not be used by several threads at once.
+   
+   template <typename T>
+   class FFTPlan
+   {
+   public:
+      
+      enum Algorithm
+      {
+         BitReversal = 0,
+         Stockham
+      };
+      
+      FFTPlan();
+      FFTPlan(int N, Algorithm alg=Stockham);
+      
+      bool setup(int N, Algorithm alg=Stockham);
+      
+      int getSize() const;
+      Algorithm getAlgorithm() const;
+      void setAlgorithm(Algorithm alg);
+      
+      bool forward(const Complex<T> *src, Complex<T> *dst, int srcStride=1, int dstStride=1);
+      bool forward(Complex<T> *data, int stride=1);
+      
+      bool inverse(const Complex<T> *src, Complex<T> *dst, int srcStride=1, int dstStride=1);
+      bool inverse(Complex<T> *data, int stride=1);
+      
+   private:
+      
+      void transform(const Complex<T> *src, int srcStride, Complex<T> *dst, int dstStride, bool inverse);
+      void radix2(Complex<T> *data, int stride, bool inverse) const;
+      void stockham(const Complex<T> *src, int srcStride, Complex<T> *dst, int dstStride, bool inverse);
+      
+   private:
+      
+      int mN;
+      int mLog2N;
+      Algorithm mAlgorithm;
+      // exp(-2 i pi k / N), k in [0, N/2)
+      std::vector<Complex<T> > mTwiddles;
+      std::vector<Complex<T> > mScratch;
+   };
 }
 
 // ---
@@ -126,7 +233,7 @@ inline void gmath::FFT::ReverseIncrement(int N, int &cnt)
   cnt |= N;
 }
 
-bool gmath::FFT::IsPowerOf2(int N)
+inline bool gmath::FFT::IsPowerOf2(int N)
 {
    return ((N & (N - 1)) == 0);
 }
@@ -268,97 +375,211 @@ bool gmath::FFT::Inverse(int N, const Complex<T> *src, Complex<T> *dst, int srcS
    return true;
 }
 
+
 template <typename T>
-bool gmath::FFT::Forward(int W, int H, const T *src, T *dst, int srcStride, int dstStride)
+void gmath::FFT::Lines<T>::Run(size_t begin, size_t end, void *data)
 {
-   if (!src || !dst || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
+   const Lines<T> &lines = *((const Lines<T>*) data);
+   
+   for (int i=int(begin); i<int(end); ++i)
    {
-      return false;
+      int io = i % lines.inner;
+      int oo = i / lines.inner;
+      
+      T *dst = lines.dst + io * lines.dstInnerStep + oo * lines.dstOuterStep;
+      
+      if (lines.src == lines.dst)
+      {
+         if (lines.inverse)
+         {
+            Inverse(lines.N, dst, lines.dstStride);
+         }
+         else
+         {
+            Forward(lines.N, dst, lines.dstStride);
+         }
+      }
+      else
+      {
+         const T *src = lines.src + io * lines.srcInnerStep + oo * lines.srcOuterStep;
+         
+         if (lines.inverse)
+         {
+            Inverse(lines.N, src, dst, lines.srcStride, lines.dstStride);
+         }
+         else
+         {
+            Forward(lines.N, src, dst, lines.srcStride, lines.dstStride);
+         }
+      }
    }
-   
+}
+
+template <typename T>
+void gmath::FFT::TransformLines(int N, int count, const T *src, T *dst, int srcStride, int dstStride,
+                                int inner, int srcInnerStep, int srcOuterStep,
+                                int dstInnerStep, int dstOuterStep, bool inverse)
+{
+   Lines<T> lines;
+   
+   lines.N = N;
+   lines.src = src;
+   lines.dst = dst;
+   lines.srcStride = srcStride;
+   lines.dstStride = dstStride;
+   lines.inner = inner;
+   lines.srcInnerStep = srcInnerStep;
+   lines.srcOuterStep = srcOuterStep;
+   lines.dstInnerStep = dstInnerStep;
+   lines.dstOuterStep = dstOuterStep;
+   lines.inverse = inverse;
+   
+   size_t grain = size_t(N >= ParallelGrainSize ? 1 : ParallelGrainSize / N);
+   
+   Parallel::For(size_t(count), grain, &Lines<T>::Run, &lines);
+}
+
+template <typename T>
+void gmath::FFT::Transform2D(int W, int H, const T *src, T *dst, int srcStride, int dstStride, bool inverse)
+{
    int srcRowStride = srcStride * W;
    int dstRowStride = dstStride * W;
    
-   for (int y=0, srcOff=0, dstOff=0; y<H; ++y, srcOff+=srcRowStride, dstOff+=dstRowStride)
-   {
-      Forward(W, src+srcOff, dst+dstOff, srcStride, dstStride);
-   }
+   // Rows
+   TransformLines(W, H, src, dst, srcStride, dstStride, H, srcRowStride, 0, dstRowStride, 0, inverse);
+   
+   // Columns
+   TransformLines(H, W, dst, dst, dstRowStride, dstRowStride, W, dstStride, 0, dstStride, 0, inverse);
+}
+
+template <typename T>
+void gmath::FFT::Transform3D(int W, int H, int D, const T *src, T *dst, int srcStride, int dstStride, bool inverse)
+{
+   int srcRowStride = W * srcStride;
+   int dstRowStride = W * dstStride;
+   int dstColStride = H * dstRowStride;
    
-   for (int x=0, off=0; x<W; ++x, off+=dstStride)
+   // Rows of all 2D slices
+   TransformLines(W, H*D, src, dst, srcStride, dstStride, H*D, srcRowStride, 0, dstRowStride, 0, inverse);
+   
+   // Columns of all 2D slices
+   TransformLines(H, W*D, dst, dst, dstRowStride, dstRowStride, W, dstStride, dstColStride, dstStride, dstColStride, inverse);
+   
+   // Each X/Y plane sample along depth
+   TransformLines(D, W*H, dst, dst, dstColStride, dstColStride, W*H, dstStride, 0, dstStride, 0, inverse);
+}
+
+template <typename T>
+bool gmath::FFT::ForwardBatch(int N, int howmany, const Complex<T> *src, Complex<T> *dst, int srcDist, int dstDist, int srcStride, int dstStride)
+{
+   if (!src || !dst || N <= 0 || howmany <= 0 || !IsPowerOf2(N))
    {
-      Forward(H, dst+off, dstRowStride);
+      return false;
    }
    
+   srcDist = (srcDist <= 0 ? N * srcStride : srcDist);
+   dstDist = (dstDist <= 0 ? N * dstStride : dstDist);
+   
+   TransformLines(N, howmany, src, dst, srcStride, dstStride, howmany, srcDist, 0, dstDist, 0, false);
+   
    return true;
 }
 
 template <typename T>
-bool gmath::FFT::Forward(int W, int H, T *data, int stride)
+bool gmath::FFT::ForwardBatch(int N, int howmany, Complex<T> *data, int dist, int stride)
 {
-   if (!data || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
+   if (!data || N <= 0 || howmany <= 0 || !IsPowerOf2(N))
    {
       return false;
    }
    
-   int rowStride = stride * W;
+   dist = (dist <= 0 ? N * stride : dist);
    
-   for (int y=0, off=0; y<H; ++y, off+=rowStride)
-   {
-      Forward(W, data+off, stride);
-   }
+   TransformLines(N, howmany, data, data, stride, stride, howmany, dist, 0, dist, 0, false);
    
-   for (int x=0, off=0; x<W; ++x, off+=stride)
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::InverseBatch(int N, int howmany, const Complex<T> *src, Complex<T> *dst, int srcDist, int dstDist, int srcStride, int dstStride)
+{
+   if (!src || !dst || N <= 0 || howmany <= 0 || !IsPowerOf2(N))
    {
-      Forward(H, data+off, rowStride);
+      return false;
    }
    
+   srcDist = (srcDist <= 0 ? N * srcStride : srcDist);
+   dstDist = (dstDist <= 0 ? N * dstStride : dstDist);
+   
+   TransformLines(N, howmany, src, dst, srcStride, dstStride, howmany, srcDist, 0, dstDist, 0, true);
+   
    return true;
 }
 
 template <typename T>
-bool gmath::FFT::Inverse(int W, int H, const T *src, T *dst, int srcStride, int dstStride)
+bool gmath::FFT::InverseBatch(int N, int howmany, Complex<T> *data, int dist, int stride)
 {
-   if (!src || !dst || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
+   if (!data || N <= 0 || howmany <= 0 || !IsPowerOf2(N))
    {
       return false;
    }
    
-   int srcRowStride = srcStride * W;
-   int dstRowStride = dstStride * W;
+   dist = (dist <= 0 ? N * stride : dist);
    
-   for (int y=0, srcOff=0, dstOff=0; y<H; ++y, srcOff+=srcRowStride, dstOff+=dstRowStride)
-   {
-      Inverse(W, src+srcOff, dst+dstOff, srcStride, dstStride);
-   }
+   TransformLines(N, howmany, data, data, stride, stride, howmany, dist, 0, dist, 0, true);
    
-   for (int x=0, off=0; x<W; ++x, off+=dstStride)
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::Forward(int W, int H, const T *src, T *dst, int srcStride, int dstStride)
+{
+   if (!src || !dst || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
    {
-      Inverse(H, dst+off, dstRowStride);
+      return false;
    }
    
+   Transform2D(W, H, src, dst, srcStride, dstStride, false);
+   
    return true;
 }
 
 template <typename T>
-bool gmath::FFT::Inverse(int W, int H, T *data, int stride)
+bool gmath::FFT::Forward(int W, int H, T *data, int stride)
 {
    if (!data || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
    {
       return false;
    }
    
-   int rowStride = stride * W;
+   Transform2D(W, H, (const T*) data, data, stride, stride, false);
    
-   for (int y=0, off=0; y<H; ++y, off+=rowStride)
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::Inverse(int W, int H, const T *src, T *dst, int srcStride, int dstStride)
+{
+   if (!src || !dst || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
    {
-      Inverse(W, data+off, stride);
+      return false;
    }
    
-   for (int x=0, off=0; x<W; ++x, off+=stride)
+   Transform2D(W, H, src, dst, srcStride, dstStride, true);
+   
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::Inverse(int W, int H, T *data, int stride)
+{
+   if (!data || W <= 0 || H <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H))
    {
-      Inverse(H, data+off, rowStride);
+      return false;
    }
    
+   Transform2D(W, H, (const T*) data, data, stride, stride, true);
+   
    return true;
 }
 
@@ -370,117 +591,301 @@ bool gmath::FFT::Forward(int W, int H, int D, const T *src, T *dst, int srcStrid
       return false;
    }
    
-   int srcRowStride = W * srcStride;
-   int srcColStride = H * srcRowStride;
-   int dstRowStride = W * dstStride;
-   int dstColStride = H * dstRowStride;
+   Transform3D(W, H, D, src, dst, srcStride, dstStride, false);
    
-   // Process each 2D slide
-   for (int d=0, srcOff=0, dstOff=0; d<D; ++d, srcOff+=srcColStride, dstOff+=dstColStride)
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::Forward(int W, int H, int D, T *data, int stride)
+{
+   if (!data || W <= 0 || H <= 0 || D <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H) || !IsPowerOf2(D))
    {
-      Forward(W, H, src+srcOff, dst+dstOff, srcStride, dstStride);
+      return false;
    }
    
-   // Process each X/Y plane sample along depth
-   for (int y=0, off=0; y<H; ++y)
+   Transform3D(W, H, D, (const T*) data, data, stride, stride, false);
+   
+   return true;
+}
+
+template <typename T>
+bool gmath::FFT::Inverse(int W, int H, int D, const T *src, T *dst, int srcStride, int dstStride)
+{
+   if (!src || !dst || W <= 0 || H <= 0 || D <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H) || !IsPowerOf2(D))
    {
-      for (int x=0; x<W; ++x, off+=dstStride)
-      {
-         Forward(D, dst+off, dstColStride);
-      }
+      return false;
    }
    
+   Transform3D(W, H, D, src, dst, srcStride, dstStride, true);
+   
    return true;
 }
 
 template <typename T>
-bool gmath::FFT::Forward(int W, int H, int D, T *data, int stride)
+bool gmath::FFT::Inverse(int W, int H, int D, T *data, int stride)
 {
    if (!data || W <= 0 || H <= 0 || D <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H) || !IsPowerOf2(D))
    {
       return false;
    }
    
-   int rowStride = W * stride;
-   int colStride = H * rowStride;
+   Transform3D(W, H, D, (const T*) data, data, stride, stride, true);
    
-   // Process each 2D slide
-   for (int d=0, off=0; d<D; ++d, off+=colStride)
+   return true;
+}
+
+// ---
+
+template <typename T>
+gmath::FFTPlan<T>::FFTPlan()
+   : mN(0), mLog2N(0), mAlgorithm(Stockham)
+{
+}
+
+template <typename T>
+gmath::FFTPlan<T>::FFTPlan(int N, Algorithm alg)
+   : mN(0), mLog2N(0), mAlgorithm(alg)
+{
+   setup(N, alg);
+}
+
+template <typename T>
+bool gmath::FFTPlan<T>::setup(int N, Algorithm alg)
+{
+   if (N <= 0 || (N & (N - 1)) != 0)
    {
-      Forward(W, H, data+off, stride);
+      return false;
    }
    
-   // Process each X/Y plane sample along depth
-   for (int y=0, off=0; y<H; ++y)
+   mAlgorithm = alg;
+   
+   if (N != mN)
    {
-      for (int x=0; x<W; ++x, off+=stride)
+      mN = N;
+      mLog2N = 0;
+      while ((1 << mLog2N) < N)
+      {
+         ++mLog2N;
+      }
+      
+      double angleScale = -2.0 * M_PI / double(N);
+      
+      mTwiddles.resize(N > 1 ? N / 2 : 1);
+      for (int k=0; k<int(mTwiddles.size()); ++k)
       {
-         Forward(D, data+off, colStride);
+         mTwiddles[k] = Complex<T>(T(cos(angleScale * k)), T(sin(angleScale * k)));
       }
+      
+      mScratch.resize(N);
    }
    
    return true;
 }
 
 template <typename T>
-bool gmath::FFT::Inverse(int W, int H, int D, const T *src, T *dst, int srcStride, int dstStride)
+int gmath::FFTPlan<T>::getSize() const
 {
-   if (!src || !dst || W <= 0 || H <= 0 || D <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H) || !IsPowerOf2(D))
+   return mN;
+}
+
+template <typename T>
+typename gmath::FFTPlan<T>::Algorithm gmath::FFTPlan<T>::getAlgorithm() const
+{
+   return mAlgorithm;
+}
+
+template <typename T>
+void gmath::FFTPlan<T>::setAlgorithm(Algorithm alg)
+{
+   mAlgorithm = alg;
+}
+
+template <typename T>
+bool gmath::FFTPlan<T>::forward(const Complex<T> *src, Complex<T> *dst, int srcStride, int dstStride)
+{
+   if (!src || !dst || mN == 0)
    {
       return false;
    }
-   
-   int srcRowStride = W * srcStride;
-   int srcColStride = H * srcRowStride;
-   int dstRowStride = W * dstStride;
-   int dstColStride = H * dstRowStride;
-   
-   // Process each 2D slide
-   for (int d=0, srcOff=0, dstOff=0; d<D; ++d, srcOff+=srcColStride, dstOff+=dstColStride)
+   transform(src, srcStride, dst, dstStride, false);
+   return true;
+}
+
+template <typename T>
+bool gmath::FFTPlan<T>::forward(Complex<T> *data, int stride)
+{
+   if (!data || mN == 0)
    {
-      Inverse(W, H, src+srcOff, dst+dstOff, srcStride, dstStride);
+      return false;
+   }
+   transform(data, stride, data, stride, false);
+   return true;
+}
+
+template <typename T>
+bool gmath::FFTPlan<T>::inverse(const Complex<T> *src, Complex<T> *dst, int srcStride, int dstStride)
+{
+   if (!src || !dst || mN == 0)
+   {
+      return false;
+   }
+   transform(src, srcStride, dst, dstStride, true);
+   return true;
+}
+
+template <typename T>
+bool gmath::FFTPlan<T>::inverse(Complex<T> *data, int stride)
+{
+   if (!data || mN == 0)
+   {
+      return false;
    }
+   transform(data, stride, data, stride, true);
+   return true;
+}
+
+template <typename T>
+void gmath::FFTPlan<T>::transform(const Complex<T> *src, int srcStride, Complex<T> *dst, int dstStride, bool inverse)
+{
+   if (mAlgorithm == Stockham)
+   {
+      stockham(src, srcStride, dst, dstStride, inverse);
+   }
+   else
+   {
+      if (src == dst)
+      {
+         FFT::BitReverseSort(mN, dst, dstStride);
+      }
+      else
+      {
+         FFT::BitReverseSort(mN, src, dst, srcStride, dstStride);
+      }
+      radix2(dst, dstStride, inverse);
+   }
+}
+
+template <typename T>
+void gmath::FFTPlan<T>::radix2(Complex<T> *data, int stride, bool inverse) const
+{
+   Complex<T> w, product;
    
-   // Process each X/Y plane sample along depth
-   for (int y=0, off=0; y<H; ++y)
+   for (int step=1, tstep=mN/2; step<mN; step<<=1, tstep>>=1)
    {
-      for (int x=0; x<W; ++x, off+=dstStride)
+      int period = step << 1;
+      
+      for (int f=0; f<step; ++f)
       {
-         Inverse(D, dst+off, dstColStride);
+         w = mTwiddles[f * tstep];
+         if (inverse)
+         {
+            w.im = -w.im;
+         }
+         
+         for (int n=f; n<mN; n+=period)
+         {
+            Complex<T> &a = data[n * stride];
+            Complex<T> &b = data[(n + step) * stride];
+            product = w * b;
+            b = a - product;
+            a += product;
+         }
       }
    }
    
-   return true;
+   if (inverse)
+   {
+      T scale = T(1.0 / double(mN));
+      for (int i=0; i<mN; ++i)
+      {
+         data[i * stride] *= scale;
+      }
+   }
 }
 
 template <typename T>
-bool gmath::FFT::Inverse(int W, int H, int D, T *data, int stride)
+void gmath::FFTPlan<T>::stockham(const Complex<T> *src, int srcStride, Complex<T> *dst, int dstStride, bool inverse)
 {
-   if (!data || W <= 0 || H <= 0 || D <= 0 || !IsPowerOf2(W) || !IsPowerOf2(H) || !IsPowerOf2(D))
+   if (mN == 1)
    {
-      return false;
+      if (src != dst)
+      {
+         dst[0] = src[0];
+      }
+      return;
    }
    
-   int rowStride = W * stride;
-   int colStride = H * rowStride;
+   // Pass i writes to the final buffer when (log2(N) - i) is even, the other buffer otherwise.
+   // In-place transforms with an odd pass count end in the scratch buffer so that the
+   // first pass never overwrites its own input.
+   bool inPlace = (src == dst);
+   bool endInScratch = (inPlace && (mLog2N & 1) != 0);
    
-   // Process each 2D slide
-   for (int d=0, off=0; d<D; ++d, off+=colStride)
+   Complex<T> *target = (endInScratch ? &mScratch[0] : dst);
+   Complex<T> *other = (endInScratch ? dst : &mScratch[0]);
+   int targetStride = (endInScratch ? 1 : dstStride);
+   int otherStride = (endInScratch ? dstStride : 1);
+   
+   T scale = T(inverse ? 1.0 / double(mN) : 1.0);
+   
+   const Complex<T> *x = src;
+   int xs = srcStride;
+   
+   for (int pass=1, n=mN, s=1; n>1; ++pass, n>>=1, s<<=1)
    {
-      Inverse(W, H, data+off, stride);
+      bool toFinal = (((mLog2N - pass) & 1) == 0);
+      Complex<T> *y = (toFinal ? target : other);
+      int ys = (toFinal ? targetStride : otherStride);
+      int m = n >> 1;
+      
+      if (n == 2)
+      {
+         // last pass: unit twiddle, fused inverse scaling
+         for (int q=0; q<s; ++q)
+         {
+            Complex<T> a = x[q * xs];
+            Complex<T> b = x[(q + s) * xs];
+            y[q * ys] = (a + b) * scale;
+            y[(q + s) * ys] = (a - b) * scale;
+         }
+      }
+      else
+      {
+         for (int p=0; p<m; ++p)
+         {
+            Complex<T> w = mTwiddles[p * s];
+            if (inverse)
+            {
+               w.im = -w.im;
+            }
+            
+            const Complex<T> *xa = x + (s * p) * xs;
+            const Complex<T> *xb = x + (s * (p + m)) * xs;
+            Complex<T> *ya = y + (s * 2 * p) * ys;
+            Complex<T> *yb = y + (s * (2 * p + 1)) * ys;
+            
+            for (int q=0; q<s; ++q)
+            {
+               Complex<T> a = xa[q * xs];
+               Complex<T> b = xb[q * xs];
+               ya[q * ys] = a + b;
+               yb[q * ys] = (a - b) * w;
+            }
+         }
+      }
+      
+      x = y;
+      xs = ys;
    }
    
-   // Process each X/Y plane sample along depth
-   for (int y=0, off=0; y<H; ++y)
+   if (endInScratch)
    {
-      for (int x=0; x<W; ++x, off+=stride)
+      for (int i=0; i<mN; ++i)
       {
-         Inverse(D, data+off, colStride);
+         dst[i * dstStride] = mScratch[i];
       }
    }
-   
-   return true;
 }
 
 #endif
-
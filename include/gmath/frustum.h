@@ -31,6 +31,10 @@ SOFTWARE.
 
 namespace gmath {
   
+  class GMATH_API AABox;
+  class GMATH_API OBox;
+  class GMATH_API Sphere;
+  
   enum ProjectionMode {
     PM_ORTHOGRAPHIC = 0,
     PM_PERSPECTIVE,
@@ -50,6 +54,16 @@ namespace gmath {
         CORNER_FAR = CORNER_BACK
       };
       
+      enum {
+        ALL_PLANES_MASK = 0x3F
+      };
+      
+      enum Visibility {
+        OUTSIDE = 0,
+        INTERSECTING,
+        INSIDE
+      };
+      
       Frustum();
       Frustum(ProjectionMode mode, float fovy, float asp, float np, float fp);
       Frustum(const Frustum &rhs);
@@ -140,6 +154,27 @@ namespace gmath {
         return mProjMatrix;
       }
       
+      // Planes point outwards: a volume is OUTSIDE as soon as it is entirely on the
+      // positive side of one plane, INSIDE when entirely on the negative side of all.
+      // Volumes close to a frustum edge may be reported INTERSECTING while outside.
+      Visibility classify(const AABox &b) const;
+      Visibility classify(const OBox &b) const;
+      Visibility classify(const Sphere &s) const;
+      
+      // Hierarchical and coherent culling: only planes whose bit is set in planeMask
+      // are tested, on return the bits of planes the box is entirely inside of are
+      // cleared (children of the box can skip them). lastPlane is tested first and
+      // set to the plane that culled the box (keep it per object between frames).
+      Visibility classify(const AABox &b, unsigned char &planeMask, unsigned char &lastPlane) const;
+      
+      // Batch versions over n volumes in SoA layout, boxes as center and half extents,
+      // spheres as center and radius. 4 volumes are tested at once with SSE, planes are
+      // skipped when no volume of a group needs them and testing starts with the plane
+      // that culled the previous group. masks (optional, in/out) work as planeMask above,
+      // per volume. results get Visibility values, returns the number of visible volumes.
+      size_t classify(const float *const center[3], const float *const extents[3], size_t n, unsigned char *results, unsigned char *masks=0) const;
+      size_t classify(const float *const center[3], const float *radius, size_t n, unsigned char *results, unsigned char *masks=0) const;
+      
     protected:
       
       void updateNearRect() const;
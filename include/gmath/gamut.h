@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_gamut_h_
+#define __gmath_gamut_h_
+
+#include <gmath/color.h>
+
+namespace gmath
+{
+   // Maps linear RGB colors of a color space into its gamut.
+   //
+   // A color is in gamut if none of its channels is negative (and none is above 1 when
+   // the mapper is bounded, for display referred values). Methods:
+   //   Clip:       clamps channels, hue may shift
+   //   Desaturate: keeps LAB lightness and hue (relative to the color space white) and
+   //               lowers chroma until the color fits, found by bisection (1e-4 relative
+   //               precision). Colors with negative luminance (or above 1 when bounded)
+   //               have no in gamut grey and are clipped.
+   //   Compress:   ACES reference gamut compression (RGC): per channel distance to the
+   //               achromatic axis d = (max(r, g, b) - c) / |max(r, g, b)| is compressed
+   //               above threshold so that limit maps to 1. Colors close to the gamut
+   //               boundary are affected too, the upper bound is ignored. Defaults are the
+   //               ACES 1.3 values (meant for ACEScg).
+   //
+   // Batch functions test 4 pixels at once and only run the per pixel path on the ones
+   // that need it (out of gamut, or beyond the compression threshold).
+   //
+   // The mapper keeps a reference to its color space, it must outlive it.
+   
+   class GMATH_API GamutMapper
+   {
+   public:
+      
+      enum Method
+      {
+         Clip = 0,
+         Desaturate,
+         Compress
+      };
+      
+      GamutMapper(const ColorSpace &cs, Method method=Desaturate, bool bounded=false);
+      GamutMapper(const GamutMapper &rhs);
+      ~GamutMapper();
+      
+      void setMethod(Method method);
+      Method getMethod() const;
+      
+      void setBounded(bool bounded);
+      bool isBounded() const;
+      
+      // Per channel (r, g, b) thresholds in [0, 1) and limits > 1, power > 0
+      bool setCompression(const float threshold[3], const float limit[3], float power);
+      
+      const ColorSpace& getColorSpace() const;
+      
+      bool inGamut(const RGB &rgb) const;
+      // XYZ color inside the color space gamut
+      bool inGamut(const XYZ &xyz) const;
+      
+      RGB operator()(const RGB &rgb) const;
+      
+      // Pixel layouts as for ColorSpace batch conversions (in and out may alias)
+      bool apply(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool apply(const float *const in[3], float *const out[3], size_t npixels) const;
+      
+      // Writes 1 for pixels out of gamut, 0 otherwise, to mask (may be null) and returns
+      // the number of pixels out of gamut
+      size_t classify(const float *in, unsigned char *mask, size_t npixels, size_t stride=3) const;
+      size_t classify(const float *const in[3], unsigned char *mask, size_t npixels) const;
+      
+      // Block kernel used by the batch functions above (single threaded, in and out may alias)
+      void eval(const float *const in[3], float *const out[3], size_t count) const;
+      
+   private:
+      
+      GamutMapper& operator=(const GamutMapper&);
+      
+      void update();
+      void map(float *c) const;
+      
+   private:
+      
+      const ColorSpace &mColorSpace;
+      Method mMethod;
+      bool mBounded;
+      float mThreshold[3];
+      float mLimit[3];
+      float mPower;
+      // RGC scale per channel
+      float mScale[3];
+      // LAB white point
+      float mWhite[3];
+   };
+}
+
+#endif
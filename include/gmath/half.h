@@ -0,0 +1,57 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_half_h_
+#define __gmath_half_h_
+
+#include <gmath/config.h>
+
+namespace gmath
+{
+   // IEEE 754 binary16 value (same memory layout as OpenEXR half), storage only.
+   //
+   // Float to half conversion rounds to nearest even, finite values beyond the half
+   // range become infinities and NaNs stay NaNs. Half to float conversion is exact,
+   // except that signaling NaNs come out quiet.
+   // Array conversions use the F16C instructions when the CPU supports them and
+   // lookup tables otherwise, both giving the same results.
+   
+   struct Half
+   {
+      unsigned short bits;
+   };
+   
+   GMATH_API float HalfToFloat(Half h);
+   GMATH_API Half FloatToHalf(float f);
+   
+   GMATH_API void HalfToFloat(const Half *in, float *out, size_t n);
+   GMATH_API void FloatToHalf(const float *in, Half *out, size_t n);
+   
+   // True if array conversions use F16C
+   GMATH_API bool HasF16C();
+}
+
+#endif
@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_lut3d_h_
+#define __gmath_lut3d_h_
+
+#include <gmath/colorpipeline.h>
+
+namespace gmath
+{
+   // 3D color lookup table with an optional per-channel 1D shaper.
+   //
+   // Input values first go through the shaper (if any), then are mapped from the
+   // [min, max] domain of the lattice to lattice coordinates (clamped) and interpolated.
+   // Lattice entries are stored red fastest, as in .cube files.
+   //
+   // Baking samples a color transform (a ColorPipeline or any batch function) at the
+   // lattice points. A Gamma shaper spreads the lattice points evenly in the encoded
+   // space of the function (Unlinearize), which suits scene linear input. It is evaluated
+   // with the Gamma batch functions when applying the LUT and sampled on 4096 entries when
+   // written to a .cube file.
+   //
+   // .cube files: reads and writes the Adobe (DOMAIN_MIN/DOMAIN_MAX) and Resolve
+   // (LUT_1D_INPUT_RANGE/LUT_3D_INPUT_RANGE, 1D shaper followed by 3D table) flavors.
+   // A 1D only file is loaded as a shaper followed by an identity lattice.
+   
+   class GMATH_API LUT3D
+   {
+   public:
+      
+      enum Interpolation
+      {
+         Trilinear = 0,
+         Tetrahedral
+      };
+      
+      // Interleaved RGB in and out, in != out
+      typedef void (*BatchFunc)(const float *in, float *out, size_t npixels, void *userData);
+      
+   public:
+      
+      LUT3D();
+      LUT3D(const LUT3D &rhs);
+      ~LUT3D();
+      
+      LUT3D& operator=(const LUT3D &rhs);
+      
+      void clear();
+      bool isValid() const;
+      
+      // Identity lattice
+      bool setup(int size, float domainMin=0.0f, float domainMax=1.0f);
+      bool setup(int size, const float domainMin[3], const float domainMax[3]);
+      
+      bool bake(const ColorPipeline &pipeline, int size, float domainMin=0.0f, float domainMax=1.0f);
+      bool bake(const ColorPipeline &pipeline, int size, Gamma::Function shaper, float domainMin, float domainMax);
+      bool bake(BatchFunc func, void *userData, int size, float domainMin=0.0f, float domainMax=1.0f);
+      bool bake(BatchFunc func, void *userData, int size, Gamma::Function shaper, float domainMin, float domainMax);
+      
+      int getSize() const;
+      void getDomain(float domainMin[3], float domainMax[3]) const;
+      const float* getData() const;
+      float* getData();
+      
+      bool hasShaper() const;
+      
+      void setInterpolation(Interpolation interp);
+      Interpolation getInterpolation() const;
+      
+      RGB operator()(const RGB &input) const;
+      
+      // Same pixel layouts as ColorSpace batch conversions, split over threads
+      bool apply(const float *in, float *out, size_t npixels, size_t stride=3) const;
+      bool apply(const float *const in[3], float *const out[3], size_t npixels) const;
+      // Half float pixels, stride in halves
+      bool apply(const Half *in, Half *out, size_t npixels, size_t stride=3) const;
+      bool apply(const Half *const in[3], Half *const out[3], size_t npixels) const;
+      
+      bool read(const char *path);
+      bool write(const char *path, const char *title=0) const;
+      
+   public:
+      
+      // Block kernel, see apply
+      void eval(const float *const in[3], float *const out[3], size_t count) const;
+      
+   private:
+      
+      bool bake(BatchFunc func, void *userData, int size, const Gamma::Function *shaper, float domainMin, float domainMax);
+      void shape(const float *const in[3], float *const out[3], size_t count) const;
+      
+   private:
+      
+      int mSize;
+      float mMin[3];
+      float mMax[3];
+      std::vector<float> mData;
+      
+      // 0: none, 1: gamma, 2: table
+      int mShaperType;
+      Gamma::Function mShaperGamma;
+      float mShaperOffset;
+      float mShaperScale;
+      int mShaperSize;
+      float mShaperMin[3];
+      float mShaperMax[3];
+      std::vector<float> mShaper;
+      
+      Interpolation mInterpolation;
+   };
+}
+
+#endif
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_parallel_h_
+#define __gmath_parallel_h_
+
+#include <gmath/config.h>
+
+namespace gmath
+{
+   // Fixed size thread pool shared by all the threaded code paths of gmath.
+   //
+   // A parallel loop over [0, count) is split in ceil(count / grain) chunks
+   // that worker threads (and the calling thread) pick up in any order.
+   // The chunk boundaries only depend on count and grain, not on the number
+   // of threads, so functions that write disjoint outputs per chunk or
+   // reduce per-chunk results in chunk order are deterministic.
+   //
+   // The following environment variable controls the default thread count
+   //   GMATH_NUM_THREADS: number of threads to use (hardware concurrency by default)
+   // Parallel loops started from inside a parallel loop run serially.
+   
+   class GMATH_API Parallel
+   {
+   public:
+      
+      typedef void (*RangeFunc)(size_t begin, size_t end, void *userData);
+      
+      // n = 0 resets to the default thread count, n = 1 disables threading
+      static void SetThreadCount(size_t n);
+      static size_t GetThreadCount();
+      
+      static size_t ChunkCount(size_t count, size_t grain);
+      
+      static void For(size_t count, size_t grain, RangeFunc func, void *userData);
+      
+      // Func must provide: void operator()(size_t begin, size_t end) const
+      template <class Func>
+      static void For(size_t count, size_t grain, const Func &func);
+   
+   private:
+      
+      template <class Func>
+      static void CallFunc(size_t begin, size_t end, void *userData);
+   };
+}
+
+// ---
+
+template <class Func>
+void gmath::Parallel::CallFunc(size_t begin, size_t end, void *userData)
+{
+   (*((const Func*) userData))(begin, end);
+}
+
+template <class Func>
+inline void gmath::Parallel::For(size_t count, size_t grain, const Func &func)
+{
+   For(count, grain, &CallFunc<Func>, (void*) &func);
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_quantizer_h_
+#define __gmath_quantizer_h_
+
+#include <gmath/color.h>
+#include <gmath/colordiff.h>
+
+namespace gmath
+{
+   // Palette generation and remapping for display referred RGB images (encoded with a
+   // Gamma function, values clamped to [0, 1]).
+   //
+   // addPixels() accumulates a histogram of 5 bits per channel (32768 bins keeping pixel
+   // counts and RGB sums), built in parallel chunks merged in order so results don't
+   // depend on the thread count. buildPalette() works on the non-empty bins in LAB:
+   // median cut splits the box with the largest count weighted variance at the weighted
+   // median of its widest axis, k-means then moves colors to the weighted mean of the
+   // bins nearest to them (CIE76). Palette colors are the RGB means of their bins so
+   // they stay in gamut.
+   //
+   // remap() looks up nearest palette colors in a table of 6 bits per channel (cell
+   // centers matched in LAB through PaletteIndex, built with the palette). Ordered
+   // dithering adds an 8x8 Bayer offset of about the palette spacing, Floyd-Steinberg
+   // diffuses the error in RGB along serpentine rows in independent bands of 32 rows
+   // processed in parallel.
+   //
+   // The quantizer keeps a reference to its color space, it must outlive it.
+   
+   class GMATH_API ColorQuantizer
+   {
+   public:
+      
+      static const size_t MaxColors = 256;
+      
+      enum Method
+      {
+         MedianCut = 0,
+         KMeans       // median cut refined by k-means
+      };
+      
+      enum Dither
+      {
+         NoDither = 0,
+         Ordered,
+         FloydSteinberg
+      };
+      
+      ColorQuantizer(const ColorSpace &cs, Gamma::Function gf=Gamma::sRGB);
+      ~ColorQuantizer();
+      
+      // Clears histogram and palette
+      void clear();
+      void clearHistogram();
+      
+      // Adds pixels to the histogram (pixel layouts as for ColorSpace batch conversions)
+      bool addPixels(const float *rgb, size_t npixels, size_t stride=3);
+      bool addPixels(const float *const rgb[3], size_t npixels);
+      
+      size_t getPixelCount() const;
+      // Number of non-empty histogram bins
+      size_t getHistogramColorCount() const;
+      
+      // Builds a palette of at most ncolors in [1, MaxColors] from the histogram, fewer if
+      // the histogram has fewer colors. Returns false if the histogram is empty.
+      bool buildPalette(size_t ncolors, Method method=KMeans, int iterations=8);
+      // Uses the given palette (encoded RGB)
+      bool setPalette(const RGB *palette, size_t n);
+      
+      size_t getColorCount() const;
+      // Encoded RGB
+      RGB getColor(size_t i) const;
+      LAB getColorLAB(size_t i) const;
+      
+      // Exact nearest palette color in LAB (not table driven)
+      size_t nearest(const RGB &rgb) const;
+      
+      // Image of width x height pixels stored row after row, one palette index per pixel
+      bool remap(const float *rgb, size_t width, size_t height, unsigned char *indices, Dither dither=NoDither, size_t stride=3) const;
+      bool remap(const float *const rgb[3], size_t width, size_t height, unsigned char *indices, Dither dither=NoDither) const;
+      
+   public:
+      
+      struct Bin
+      {
+         double sum[3];
+         unsigned int count;
+      };
+      
+   private:
+      
+      ColorQuantizer(const ColorQuantizer&);
+      ColorQuantizer& operator=(const ColorQuantizer&);
+      
+      // Encoded RGB to LAB (interleaved, in and out may alias)
+      void toLAB(const float *rgb, float *lab, size_t n) const;
+      void updatePalette();
+      
+      template <class Pixels>
+      bool remapPixels(const Pixels &px, size_t width, size_t height, unsigned char *indices, Dither dither) const;
+      
+   private:
+      
+      const ColorSpace &mColorSpace;
+      Gamma::Function mGamma;
+      std::vector<Bin> mHistogram;
+      size_t mPixelCount;
+      // Encoded RGB
+      std::vector<RGB> mPalette;
+      PaletteIndex mIndex;
+      std::vector<unsigned char> mTable;
+   };
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_spectrum_h_
+#define __gmath_spectrum_h_
+
+#include <gmath/color.h>
+
+namespace gmath
+{
+   // Spectra as dense float arrays to XYZ or RGB, and RGB to spectra.
+   //
+   // Spectra are sampled at a fixed set of increasing wavelengths (nm, not necessarily
+   // uniform) and taken as piecewise linear between samples (zero outside). setup()
+   // integrates each sample's hat function against the standard observer (linearly
+   // interpolated between its 5nm entries, zero outside [380, 780]) and, if a color space
+   // is given, folds in its XYZ to RGB matrix. Converting a spectrum is then 3 dot
+   // products. Weights are in the same units as IntegrateVisibleSpectrum (interval
+   // lengths in meters) unless normalized: a constant spectrum of 1 then has Y = 1 and,
+   // with a color space, is adapted (von Kries) from illuminant E to the color space white.
+   //
+   // RGB to spectrum upsampling follows Smits ("An RGB to Spectrum Conversion for
+   // Reflectances", 1999): white, cyan, magenta, yellow, red, green and blue basis
+   // spectra resampled at the projection wavelengths. Results are smooth reflectances,
+   // within [0, 1.015] for RGB in [0, 1]. Through a normalized projection in a color space
+   // with primaries close to Rec709, greys come back within 1% of the input and saturated
+   // colors within 0.1 (blue being the worst).
+   
+   class GMATH_API SpectralProjection
+   {
+   public:
+      
+      SpectralProjection();
+      ~SpectralProjection();
+      
+      void clear();
+      
+      // nsamples (>= 2) uniformly spaced wavelengths in [lambdaMin, lambdaMax]
+      bool setup(size_t nsamples, float lambdaMin, float lambdaMax, const ColorSpace *cs=0, bool normalize=false, const float stdobs[81][3]=0);
+      bool setup(const float *wavelengths, size_t nsamples, const ColorSpace *cs=0, bool normalize=false, const float stdobs[81][3]=0);
+      
+      size_t getSampleCount() const;
+      float getWavelength(size_t i) const;
+      // Contribution of sample i to output channel c (X, Y, Z or R, G, B)
+      float getWeight(size_t i, int c) const;
+      
+      void operator()(const float *spectrum, float out[3]) const;
+      
+      // spectra: nspectra arrays of getSampleCount() floats, spectrumStride floats apart
+      //          (0 for tightly packed)
+      // out:     3 floats per spectrum, outStride floats apart
+      // Split over threads (see Parallel). Return false on invalid arguments.
+      bool apply(const float *spectra, float *out, size_t nspectra, size_t spectrumStride=0, size_t outStride=3) const;
+      
+      void upsample(const RGB &rgb, float *spectrum) const;
+      bool upsample(const float *rgb, float *spectra, size_t n, size_t rgbStride=3, size_t spectrumStride=0) const;
+      
+   private:
+      
+      SpectralProjection(const SpectralProjection&);
+      SpectralProjection& operator=(const SpectralProjection&);
+      
+   private:
+      
+      size_t mCount;
+      // Weights and basis spectra planes of mPadded floats (mCount rounded up to 4, zero
+      // filled): X/R, Y/G, Z/B, then Smits white, cyan, magenta, yellow, red, green, blue
+      size_t mPadded;
+      std::vector<float> mWavelengths;
+      std::vector<float> mData;
+   };
+}
+
+#endif
@@ -0,0 +1,440 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_stft_h_
+#define __gmath_stft_h_
+
+#include <gmath/fft.h>
+
+namespace gmath
+{
+   // Periodic windows (suitable for overlap-add resynthesis)
+   enum WindowFunction
+   {
+      WF_Rectangular = 0,
+      WF_Hann,
+      WF_Hamming,
+      WF_Blackman,
+      WF_BlackmanHarris
+   };
+   
+   template <typename T>
+   void MakeWindow(WindowFunction wf, int N, T *w);
+   
+   // Short-time Fourier transform of an unbounded real signal.
+   //
+   // Input samples go to an internal ring buffer, either copied with push() or
+   // written in place through getWriteBuffer()/commit(). Every time frameSize
+   // samples starting at a multiple of hopSize are available, the windowed frame
+   // is transformed and its frameSize/2+1 first bins are passed to the frame
+   // callback. The bins buffer is owned by the STFT and only valid during the call.
+   // No memory is allocated after setup().
+   
+   template <typename T>
+   class STFT
+   {
+   public:
+      
+      typedef void (*FrameFunc)(const Complex<T> *bins, int nbins, long frame, void *userData);
+      
+      STFT();
+      ~STFT();
+      
+      // frameSize must be a power of 2, hopSize in [1, frameSize]
+      bool setup(int frameSize, int hopSize, WindowFunction wf=WF_Hann);
+      void setCallback(FrameFunc func, void *userData=0);
+      void reset();
+      
+      int getFrameSize() const;
+      int getHopSize() const;
+      int getBinCount() const;
+      const T* getWindow() const;
+      
+      // Zero-copy input: write at most 'available' samples to the returned
+      // pointer and call commit with the number of samples written.
+      T* getWriteBuffer(int &available);
+      // returns the number of frames emitted
+      int commit(int n);
+      int push(int n, const T *samples);
+      
+   private:
+      
+      STFT(const STFT<T>&);
+      STFT<T>& operator=(const STFT<T>&);
+      
+   private:
+      
+      int mFrameSize;
+      int mHopSize;
+      int mMask;
+      std::vector<T> mWindow;
+      std::vector<T> mRing;
+      std::vector<Complex<T> > mWork;
+      long mWritten;
+      long mFrame;
+      FrameFunc mFunc;
+      void *mUserData;
+   };
+   
+   // Inverse short-time Fourier transform (weighted overlap-add).
+   //
+   // Each call to process() takes the frameSize/2+1 bins of one frame and outputs
+   // hopSize samples: the output of frame k starts at input sample k * hopSize.
+   // As no frame precedes the first one, the first frameSize - hopSize output
+   // samples fade in.
+   
+   template <typename T>
+   class ISTFT
+   {
+   public:
+      
+      ISTFT();
+      ~ISTFT();
+      
+      bool setup(int frameSize, int hopSize, WindowFunction wf=WF_Hann);
+      void reset();
+      
+      int getFrameSize() const;
+      int getHopSize() const;
+      int getBinCount() const;
+      
+      bool process(const Complex<T> *bins, T *out);
+      
+   private:
+      
+      ISTFT(const ISTFT<T>&);
+      ISTFT<T>& operator=(const ISTFT<T>&);
+      
+   private:
+      
+      int mFrameSize;
+      int mHopSize;
+      std::vector<T> mWindow;
+      std::vector<T> mNorm;
+      std::vector<T> mAccum;
+      std::vector<Complex<T> > mWork;
+   };
+}
+
+// ---
+
+template <typename T>
+void gmath::MakeWindow(gmath::WindowFunction wf, int N, T *w)
+{
+   double s = 2.0 * M_PI / double(N);
+   
+   for (int i=0; i<N; ++i)
+   {
+      double a = s * i;
+      
+      switch (wf)
+      {
+      case WF_Hann:
+         w[i] = T(0.5 - 0.5 * cos(a));
+         break;
+      case WF_Hamming:
+         w[i] = T(0.54 - 0.46 * cos(a));
+         break;
+      case WF_Blackman:
+         w[i] = T(0.42 - 0.5 * cos(a) + 0.08 * cos(2.0 * a));
+         break;
+      case WF_BlackmanHarris:
+         w[i] = T(0.35875 - 0.48829 * cos(a) + 0.14128 * cos(2.0 * a) - 0.01168 * cos(3.0 * a));
+         break;
+      case WF_Rectangular:
+      default:
+         w[i] = T(1);
+         break;
+      }
+   }
+}
+
+// ---
+
+template <typename T>
+gmath::STFT<T>::STFT()
+   : mFrameSize(0), mHopSize(0), mMask(0), mWritten(0), mFrame(0), mFunc(0), mUserData(0)
+{
+}
+
+template <typename T>
+gmath::STFT<T>::~STFT()
+{
+}
+
+template <typename T>
+bool gmath::STFT<T>::setup(int frameSize, int hopSize, WindowFunction wf)
+{
+   if (frameSize <= 0 || (frameSize & (frameSize - 1)) != 0 || hopSize <= 0 || hopSize > frameSize)
+   {
+      return false;
+   }
+   
+   mFrameSize = frameSize;
+   mHopSize = hopSize;
+   
+   // twice the frame size so that at least frameSize samples can always be written
+   mMask = 2 * frameSize - 1;
+   
+   mWindow.resize(frameSize);
+   MakeWindow(wf, frameSize, &mWindow[0]);
+   
+   mRing.assign(2 * frameSize, T(0));
+   mWork.resize(frameSize);
+   
+   reset();
+   
+   return true;
+}
+
+template <typename T>
+void gmath::STFT<T>::setCallback(FrameFunc func, void *userData)
+{
+   mFunc = func;
+   mUserData = userData;
+}
+
+template <typename T>
+void gmath::STFT<T>::reset()
+{
+   mWritten = 0;
+   mFrame = 0;
+}
+
+template <typename T>
+int gmath::STFT<T>::getFrameSize() const
+{
+   return mFrameSize;
+}
+
+template <typename T>
+int gmath::STFT<T>::getHopSize() const
+{
+   return mHopSize;
+}
+
+template <typename T>
+int gmath::STFT<T>::getBinCount() const
+{
+   return (mFrameSize / 2 + 1);
+}
+
+template <typename T>
+const T* gmath::STFT<T>::getWindow() const
+{
+   return (mWindow.size() > 0 ? &mWindow[0] : 0);
+}
+
+template <typename T>
+T* gmath::STFT<T>::getWriteBuffer(int &available)
+{
+   if (mFrameSize == 0)
+   {
+      available = 0;
+      return 0;
+   }
+   
+   int capacity = mMask + 1;
+   int offset = int(mWritten & mMask);
+   // samples from the next frame start on must not be overwritten
+   long pending = mWritten - mFrame * mHopSize;
+   
+   available = std::min(capacity - offset, capacity - int(pending));
+   
+   return &mRing[offset];
+}
+
+template <typename T>
+int gmath::STFT<T>::commit(int n)
+{
+   int nframes = 0;
+   
+   if (mFrameSize == 0 || n <= 0)
+   {
+      return 0;
+   }
+   
+   mWritten += n;
+   
+   for (long start = mFrame * mHopSize; mWritten - start >= mFrameSize; start += mHopSize)
+   {
+      for (int i=0; i<mFrameSize; ++i)
+      {
+         mWork[i].re = mWindow[i] * mRing[(start + i) & mMask];
+         mWork[i].im = T(0);
+      }
+      
+      FFT::Forward(mFrameSize, &mWork[0]);
+      
+      if (mFunc)
+      {
+         mFunc(&mWork[0], getBinCount(), mFrame, mUserData);
+      }
+      
+      ++mFrame;
+      ++nframes;
+   }
+   
+   return nframes;
+}
+
+template <typename T>
+int gmath::STFT<T>::push(int n, const T *samples)
+{
+   int nframes = 0;
+   
+   while (n > 0)
+   {
+      int available = 0;
+      T *buffer = getWriteBuffer(available);
+      
+      if (!buffer || available <= 0)
+      {
+         break;
+      }
+      
+      int count = std::min(n, available);
+      
+      std::copy(samples, samples + count, buffer);
+      
+      nframes += commit(count);
+      samples += count;
+      n -= count;
+   }
+   
+   return nframes;
+}
+
+// ---
+
+template <typename T>
+gmath::ISTFT<T>::ISTFT()
+   : mFrameSize(0), mHopSize(0)
+{
+}
+
+template <typename T>
+gmath::ISTFT<T>::~ISTFT()
+{
+}
+
+template <typename T>
+bool gmath::ISTFT<T>::setup(int frameSize, int hopSize, WindowFunction wf)
+{
+   if (frameSize <= 0 || (frameSize & (frameSize - 1)) != 0 || hopSize <= 0 || hopSize > frameSize)
+   {
+      return false;
+   }
+   
+   mFrameSize = frameSize;
+   mHopSize = hopSize;
+   
+   mWindow.resize(frameSize);
+   MakeWindow(wf, frameSize, &mWindow[0]);
+   
+   // steady state sum of analysis * synthesis windows at each hop offset
+   mNorm.assign(hopSize, T(0));
+   for (int i=0; i<frameSize; ++i)
+   {
+      mNorm[i % hopSize] += mWindow[i] * mWindow[i];
+   }
+   for (int i=0; i<hopSize; ++i)
+   {
+      mNorm[i] = (mNorm[i] > T(1e-6) ? T(1) / mNorm[i] : T(0));
+   }
+   
+   mAccum.resize(frameSize);
+   mWork.resize(frameSize);
+   
+   reset();
+   
+   return true;
+}
+
+template <typename T>
+void gmath::ISTFT<T>::reset()
+{
+   std::fill(mAccum.begin(), mAccum.end(), T(0));
+}
+
+template <typename T>
+int gmath::ISTFT<T>::getFrameSize() const
+{
+   return mFrameSize;
+}
+
+template <typename T>
+int gmath::ISTFT<T>::getHopSize() const
+{
+   return mHopSize;
+}
+
+template <typename T>
+int gmath::ISTFT<T>::getBinCount() const
+{
+   return (mFrameSize / 2 + 1);
+}
+
+template <typename T>
+bool gmath::ISTFT<T>::process(const Complex<T> *bins, T *out)
+{
+   if (mFrameSize == 0 || !bins || !out)
+   {
+      return false;
+   }
+   
+   int N = mFrameSize;
+   int hN = N / 2;
+   
+   // rebuild the hermitian spectrum of the real frame
+   for (int k=0; k<=hN; ++k)
+   {
+      mWork[k] = bins[k];
+   }
+   for (int k=1; k<hN; ++k)
+   {
+      mWork[N - k] = bins[k].conjugate();
+   }
+   
+   FFT::Inverse(N, &mWork[0]);
+   
+   for (int i=0; i<N; ++i)
+   {
+      mAccum[i] += mWindow[i] * mWork[i].re;
+   }
+   
+   for (int i=0; i<mHopSize; ++i)
+   {
+      out[i] = mAccum[i] * mNorm[i];
+   }
+   
+   std::copy(mAccum.begin() + mHopSize, mAccum.end(), mAccum.begin());
+   std::fill(mAccum.end() - mHopSize, mAccum.end(), T(0));
+   
+   return true;
+}
+
+#endif
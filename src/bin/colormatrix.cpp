@@ -25,15 +25,45 @@ SOFTWARE.
 */
 
 #include <gmath/color.h>
+#include <gmath/colorpipeline.h>
+#include <gmath/parallel.h>
 #include <string>
 #include <iostream>
+#include <cstdio>
+#include <cctype>
+#ifdef _WIN32
+#  include <windows.h>
+#  include <io.h>
+#  include <fcntl.h>
+#else
+#  include <sys/time.h>
+#endif
 
 enum FlagOp
 {
    NoOP = 0,
    SetSrcCS,
    SetDstCS,
-   SetCAT
+   SetCAT,
+   SetInput,
+   SetOutput,
+   SetFormat,
+   SetChannels,
+   SetLinearize,
+   SetUnlinearize,
+   SetThreads,
+   SetChunkSize,
+   SetBenchmark
+};
+
+enum PixelFormat
+{
+   UnknownFormat = -1,
+   RawFloat = 0,
+   RawHalf,
+   RawUInt16,
+   PFM,
+   PPM
 };
 
 const gmath::ColorSpace* GetColorspace(const std::string &name)
@@ -108,6 +138,406 @@ int GetChromaticAdaptationTransform(const std::string &name)
    }
 }
 
+int GetGamma(const std::string &name)
+{
+   if (name == "Power22")
+   {
+      return gmath::Gamma::Power22;
+   }
+   else if (name == "Power24")
+   {
+      return gmath::Gamma::Power24;
+   }
+   else if (name == "sRGB")
+   {
+      return gmath::Gamma::sRGB;
+   }
+   else if (name == "Rec709")
+   {
+      return gmath::Gamma::Rec709;
+   }
+   else if (name == "Rec2020")
+   {
+      return gmath::Gamma::Rec2020;
+   }
+   else if (name == "LogC")
+   {
+      return gmath::Gamma::LogC;
+   }
+   else if (name == "LogCv2")
+   {
+      return gmath::Gamma::LogCv2;
+   }
+   else if (name == "Cineon")
+   {
+      return gmath::Gamma::Cineon;
+   }
+   else
+   {
+      return -1;
+   }
+}
+
+PixelFormat GetFormat(const std::string &name)
+{
+   if (name == "float")
+   {
+      return RawFloat;
+   }
+   else if (name == "half")
+   {
+      return RawHalf;
+   }
+   else if (name == "uint16")
+   {
+      return RawUInt16;
+   }
+   else if (name == "pfm")
+   {
+      return PFM;
+   }
+   else if (name == "ppm")
+   {
+      return PPM;
+   }
+   else
+   {
+      return UnknownFormat;
+   }
+}
+
+double WallTime()
+{
+#ifdef _WIN32
+   return 0.001 * double(GetTickCount64());
+#else
+   struct timeval tv;
+   gettimeofday(&tv, 0);
+   return double(tv.tv_sec) + 1e-6 * double(tv.tv_usec);
+#endif
+}
+
+bool IsLittleEndian()
+{
+   unsigned short v = 1;
+   return (*((const unsigned char*) &v) == 1);
+}
+
+// ---
+
+// Stream of bytes read from a file or from memory (benchmark)
+class Source
+{
+public:
+   Source()
+      : mFile(0), mData(0), mSize(0), mPos(0)
+   {
+   }
+   
+   Source(FILE *f)
+      : mFile(f), mData(0), mSize(0), mPos(0)
+   {
+   }
+   
+   Source(const unsigned char *data, size_t size)
+      : mFile(0), mData(data), mSize(size), mPos(0)
+   {
+   }
+   
+   size_t read(void *dst, size_t bytes)
+   {
+      if (mFile)
+      {
+         return fread(dst, 1, bytes, mFile);
+      }
+      size_t n = std::min(bytes, mSize - mPos);
+      memcpy(dst, mData + mPos, n);
+      mPos += n;
+      return n;
+   }
+   
+   // Header token (skipping whitespaces and # comments)
+   bool token(std::string &tok)
+   {
+      tok.clear();
+      int c = next();
+      while (c != EOF && (isspace(c) || c == '#'))
+      {
+         if (c == '#')
+         {
+            while (c != EOF && c != '\n')
+            {
+               c = next();
+            }
+         }
+         c = next();
+      }
+      while (c != EOF && !isspace(c))
+      {
+         tok.push_back(char(c));
+         c = next();
+      }
+      // the single whitespace after the last header token is consumed
+      return !tok.empty();
+   }
+   
+private:
+   int next()
+   {
+      unsigned char c;
+      return (read(&c, 1) == 1 ? int(c) : EOF);
+   }
+   
+   FILE *mFile;
+   const unsigned char *mData;
+   size_t mSize;
+   size_t mPos;
+};
+
+// Closes the opened input and output files when leaving scope (standard streams stay open)
+class Files
+{
+public:
+   Files()
+      : in(0), out(0)
+   {
+   }
+   
+   ~Files()
+   {
+      if (in && in != stdin)
+      {
+         fclose(in);
+      }
+      if (out && out != stdout)
+      {
+         fclose(out);
+      }
+   }
+   
+   FILE *in;
+   FILE *out;
+   
+private:
+   Files(const Files&);
+   Files& operator=(const Files&);
+};
+
+// Converts between stream bytes and interleaved floats, over threads
+class DecodeTask
+{
+public:
+   DecodeTask(PixelFormat format, bool swap, int maxval, const unsigned char *in, float *out)
+      : mFormat(format), mSwap(swap), mMaxval(maxval), mIn(in), mOut(out)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      if (mFormat == RawHalf)
+      {
+         // byte buffers come from operator new, aligned for any type
+         gmath::HalfToFloat((const gmath::Half*) mIn + begin, mOut + begin, end - begin);
+         return;
+      }
+      
+      for (size_t i=begin; i<end; ++i)
+      {
+         switch (mFormat)
+         {
+         case RawFloat:
+         case PFM:
+            {
+               unsigned char b[4];
+               memcpy(b, mIn + 4 * i, 4);
+               if (mSwap)
+               {
+                  std::swap(b[0], b[3]);
+                  std::swap(b[1], b[2]);
+               }
+               memcpy(mOut + i, b, 4);
+            }
+            break;
+         case RawUInt16:
+            {
+               unsigned short v;
+               memcpy(&v, mIn + 2 * i, 2);
+               mOut[i] = float(v) / 65535.0f;
+            }
+            break;
+         case PPM:
+            if (mMaxval < 256)
+            {
+               mOut[i] = float(mIn[i]) / float(mMaxval);
+            }
+            else
+            {
+               // 16 bits samples are big endian
+               mOut[i] = float((int(mIn[2 * i]) << 8) | int(mIn[2 * i + 1])) / float(mMaxval);
+            }
+            break;
+         default:
+            break;
+         }
+      }
+   }
+   
+private:
+   PixelFormat mFormat;
+   bool mSwap;
+   int mMaxval;
+   const unsigned char *mIn;
+   float *mOut;
+};
+
+class EncodeTask
+{
+public:
+   EncodeTask(PixelFormat format, bool swap, int maxval, const float *in, unsigned char *out)
+      : mFormat(format), mSwap(swap), mMaxval(maxval), mIn(in), mOut(out)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      if (mFormat == RawHalf)
+      {
+         gmath::FloatToHalf(mIn + begin, (gmath::Half*) mOut + begin, end - begin);
+         return;
+      }
+      
+      for (size_t i=begin; i<end; ++i)
+      {
+         switch (mFormat)
+         {
+         case RawFloat:
+         case PFM:
+            {
+               unsigned char b[4];
+               memcpy(b, mIn + i, 4);
+               if (mSwap)
+               {
+                  std::swap(b[0], b[3]);
+                  std::swap(b[1], b[2]);
+               }
+               memcpy(mOut + 4 * i, b, 4);
+            }
+            break;
+         case RawUInt16:
+            {
+               unsigned short v = (unsigned short) Quantize(mIn[i], 65535);
+               memcpy(mOut + 2 * i, &v, 2);
+            }
+            break;
+         case PPM:
+            if (mMaxval < 256)
+            {
+               mOut[i] = (unsigned char) Quantize(mIn[i], mMaxval);
+            }
+            else
+            {
+               int v = Quantize(mIn[i], mMaxval);
+               mOut[2 * i] = (unsigned char)(v >> 8);
+               mOut[2 * i + 1] = (unsigned char)(v & 0xFF);
+            }
+            break;
+         default:
+            break;
+         }
+      }
+   }
+   
+private:
+   static int Quantize(float v, int maxval)
+   {
+      // negated test so that nan goes to 0
+      if (!(v > 0.0f))
+      {
+         return 0;
+      }
+      return std::min(maxval, int(v * float(maxval) + 0.5f));
+   }
+   
+   PixelFormat mFormat;
+   bool mSwap;
+   int mMaxval;
+   const float *mIn;
+   unsigned char *mOut;
+};
+
+size_t SampleSize(PixelFormat format, int maxval)
+{
+   switch (format)
+   {
+   case RawHalf:
+   case RawUInt16:
+      return 2;
+   case PPM:
+      return (maxval < 256 ? 1 : 2);
+   default:
+      return 4;
+   }
+}
+
+// Streams pixels from src through pipeline to out (may be null) in chunks of chunkSize
+// pixels. Only one chunk (encoded and decoded) is in memory at any time.
+// Returns the number of pixels processed.
+size_t Stream(Source &src, FILE *out, PixelFormat format, bool swap, int maxval, size_t channels,
+              size_t npixels, size_t chunkSize, const gmath::ColorPipeline &pipeline)
+{
+   static const size_t Grain = 16384;
+   
+   size_t ssize = SampleSize(format, maxval);
+   std::vector<unsigned char> bytes(chunkSize * channels * ssize);
+   std::vector<float> pixels(chunkSize * channels);
+   size_t done = 0;
+   
+   while (npixels == 0 || done < npixels)
+   {
+      size_t count = chunkSize;
+      if (npixels > 0)
+      {
+         count = std::min(count, npixels - done);
+      }
+      
+      size_t nbytes = src.read(&bytes[0], count * channels * ssize);
+      count = nbytes / (channels * ssize);
+      if (nbytes % (channels * ssize) != 0)
+      {
+         std::cerr << "Warning: truncated input, dropping " << (nbytes % (channels * ssize))
+                   << " trailing byte(s) of an incomplete pixel" << std::endl;
+      }
+      if (count == 0)
+      {
+         break;
+      }
+      
+      size_t nsamples = count * channels;
+      
+      gmath::Parallel::For(nsamples, Grain, DecodeTask(format, swap, maxval, &bytes[0], &pixels[0]));
+      pipeline.apply(&pixels[0], &pixels[0], count, channels);
+      
+      if (out)
+      {
+         gmath::Parallel::For(nsamples, Grain, EncodeTask(format, swap, maxval, &pixels[0], &bytes[0]));
+         if (fwrite(&bytes[0], 1, nsamples * ssize, out) != nsamples * ssize)
+         {
+            std::cerr << "Failed to write output" << std::endl;
+            break;
+         }
+      }
+      
+      done += count;
+      
+      if (nbytes < count * channels * ssize || count < chunkSize)
+      {
+         break;
+      }
+   }
+   
+   return done;
+}
+
 int main(int argc, char **argv)
 {
    std::string srcCSName;
@@ -119,6 +549,15 @@ int main(int argc, char **argv)
    std::string arg;
    FlagOp op = NoOP;
    bool verbose = false;
+   std::string inputPath;
+   std::string outputPath;
+   PixelFormat format = UnknownFormat;
+   size_t channels = 3;
+   int linearize = -1;
+   int unlinearize = -1;
+   size_t threads = 0;
+   size_t chunkSize = 1024 * 1024;
+   double benchmark = 0.0;
 
    for (int i=1; i<argc; ++i)
    {
@@ -137,6 +576,42 @@ int main(int argc, char **argv)
          {
             op = SetCAT;
          }
+         else if (arg == "-i" || arg == "--input")
+         {
+            op = SetInput;
+         }
+         else if (arg == "-o" || arg == "--output")
+         {
+            op = SetOutput;
+         }
+         else if (arg == "-f" || arg == "--format")
+         {
+            op = SetFormat;
+         }
+         else if (arg == "-n" || arg == "--channels")
+         {
+            op = SetChannels;
+         }
+         else if (arg == "-lg" || arg == "--linearize")
+         {
+            op = SetLinearize;
+         }
+         else if (arg == "-ug" || arg == "--unlinearize")
+         {
+            op = SetUnlinearize;
+         }
+         else if (arg == "-t" || arg == "--threads")
+         {
+            op = SetThreads;
+         }
+         else if (arg == "-cs" || arg == "--chunk-size")
+         {
+            op = SetChunkSize;
+         }
+         else if (arg == "-b" || arg == "--benchmark")
+         {
+            op = SetBenchmark;
+         }
          else if (arg == "-v" || arg == "--verbose")
          {
             verbose = true;
@@ -145,6 +620,31 @@ int main(int argc, char **argv)
          {
             std::cout << "USAGE" << std::endl;
             std::cout << "  colormatrix -sc/--source-colorspace <str> -dc/--destination-colorspace <str> (-c/--cat <str>) (-v/--verbose) (-h/--help)" << std::endl;
+            std::cout << "              [(-i/--input <path>) (-o/--output <path>) (-f/--format <str>) (-n/--channels <int>)" << std::endl;
+            std::cout << "               (-lg/--linearize <str>) (-ug/--unlinearize <str>) (-t/--threads <int>)" << std::endl;
+            std::cout << "               (-cs/--chunk-size <int>) (-b/--benchmark <float>)]" << std::endl;
+            std::cout << std::endl;
+            std::cout << "Without input, prints the RGB to RGB matrix. With an input, streams its pixels through" << std::endl;
+            std::cout << "linearize, matrix and unlinearize, chunk by chunk (chunk size in pixels, 1M by default)," << std::endl;
+            std::cout << "writes them to the output (same format, '-' for stdin/stdout) if any and reports the" << std::endl;
+            std::cout << "throughput. --benchmark streams the given number of megapixels from memory instead." << std::endl;
+            std::cout << std::endl;
+            std::cout << "Available formats:" << std::endl;
+            std::cout << "  float  (raw, default)" << std::endl;
+            std::cout << "  half   (raw)" << std::endl;
+            std::cout << "  uint16 (raw, 0-65535 mapped to 0-1)" << std::endl;
+            std::cout << "  pfm    (default for .pfm files)" << std::endl;
+            std::cout << "  ppm    (binary 8 or 16 bits, default for .ppm files)" << std::endl;
+            std::cout << std::endl;
+            std::cout << "Available gamma functions:" << std::endl;
+            std::cout << "  Power22" << std::endl;
+            std::cout << "  Power24" << std::endl;
+            std::cout << "  sRGB" << std::endl;
+            std::cout << "  Rec709" << std::endl;
+            std::cout << "  Rec2020" << std::endl;
+            std::cout << "  LogC" << std::endl;
+            std::cout << "  LogCv2" << std::endl;
+            std::cout << "  Cineon" << std::endl;
             std::cout << std::endl;
             std::cout << "Available color spaces:" << std::endl;
             std::cout << "  CIE RGB" << std::endl;
@@ -189,6 +689,74 @@ int main(int argc, char **argv)
          cat = GetChromaticAdaptationTransform(arg);
          op = NoOP;
       }
+      else if (op == SetInput)
+      {
+         inputPath = arg;
+         op = NoOP;
+      }
+      else if (op == SetOutput)
+      {
+         outputPath = arg;
+         op = NoOP;
+      }
+      else if (op == SetFormat)
+      {
+         format = GetFormat(arg);
+         if (format == UnknownFormat)
+         {
+            std::cerr << "Unknown format '" << arg.c_str() << "'" << std::endl;
+            return 1;
+         }
+         op = NoOP;
+      }
+      else if (op == SetChannels)
+      {
+         int n = 0;
+         if (sscanf(arg.c_str(), "%d", &n) != 1 || n < 3)
+         {
+            std::cerr << "Invalid channel count '" << arg.c_str() << "' (3 or more expected)" << std::endl;
+            return 1;
+         }
+         channels = size_t(n);
+         op = NoOP;
+      }
+      else if (op == SetLinearize || op == SetUnlinearize)
+      {
+         int gf = GetGamma(arg);
+         if (gf == -1)
+         {
+            std::cerr << "Unknown gamma function '" << arg.c_str() << "'" << std::endl;
+            return 1;
+         }
+         (op == SetLinearize ? linearize : unlinearize) = gf;
+         op = NoOP;
+      }
+      else if (op == SetThreads)
+      {
+         int n = 0;
+         if (sscanf(arg.c_str(), "%d", &n) == 1 && n >= 0)
+         {
+            threads = size_t(n);
+         }
+         op = NoOP;
+      }
+      else if (op == SetChunkSize)
+      {
+         int n = 0;
+         if (sscanf(arg.c_str(), "%d", &n) == 1 && n > 0)
+         {
+            chunkSize = size_t(n);
+         }
+         op = NoOP;
+      }
+      else if (op == SetBenchmark)
+      {
+         if (sscanf(arg.c_str(), "%lf", &benchmark) != 1 || benchmark <= 0.0)
+         {
+            benchmark = 0.0;
+         }
+         op = NoOP;
+      }
       else
       {
          std::cerr << "Unknown operation. Ignore argument '" << arg.c_str() << "'" << std::endl;
@@ -209,20 +777,169 @@ int main(int argc, char **argv)
          std::cout << "XYZ -> " << dstCSName << ": " << dstCS->getXYZtoRGBMatrix() << std::endl;
       }
 
-      gmath::Matrix3 CAM;
+      gmath::Matrix3 M;
       if (cat != -1)
       {
-         gmath::XYZ srcW = gmath::ChromaticityYtoXYZ(srcCS->getWhitePoint(), 1.0f);
-         gmath::XYZ dstW = gmath::ChromaticityYtoXYZ(dstCS->getWhitePoint(), 1.0f);
-         CAM = gmath::ChromaticAdaptationMatrix(srcW, dstW, (gmath::ChromaticAdaptationTransform)cat);
          if (verbose)
          {
+            gmath::XYZ srcW = gmath::ChromaticityYtoXYZ(srcCS->getWhitePoint(), 1.0f);
+            gmath::XYZ dstW = gmath::ChromaticityYtoXYZ(dstCS->getWhitePoint(), 1.0f);
+            gmath::Matrix3 CAM = gmath::ChromaticAdaptationMatrix(srcW, dstW, (gmath::ChromaticAdaptationTransform)cat);
             std::cout << "CAT " << catName << ": " << CAM << std::endl;
          }
+         M = gmath::RGBtoRGBMatrix(*srcCS, *dstCS, (gmath::ChromaticAdaptationTransform)cat);
       }
-
-      std::cout << (dstCS->getXYZtoRGBMatrix() * CAM * srcCS->getRGBtoXYZMatrix()) << std::endl;
-
-      return 0;
+      else
+      {
+         M = gmath::RGBtoRGBMatrix(*srcCS, *dstCS);
+      }
+      
+      if (inputPath.empty() && benchmark <= 0.0)
+      {
+         std::cout << M << std::endl;
+         return 0;
+      }
+      
+      if (threads > 0)
+      {
+         gmath::Parallel::SetThreadCount(threads);
+      }
+      
+      gmath::ColorPipeline pipeline;
+      if (linearize != -1)
+      {
+         pipeline.linearize((gmath::Gamma::Function) linearize);
+      }
+      pipeline.transform(M);
+      if (unlinearize != -1)
+      {
+         pipeline.unlinearize((gmath::Gamma::Function) unlinearize);
+      }
+      
+      if (format == UnknownFormat)
+      {
+         std::string ext = (inputPath.size() > 4 ? inputPath.substr(inputPath.size() - 4) : "");
+         format = (ext == ".pfm" ? PFM : (ext == ".ppm" ? PPM : RawFloat));
+      }
+      
+      Files files;
+      std::vector<unsigned char> data;
+      Source src;
+      size_t npixels = 0;
+      size_t width = 0;
+      size_t height = 0;
+      int maxval = 255;
+      bool swap = false;
+      double pfmScale = (IsLittleEndian() ? -1.0 : 1.0);
+      
+      if (format == PFM || format == PPM)
+      {
+         channels = 3;
+      }
+      
+      if (benchmark > 0.0)
+      {
+         // random pixels in [0, 1], encoded in the stream format
+         npixels = size_t(benchmark * 1000000.0);
+         std::vector<float> pixels(npixels * channels);
+         for (size_t i=0; i<pixels.size(); ++i)
+         {
+            pixels[i] = float(rand()) / float(RAND_MAX);
+         }
+         data.resize(pixels.size() * SampleSize(format, maxval));
+         gmath::Parallel::For(pixels.size(), 16384, EncodeTask(format, false, maxval, &pixels[0], &data[0]));
+         src = Source(&data[0], data.size());
+      }
+      else
+      {
+         if (inputPath == "-")
+         {
+            files.in = stdin;
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+#endif
+         }
+         else
+         {
+            files.in = fopen(inputPath.c_str(), "rb");
+            if (!files.in)
+            {
+               std::cerr << "Could not open input '" << inputPath << "'" << std::endl;
+               return 1;
+            }
+         }
+         src = Source(files.in);
+         
+         if (format == PFM || format == PPM)
+         {
+            std::string magic, w, h, last;
+            unsigned long uw = 0;
+            unsigned long uh = 0;
+            bool ok = (src.token(magic) && src.token(w) && src.token(h) && src.token(last));
+            ok = ok && (sscanf(w.c_str(), "%lu", &uw) == 1);
+            ok = ok && (sscanf(h.c_str(), "%lu", &uh) == 1);
+            width = size_t(uw);
+            height = size_t(uh);
+            if (format == PFM)
+            {
+               // negative scale means little endian data
+               ok = ok && (magic == "PF") && (sscanf(last.c_str(), "%lf", &pfmScale) == 1);
+               swap = ((pfmScale < 0.0) != IsLittleEndian());
+            }
+            else
+            {
+               ok = ok && (magic == "P6") && (sscanf(last.c_str(), "%d", &maxval) == 1) && maxval > 0 && maxval < 65536;
+            }
+            if (!ok)
+            {
+               std::cerr << "Invalid or unsupported " << (format == PFM ? "PFM (RGB only)" : "PPM (binary only)") << " header" << std::endl;
+               return 1;
+            }
+            npixels = width * height;
+         }
+      }
+      
+      if (!outputPath.empty())
+      {
+         if (outputPath == "-")
+         {
+            files.out = stdout;
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+         }
+         else
+         {
+            files.out = fopen(outputPath.c_str(), "wb");
+            if (!files.out)
+            {
+               std::cerr << "Could not open output '" << outputPath << "'" << std::endl;
+               return 1;
+            }
+         }
+         if (format == PFM)
+         {
+            fprintf(files.out, "PF\n%lu %lu\n%f\n", (unsigned long) width, (unsigned long) height, pfmScale);
+         }
+         else if (format == PPM)
+         {
+            fprintf(files.out, "P6\n%lu %lu\n%d\n", (unsigned long) width, (unsigned long) height, maxval);
+         }
+      }
+      
+      double t0 = WallTime();
+      size_t count = Stream(src, files.out, format, swap, maxval, channels, npixels, chunkSize, pipeline);
+      double t1 = WallTime();
+      
+      double mps = (t1 > t0 ? 1e-6 * double(count) / (t1 - t0) : 0.0);
+      std::cerr << count << " pixels in " << (t1 - t0) << "s: " << mps << " MP/s ("
+                << gmath::Parallel::GetThreadCount() << " thread(s))" << std::endl;
+      
+      if (npixels > 0 && count < npixels)
+      {
+         std::cerr << "Warning: truncated input, " << (npixels - count) << " of " << npixels << " pixel(s) missing" << std::endl;
+      }
+      
+      return (npixels > 0 && count != npixels ? 1 : 0);
    }
 }
@@ -0,0 +1,249 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "batch.h"
+
+namespace gmath
+{
+
+namespace batch
+{
+
+Pixels Interleaved(const float *p, size_t stride)
+{
+   Pixels px;
+   px.ch[0] = (float*) p;
+   px.ch[1] = (float*) p + 1;
+   px.ch[2] = (float*) p + 2;
+   px.stride = stride;
+   return px;
+}
+
+Pixels Planar(const float *const p[3])
+{
+   Pixels px;
+   px.ch[0] = (float*) p[0];
+   px.ch[1] = (float*) p[1];
+   px.ch[2] = (float*) p[2];
+   px.stride = 1;
+   return px;
+}
+
+HalfPixels Interleaved(const Half *p, size_t stride)
+{
+   HalfPixels px;
+   px.ch[0] = (Half*) p;
+   px.ch[1] = (Half*) p + 1;
+   px.ch[2] = (Half*) p + 2;
+   px.stride = stride;
+   return px;
+}
+
+HalfPixels Planar(const Half *const p[3])
+{
+   HalfPixels px;
+   px.ch[0] = (Half*) p[0];
+   px.ch[1] = (Half*) p[1];
+   px.ch[2] = (Half*) p[2];
+   px.stride = 1;
+   return px;
+}
+
+void Load(const Pixels &px, size_t offset, size_t count, float *storage, float *soa[3])
+{
+   if (px.stride == 1)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         soa[c] = px.ch[c] + offset;
+      }
+      return;
+   }
+   
+   for (int c=0; c<3; ++c)
+   {
+      soa[c] = storage + c * BlockSize;
+   }
+   
+   const float *src = px.ch[0] + offset * px.stride;
+   ptrdiff_t d1 = px.ch[1] - px.ch[0];
+   ptrdiff_t d2 = px.ch[2] - px.ch[0];
+   
+   for (size_t i=0; i<count; ++i, src+=px.stride)
+   {
+      soa[0][i] = src[0];
+      soa[1][i] = src[d1];
+      soa[2][i] = src[d2];
+   }
+}
+
+void Target(const Pixels &px, size_t offset, float *storage, float *soa[3])
+{
+   for (int c=0; c<3; ++c)
+   {
+      soa[c] = (px.stride == 1 ? px.ch[c] + offset : storage + c * BlockSize);
+   }
+}
+
+void Store(float *const soa[3], const Pixels &px, size_t offset, size_t count)
+{
+   if (px.stride == 1)
+   {
+      return;
+   }
+   
+   float *dst = px.ch[0] + offset * px.stride;
+   ptrdiff_t d1 = px.ch[1] - px.ch[0];
+   ptrdiff_t d2 = px.ch[2] - px.ch[0];
+   
+   for (size_t i=0; i<count; ++i, dst+=px.stride)
+   {
+      dst[0] = soa[0][i];
+      dst[d1] = soa[1][i];
+      dst[d2] = soa[2][i];
+   }
+}
+
+void Load(const HalfPixels &px, size_t offset, size_t count, float *storage, float *soa[3])
+{
+   for (int c=0; c<3; ++c)
+   {
+      soa[c] = storage + c * BlockSize;
+   }
+   
+   if (px.stride == 1)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         HalfToFloat(px.ch[c] + offset, soa[c], count);
+      }
+      return;
+   }
+   
+   // gather the channels first so that conversions run on contiguous arrays
+   Half tmp[3][BlockSize];
+   
+   const Half *src = px.ch[0] + offset * px.stride;
+   ptrdiff_t d1 = px.ch[1] - px.ch[0];
+   ptrdiff_t d2 = px.ch[2] - px.ch[0];
+   
+   for (size_t i=0; i<count; ++i, src+=px.stride)
+   {
+      tmp[0][i] = src[0];
+      tmp[1][i] = src[d1];
+      tmp[2][i] = src[d2];
+   }
+   
+   for (int c=0; c<3; ++c)
+   {
+      HalfToFloat(tmp[c], soa[c], count);
+   }
+}
+
+void Target(const HalfPixels &, size_t, float *storage, float *soa[3])
+{
+   for (int c=0; c<3; ++c)
+   {
+      soa[c] = storage + c * BlockSize;
+   }
+}
+
+void Store(float *const soa[3], const HalfPixels &px, size_t offset, size_t count)
+{
+   if (px.stride == 1)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         FloatToHalf(soa[c], px.ch[c] + offset, count);
+      }
+      return;
+   }
+   
+   Half tmp[3][BlockSize];
+   
+   for (int c=0; c<3; ++c)
+   {
+      FloatToHalf(soa[c], tmp[c], count);
+   }
+   
+   Half *dst = px.ch[0] + offset * px.stride;
+   ptrdiff_t d1 = px.ch[1] - px.ch[0];
+   ptrdiff_t d2 = px.ch[2] - px.ch[0];
+   
+   for (size_t i=0; i<count; ++i, dst+=px.stride)
+   {
+      dst[0] = tmp[0][i];
+      dst[d1] = tmp[1][i];
+      dst[d2] = tmp[2][i];
+   }
+}
+
+void Transform(const Matrix3 &m, const float *const in[3], float *const out[3], size_t count)
+{
+   Transform(m, Vector3(0.0f), in, out, count);
+}
+
+void Transform(const Matrix3 &m, const Vector3 &t, const float *const in[3], float *const out[3], size_t count)
+{
+   size_t i = 0;
+   
+#ifdef GMATH_SSE2
+   __m128 m00 = _mm_set1_ps(m(0, 0)), m01 = _mm_set1_ps(m(0, 1)), m02 = _mm_set1_ps(m(0, 2));
+   __m128 m10 = _mm_set1_ps(m(1, 0)), m11 = _mm_set1_ps(m(1, 1)), m12 = _mm_set1_ps(m(1, 2));
+   __m128 m20 = _mm_set1_ps(m(2, 0)), m21 = _mm_set1_ps(m(2, 1)), m22 = _mm_set1_ps(m(2, 2));
+   __m128 t0 = _mm_set1_ps(t.x), t1 = _mm_set1_ps(t.y), t2 = _mm_set1_ps(t.z);
+   
+   for (; i+4<=count; i+=4)
+   {
+      __m128 x = _mm_loadu_ps(in[0] + i);
+      __m128 y = _mm_loadu_ps(in[1] + i);
+      __m128 z = _mm_loadu_ps(in[2] + i);
+      
+      __m128 o0 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_mul_ps(m02, z)), t0);
+      __m128 o1 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_mul_ps(m12, z)), t1);
+      __m128 o2 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_mul_ps(m22, z)), t2);
+      
+      _mm_storeu_ps(out[0] + i, o0);
+      _mm_storeu_ps(out[1] + i, o1);
+      _mm_storeu_ps(out[2] + i, o2);
+   }
+#endif
+   
+   for (; i<count; ++i)
+   {
+      float x = in[0][i];
+      float y = in[1][i];
+      float z = in[2][i];
+      
+      out[0][i] = m(0, 0) * x + m(0, 1) * y + m(0, 2) * z + t.x;
+      out[1][i] = m(1, 0) * x + m(1, 1) * y + m(1, 2) * z + t.y;
+      out[2][i] = m(2, 0) * x + m(2, 1) * y + m(2, 2) * z + t.z;
+   }
+}
+
+}
+
+}
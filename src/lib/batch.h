@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gmath_src_batch_h_
+#define __gmath_src_batch_h_
+
+// Internal helpers shared by the batch (span based) color code paths
+
+#include <gmath/config.h>
+#include <gmath/matrix.h>
+#include <gmath/color.h>
+#include <gmath/half.h>
+#include <gmath/parallel.h>
+
+#if !defined(GMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define GMATH_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace gmath
+{
+   namespace batch
+   {
+      // Pixels processed at once by the block kernels
+      static const size_t BlockSize = 256;
+      // Pixels per parallel chunk
+      static const size_t ChunkSize = 8192;
+      
+      // Channel c of pixel i is at ch[c][i * stride]
+      struct Pixels
+      {
+         float *ch[3];
+         size_t stride;
+      };
+      
+      // Same for binary16 pixels, converted to and from float blocks
+      struct HalfPixels
+      {
+         Half *ch[3];
+         size_t stride;
+      };
+      
+      Pixels Interleaved(const float *p, size_t stride);
+      Pixels Planar(const float *const p[3]);
+      HalfPixels Interleaved(const Half *p, size_t stride);
+      HalfPixels Planar(const Half *const p[3]);
+      
+      // Returns in soa the channels of pixels [offset, offset + count), either pointing
+      // directly into px planes or gathered into storage (3 * BlockSize floats)
+      void Load(const Pixels &px, size_t offset, size_t count, float *storage, float *soa[3]);
+      // Returns in soa where a kernel should write pixels [offset, offset + count)
+      void Target(const Pixels &px, size_t offset, float *storage, float *soa[3]);
+      // Scatters soa back to px if Target did not point into px planes
+      void Store(float *const soa[3], const Pixels &px, size_t offset, size_t count);
+      // Half versions always go through storage
+      void Load(const HalfPixels &px, size_t offset, size_t count, float *storage, float *soa[3]);
+      void Target(const HalfPixels &px, size_t offset, float *storage, float *soa[3]);
+      void Store(float *const soa[3], const HalfPixels &px, size_t offset, size_t count);
+      
+      // out = m * in (planar, in and out may alias)
+      void Transform(const Matrix3 &m, const float *const in[3], float *const out[3], size_t count);
+      // out = m * in + t
+      void Transform(const Matrix3 &m, const Vector3 &t, const float *const in[3], float *const out[3], size_t count);
+      
+      // Cube root of normal positive floats, relative error below 3e-7
+      //   Bit trick initial guess (within 4%) refined by two Halley iterations
+      inline float Cbrt(float t)
+      {
+         int bits;
+         memcpy(&bits, &t, sizeof(float));
+         bits = bits / 3 + 709921077;
+         float x;
+         memcpy(&x, &bits, sizeof(float));
+         for (int i=0; i<2; ++i)
+         {
+            float x3 = x * x * x;
+            x = x * (x3 + 2.0f * t) / (2.0f * x3 + t);
+         }
+         return x;
+      }
+      
+#ifdef GMATH_SSE2
+      inline __m128 Cbrt(__m128 t)
+      {
+         // integer division by 3 through float conversion is accurate enough for a guess
+         __m128i bits = _mm_castps_si128(t);
+         bits = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(bits), _mm_set1_ps(1.0f / 3.0f)));
+         __m128 x = _mm_castsi128_ps(_mm_add_epi32(bits, _mm_set1_epi32(709921077)));
+         __m128 t2 = _mm_add_ps(t, t);
+         for (int i=0; i<2; ++i)
+         {
+            __m128 x3 = _mm_mul_ps(_mm_mul_ps(x, x), x);
+            x = _mm_div_ps(_mm_mul_ps(x, _mm_add_ps(x3, t2)), _mm_add_ps(_mm_add_ps(x3, x3), t));
+         }
+         return x;
+      }
+      
+      // mask ? a : b
+      inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+      {
+         return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+      }
+      
+      // log2 of normal positive floats, absolute error below 2e-7 in [1/2, 2] (the result
+      //   rounding dominates away from it)
+      //   x = m * 2^e with m in [sqrt(1/2), sqrt(2)), ln(m) = 2 * atanh((m - 1) / (m + 1))
+      //   (odd series up to degree 9)
+      inline __m128 Log2(__m128 x)
+      {
+         __m128i bits = _mm_castps_si128(x);
+         __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+         __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+         __m128 big = _mm_cmpge_ps(m, _mm_set1_ps(1.41421356f));
+         m = Select(big, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+         __m128 E = _mm_add_ps(_mm_cvtepi32_ps(e), _mm_and_ps(big, _mm_set1_ps(1.0f)));
+         
+         __m128 s = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+         __m128 s2 = _mm_mul_ps(s, s);
+         __m128 p = _mm_set1_ps(1.0f / 9.0f);
+         p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f / 7.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f / 5.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f / 3.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, s2), _mm_set1_ps(1.0f));
+         // 2 / ln(2)
+         return _mm_add_ps(E, _mm_mul_ps(_mm_mul_ps(s, p), _mm_set1_ps(2.88539008f)));
+      }
+      
+      // 2^y, relative error below 3e-7, y clamped to [-126, 127]
+      //   y = n + f with f in [-1/2, 1/2], 2^f from its Taylor series up to degree 7
+      inline __m128 Exp2(__m128 y)
+      {
+         y = _mm_min_ps(_mm_set1_ps(127.0f), _mm_max_ps(_mm_set1_ps(-126.0f), y));
+         __m128i n = _mm_cvtps_epi32(y);
+         __m128 f = _mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(n)), _mm_set1_ps(0.693147181f));
+         __m128 p = _mm_set1_ps(1.0f / 5040.0f);
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 720.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 120.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 24.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f / 6.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(0.5f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+         p = _mm_add_ps(_mm_mul_ps(p, f), _mm_set1_ps(1.0f));
+         __m128i scale = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+         return _mm_mul_ps(p, _mm_castsi128_ps(scale));
+      }
+      
+      // x^p for normal positive x, relative error within 3e-7 * (1 + |p * log2(x)|)
+      inline __m128 Pow(__m128 x, __m128 p)
+      {
+         return Exp2(_mm_mul_ps(p, Log2(x)));
+      }
+#endif
+      
+      // Single threaded versions of the Gamma batch functions
+      void Linearize(Gamma::Function gf, const float *in, float *out, size_t n);
+      void Unlinearize(Gamma::Function gf, const float *in, float *out, size_t n);
+      
+      // Kernel must provide:
+      //   void operator()(const float *const in[3], float *const out[3], size_t count) const
+      // with in and out possibly aliasing
+      // InPixels and OutPixels are Pixels or HalfPixels
+      template <class Kernel, class InPixels, class OutPixels>
+      class Runner
+      {
+      public:
+         Runner(const Kernel &kernel, const InPixels &in, const OutPixels &out)
+            : mKernel(kernel), mIn(in), mOut(out)
+         {
+         }
+         
+         void operator()(size_t begin, size_t end) const
+         {
+            float istorage[3 * BlockSize];
+            float ostorage[3 * BlockSize];
+            float *isoa[3];
+            float *osoa[3];
+            
+            for (size_t i=begin; i<end; i+=BlockSize)
+            {
+               size_t count = std::min(BlockSize, end - i);
+               Load(mIn, i, count, istorage, isoa);
+               Target(mOut, i, ostorage, osoa);
+               mKernel(isoa, osoa, count);
+               Store(osoa, mOut, i, count);
+            }
+         }
+         
+      private:
+         const Kernel &mKernel;
+         InPixels mIn;
+         OutPixels mOut;
+      };
+      
+      // Runs kernel over n pixels, block by block, split in parallel chunks
+      template <class Kernel, class InPixels, class OutPixels>
+      inline void Run(const Kernel &kernel, const InPixels &in, const OutPixels &out, size_t n)
+      {
+         Parallel::For(n, ChunkSize, Runner<Kernel, InPixels, OutPixels>(kernel, in, out));
+      }
+      
+      class TransformKernel
+      {
+      public:
+         TransformKernel(const Matrix3 &m)
+            : mM(m)
+         {
+         }
+         
+         void operator()(const float *const in[3], float *const out[3], size_t count) const
+         {
+            Transform(mM, in, out, count);
+         }
+         
+      private:
+         Matrix3 mM;
+      };
+   }
+}
+
+#endif
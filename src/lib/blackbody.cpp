@@ -0,0 +1,239 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/parallel.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+BlackbodyTable::BlackbodyTable()
+   : mMinTemp(0.0f)
+   , mMaxTemp(0.0f)
+   , mMired0(0.0f)
+   , mScale(0.0f)
+   , mSize(0)
+{
+}
+
+BlackbodyTable::~BlackbodyTable()
+{
+}
+
+void BlackbodyTable::clear()
+{
+   mMinTemp = 0.0f;
+   mMaxTemp = 0.0f;
+   mMired0 = 0.0f;
+   mScale = 0.0f;
+   mSize = 0;
+   mTable.clear();
+}
+
+bool BlackbodyTable::build(const ColorSpace &cs, bool normalize, float minTemp, float maxTemp, size_t size)
+{
+   if (size < 2 || !(minTemp > 0.0f) || !(maxTemp > minTemp))
+   {
+      return false;
+   }
+   
+   mMinTemp = minTemp;
+   mMaxTemp = maxTemp;
+   mMired0 = 1e6f / maxTemp;
+   mScale = float(size - 1) / (1e6f / minTemp - mMired0);
+   mSize = size;
+   mTable.resize(4 * (size + 1));
+   
+   for (size_t i=0; i<size; ++i)
+   {
+      float temp = (i == 0 ? maxTemp : (i + 1 == size ? minTemp : 1e6f / (mMired0 + float(i) / mScale)));
+      RGB c = Blackbody::GetRGB(temp, cs, normalize);
+      mTable[4 * i] = c.r;
+      mTable[4 * i + 1] = c.g;
+      mTable[4 * i + 2] = c.b;
+      mTable[4 * i + 3] = 0.0f;
+   }
+   for (int c=0; c<4; ++c)
+   {
+      mTable[4 * size + c] = mTable[4 * (size - 1) + c];
+   }
+   
+   return true;
+}
+
+size_t BlackbodyTable::size() const
+{
+   return mSize;
+}
+
+float BlackbodyTable::getMinTemperature() const
+{
+   return mMinTemp;
+}
+
+float BlackbodyTable::getMaxTemperature() const
+{
+   return mMaxTemp;
+}
+
+RGB BlackbodyTable::operator()(float temp) const
+{
+   if (mSize == 0)
+   {
+      return RGB(0.0f, 0.0f, 0.0f);
+   }
+   
+   // NaN goes to minTemp
+   temp = (temp > mMinTemp ? std::min(temp, mMaxTemp) : mMinTemp);
+   float f = (1e6f / temp - mMired0) * mScale;
+   size_t i = std::min(mSize - 1, size_t(f));
+   float t = f - float(i);
+   
+   const float *e = &mTable[4 * i];
+   return RGB(e[0] + t * (e[4] - e[0]),
+              e[1] + t * (e[5] - e[1]),
+              e[2] + t * (e[6] - e[2]));
+}
+
+// ---
+
+class BlackbodyTask
+{
+public:
+   BlackbodyTask(const float *table, size_t size, float minTemp, float maxTemp, float mired0, float scale,
+                 const float *temps, const batch::Pixels &out)
+      : mTable(table), mSize(size), mMinTemp(minTemp), mMaxTemp(maxTemp), mMired0(mired0), mScale(scale)
+      , mTemps(temps), mOut(out)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      
+      for (size_t offset=begin; offset<end; offset+=batch::BlockSize)
+      {
+         size_t count = std::min(batch::BlockSize, end - offset);
+         batch::Target(mOut, offset, storage, soa);
+         eval(mTemps + offset, soa, count);
+         batch::Store(soa, mOut, offset, count);
+      }
+   }
+   
+private:
+   
+   void eval(const float *temps, float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+      
+#ifdef GMATH_SSE2
+      __m128 tmin = _mm_set1_ps(mMinTemp);
+      __m128 tmax = _mm_set1_ps(mMaxTemp);
+      __m128 m0 = _mm_set1_ps(mMired0);
+      __m128 scl = _mm_set1_ps(mScale);
+      __m128i last = _mm_set1_epi32(int(mSize - 1));
+      
+      for (; i+4<=count; i+=4)
+      {
+         // max returns its second operand for NaN
+         __m128 T = _mm_min_ps(tmax, _mm_max_ps(_mm_loadu_ps(temps + i), tmin));
+         __m128 f = _mm_mul_ps(_mm_sub_ps(_mm_div_ps(_mm_set1_ps(1e6f), T), m0), scl);
+         __m128i fi = _mm_cvttps_epi32(f);
+         // min(fi, size - 1), SSE2 has no 32 bit integer min
+         __m128i over = _mm_cmpgt_epi32(fi, last);
+         fi = _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, fi));
+         __m128 t = _mm_sub_ps(f, _mm_cvtepi32_ps(fi));
+         
+         int idx[4];
+         float w[4];
+         _mm_storeu_si128((__m128i*) idx, fi);
+         _mm_storeu_ps(w, t);
+         
+         __m128 c[4];
+         for (int j=0; j<4; ++j)
+         {
+            const float *e = mTable + 4 * idx[j];
+            __m128 e0 = _mm_loadu_ps(e);
+            __m128 e1 = _mm_loadu_ps(e + 4);
+            c[j] = _mm_add_ps(e0, _mm_mul_ps(_mm_set1_ps(w[j]), _mm_sub_ps(e1, e0)));
+         }
+         _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+         
+         _mm_storeu_ps(out[0] + i, c[0]);
+         _mm_storeu_ps(out[1] + i, c[1]);
+         _mm_storeu_ps(out[2] + i, c[2]);
+      }
+#endif
+      
+      for (; i<count; ++i)
+      {
+         float temp = (temps[i] > mMinTemp ? std::min(temps[i], mMaxTemp) : mMinTemp);
+         float f = (1e6f / temp - mMired0) * mScale;
+         size_t k = std::min(mSize - 1, size_t(f));
+         float t = f - float(k);
+         const float *e = mTable + 4 * k;
+         out[0][i] = e[0] + t * (e[4] - e[0]);
+         out[1][i] = e[1] + t * (e[5] - e[1]);
+         out[2][i] = e[2] + t * (e[6] - e[2]);
+      }
+   }
+   
+private:
+   const float *mTable;
+   size_t mSize;
+   float mMinTemp;
+   float mMaxTemp;
+   float mMired0;
+   float mScale;
+   const float *mTemps;
+   batch::Pixels mOut;
+};
+
+bool BlackbodyTable::apply(const float *temps, float *rgb, size_t n, size_t stride) const
+{
+   if (mSize == 0 || !temps || !rgb || stride < 3)
+   {
+      return false;
+   }
+   Parallel::For(n, batch::ChunkSize, BlackbodyTask(&mTable[0], mSize, mMinTemp, mMaxTemp, mMired0, mScale,
+                                                    temps, batch::Interleaved(rgb, stride)));
+   return true;
+}
+
+bool BlackbodyTable::apply(const float *temps, float *const rgb[3], size_t n) const
+{
+   if (mSize == 0 || !temps || !rgb || !rgb[0] || !rgb[1] || !rgb[2])
+   {
+      return false;
+   }
+   Parallel::For(n, batch::ChunkSize, BlackbodyTask(&mTable[0], mSize, mMinTemp, mMaxTemp, mMired0, mScale,
+                                                    temps, batch::Planar(rgb)));
+   return true;
+}
+
+}
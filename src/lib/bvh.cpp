@@ -0,0 +1,842 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/bvh.h>
+#include <gmath/parallel.h>
+#include <algorithm>
+#include <limits>
+
+namespace gmath {
+  
+  typedef BVH::Bounds Bounds;
+  typedef BVH::Node Node;
+  
+  static const int BinCount = 16;
+  // ranges above are binned in parallel chunks
+  static const size_t ParallelBinningSize = 65536;
+  static const size_t BinningGrainSize = 16384;
+  // ranges below are built as independent subtrees in parallel
+  static const size_t SubtreeSize = 4096;
+  // beyond this depth ranges are split at the median so the tree depth stays bounded
+  static const int BalancedDepth = 32;
+  static const size_t StackSize = 128;
+  // cost of a node traversal relative to a box test
+  static const float TraversalCost = 1.0f;
+  // marks top level nodes standing for a subtree built separately
+  static const unsigned short DeferredAxis = 0xFFFF;
+  
+  const size_t BVH::InvalidIndex;
+  
+  static inline void Reset(Bounds &b) {
+    for (int k=0; k<3; ++k) {
+      b.bmin[k] = std::numeric_limits<float>::max();
+      b.bmax[k] = -std::numeric_limits<float>::max();
+    }
+  }
+  
+  static inline void Grow(Bounds &b, const Bounds &o) {
+    for (int k=0; k<3; ++k) {
+      b.bmin[k] = std::min(b.bmin[k], o.bmin[k]);
+      b.bmax[k] = std::max(b.bmax[k], o.bmax[k]);
+    }
+  }
+  
+  static inline void Grow(Bounds &b, const float *p) {
+    for (int k=0; k<3; ++k) {
+      b.bmin[k] = std::min(b.bmin[k], p[k]);
+      b.bmax[k] = std::max(b.bmax[k], p[k]);
+    }
+  }
+  
+  static inline float HalfArea(const Bounds &b) {
+    float dx = b.bmax[0] - b.bmin[0];
+    float dy = b.bmax[1] - b.bmin[1];
+    float dz = b.bmax[2] - b.bmin[2];
+    return (dx < 0 ? 0.0f : dx * dy + dy * dz + dz * dx);
+  }
+  
+  static inline void SetBounds(Node &node, const Bounds &b) {
+    for (int k=0; k<3; ++k) {
+      node.bmin[k] = b.bmin[k];
+      node.bmax[k] = b.bmax[k];
+    }
+  }
+  
+  static inline void GetBounds(const Node &node, Bounds &b) {
+    for (int k=0; k<3; ++k) {
+      b.bmin[k] = node.bmin[k];
+      b.bmax[k] = node.bmax[k];
+    }
+  }
+  
+  static inline bool IsLeaf(const Node &node) {
+    return (node.count > 0);
+  }
+  
+  // ---
+  
+  struct BuildContext {
+    const Bounds *boxes;
+    const float *centroids;
+    unsigned int *indices;
+    size_t maxLeafSize;
+  };
+  
+  // Indices [begin, end) with their bounds and centroid bounds
+  struct BuildRange {
+    size_t begin;
+    size_t end;
+    int depth;
+    Bounds bounds;
+    Bounds centroids;
+  };
+  
+  struct Bin {
+    Bounds bounds;
+    Bounds centroids;
+    size_t count;
+  };
+  
+  struct BinSet {
+    Bin bins[3][BinCount];
+    // bin index = (c - origin) * scale, scale is 0 on flat axes
+    float origin[3];
+    float scale[3];
+    
+    void setup(const Bounds &centroids) {
+      for (int k=0; k<3; ++k) {
+        float extent = centroids.bmax[k] - centroids.bmin[k];
+        origin[k] = centroids.bmin[k];
+        scale[k] = (extent > 0 ? float(BinCount) * (1.0f - 1e-6f) / extent : 0.0f);
+        for (int j=0; j<BinCount; ++j) {
+          Reset(bins[k][j].bounds);
+          Reset(bins[k][j].centroids);
+          bins[k][j].count = 0;
+        }
+      }
+    }
+    
+    inline int index(int k, float c) const {
+      int j = int((c - origin[k]) * scale[k]);
+      return (j < 0 ? 0 : (j >= BinCount ? BinCount - 1 : j));
+    }
+    
+    void add(const BuildContext &ctx, size_t begin, size_t end) {
+      for (size_t i=begin; i<end; ++i) {
+        unsigned int idx = ctx.indices[i];
+        const float *c = ctx.centroids + 3 * idx;
+        for (int k=0; k<3; ++k) {
+          if (scale[k] > 0) {
+            Bin &bin = bins[k][index(k, c[k])];
+            Grow(bin.bounds, ctx.boxes[idx]);
+            Grow(bin.centroids, c);
+            bin.count += 1;
+          }
+        }
+      }
+    }
+    
+    void merge(const BinSet &rhs) {
+      for (int k=0; k<3; ++k) {
+        for (int j=0; j<BinCount; ++j) {
+          Grow(bins[k][j].bounds, rhs.bins[k][j].bounds);
+          Grow(bins[k][j].centroids, rhs.bins[k][j].centroids);
+          bins[k][j].count += rhs.bins[k][j].count;
+        }
+      }
+    }
+  };
+  
+  class BinTask {
+    public:
+      BinTask(const BuildContext &ctx, const BuildRange &range, BinSet *partials)
+        : mCtx(ctx), mRange(range), mPartials(partials) {
+      }
+      
+      void operator()(size_t begin, size_t end) const {
+        BinSet &bs = mPartials[begin / BinningGrainSize];
+        bs.setup(mRange.centroids);
+        bs.add(mCtx, mRange.begin + begin, mRange.begin + end);
+      }
+      
+    private:
+      const BuildContext &mCtx;
+      const BuildRange &mRange;
+      BinSet *mPartials;
+  };
+  
+  struct Split {
+    int axis;
+    int bin;
+    float cost;
+  };
+  
+  // Lowest SAH cost split between bins, cost in box tests. Returns false if all
+  // centroids are the same.
+  static bool FindSplit(const BinSet &bs, const BuildRange &range, Split &split) {
+    size_t total = range.end - range.begin;
+    float best = std::numeric_limits<float>::max();
+    
+    split.axis = -1;
+    
+    for (int k=0; k<3; ++k) {
+      if (bs.scale[k] <= 0) {
+        continue;
+      }
+      
+      // rightCost[j]: right side made of bins (j, BinCount)
+      float rightCost[BinCount];
+      Bounds acc;
+      size_t count = 0;
+      Reset(acc);
+      for (int j=BinCount-1; j>0; --j) {
+        Grow(acc, bs.bins[k][j].bounds);
+        count += bs.bins[k][j].count;
+        rightCost[j-1] = HalfArea(acc) * float(count);
+      }
+      
+      Reset(acc);
+      count = 0;
+      for (int j=0; j<BinCount-1; ++j) {
+        Grow(acc, bs.bins[k][j].bounds);
+        count += bs.bins[k][j].count;
+        if (count == 0 || count == total) {
+          continue;
+        }
+        float cost = HalfArea(acc) * float(count) + rightCost[j];
+        if (cost < best) {
+          best = cost;
+          split.axis = k;
+          split.bin = j;
+        }
+      }
+    }
+    
+    if (split.axis < 0) {
+      return false;
+    }
+    
+    float area = HalfArea(range.bounds);
+    split.cost = TraversalCost + (area > 0 ? best / area : float(total));
+    
+    return true;
+  }
+  
+  class SplitPredicate {
+    public:
+      SplitPredicate(const BinSet &bs, const float *centroids, const Split &split)
+        : mBins(bs), mCentroids(centroids), mSplit(split) {
+      }
+      
+      inline bool operator()(unsigned int idx) const {
+        return mBins.index(mSplit.axis, mCentroids[3 * idx + mSplit.axis]) <= mSplit.bin;
+      }
+      
+    private:
+      const BinSet &mBins;
+      const float *mCentroids;
+      const Split &mSplit;
+  };
+  
+  class CentroidLess {
+    public:
+      CentroidLess(const float *centroids, int axis)
+        : mCentroids(centroids), mAxis(axis) {
+      }
+      
+      inline bool operator()(unsigned int i0, unsigned int i1) const {
+        return mCentroids[3 * i0 + mAxis] < mCentroids[3 * i1 + mAxis];
+      }
+      
+    private:
+      const float *mCentroids;
+      int mAxis;
+  };
+  
+  static void ComputeBounds(const BuildContext &ctx, BuildRange &range) {
+    Reset(range.bounds);
+    Reset(range.centroids);
+    for (size_t i=range.begin; i<range.end; ++i) {
+      unsigned int idx = ctx.indices[i];
+      Grow(range.bounds, ctx.boxes[idx]);
+      Grow(range.centroids, ctx.centroids + 3 * idx);
+    }
+  }
+  
+  static void BuildNode(const BuildContext &ctx, const BuildRange &range, std::vector<Node> &nodes, std::vector<BuildRange> *deferred) {
+    size_t index = nodes.size();
+    size_t count = range.end - range.begin;
+    
+    nodes.push_back(Node());
+    SetBounds(nodes[index], range.bounds);
+    nodes[index].count = 0;
+    nodes[index].axis = 0;
+    
+    if (deferred && count <= SubtreeSize) {
+      nodes[index].axis = DeferredAxis;
+      nodes[index].offset = (unsigned int) deferred->size();
+      deferred->push_back(range);
+      return;
+    }
+    
+    BinSet bs;
+    Split split;
+    bool found = false;
+    
+    if (range.depth < BalancedDepth) {
+      bs.setup(range.centroids);
+      
+      if (deferred && count >= ParallelBinningSize) {
+        std::vector<BinSet> partials(Parallel::ChunkCount(count, BinningGrainSize));
+        Parallel::For(count, BinningGrainSize, BinTask(ctx, range, &partials[0]));
+        // merge in chunk order so results don't depend on the thread count
+        for (size_t i=0; i<partials.size(); ++i) {
+          bs.merge(partials[i]);
+        }
+      } else {
+        bs.add(ctx, range.begin, range.end);
+      }
+      
+      found = FindSplit(bs, range, split);
+    }
+    
+    if (count <= ctx.maxLeafSize && (!found || split.cost >= float(count))) {
+      nodes[index].offset = (unsigned int) range.begin;
+      nodes[index].count = (unsigned short) count;
+      return;
+    }
+    
+    BuildRange left = range;
+    BuildRange right = range;
+    left.depth = right.depth = range.depth + 1;
+    
+    unsigned int *first = ctx.indices + range.begin;
+    unsigned int *last = ctx.indices + range.end;
+    
+    if (found) {
+      unsigned int *mid = std::partition(first, last, SplitPredicate(bs, ctx.centroids, split));
+      left.end = right.begin = range.begin + (mid - first);
+      
+      Reset(left.bounds);
+      Reset(left.centroids);
+      Reset(right.bounds);
+      Reset(right.centroids);
+      for (int j=0; j<BinCount; ++j) {
+        const Bin &bin = bs.bins[split.axis][j];
+        if (bin.count > 0) {
+          Grow((j <= split.bin ? left.bounds : right.bounds), bin.bounds);
+          Grow((j <= split.bin ? left.centroids : right.centroids), bin.centroids);
+        }
+      }
+      nodes[index].axis = (unsigned short) split.axis;
+    } else {
+      // median along the widest centroid axis (any half if centroids are all the same)
+      int axis = 0;
+      for (int k=1; k<3; ++k) {
+        if (range.centroids.bmax[k] - range.centroids.bmin[k] > range.centroids.bmax[axis] - range.centroids.bmin[axis]) {
+          axis = k;
+        }
+      }
+      size_t half = count / 2;
+      std::nth_element(first, first + half, last, CentroidLess(ctx.centroids, axis));
+      left.end = right.begin = range.begin + half;
+      ComputeBounds(ctx, left);
+      ComputeBounds(ctx, right);
+      nodes[index].axis = (unsigned short) axis;
+    }
+    
+    BuildNode(ctx, left, nodes, deferred);
+    nodes[index].offset = (unsigned int) nodes.size();
+    BuildNode(ctx, right, nodes, deferred);
+  }
+  
+  class SubtreeTask {
+    public:
+      SubtreeTask(const BuildContext &ctx, const std::vector<BuildRange> &ranges, std::vector<Node> *subtrees)
+        : mCtx(ctx), mRanges(ranges), mSubtrees(subtrees) {
+      }
+      
+      void operator()(size_t begin, size_t end) const {
+        for (size_t i=begin; i<end; ++i) {
+          BuildNode(mCtx, mRanges[i], mSubtrees[i], 0);
+        }
+      }
+      
+    private:
+      const BuildContext &mCtx;
+      const std::vector<BuildRange> &mRanges;
+      std::vector<Node> *mSubtrees;
+  };
+  
+  class PrepareTask {
+    public:
+      PrepareTask(const AABox *boxes, Bounds *bounds, float *centroids)
+        : mBoxes(boxes), mBounds(bounds), mCentroids(centroids) {
+      }
+      
+      void operator()(size_t begin, size_t end) const {
+        for (size_t i=begin; i<end; ++i) {
+          const Vector3 &bmin = mBoxes[i].getMin();
+          const Vector3 &bmax = mBoxes[i].getMax();
+          Bounds &b = mBounds[i];
+          for (int k=0; k<3; ++k) {
+            b.bmin[k] = bmin[k];
+            b.bmax[k] = bmax[k];
+            if (mCentroids) {
+              mCentroids[3 * i + k] = 0.5f * (bmin[k] + bmax[k]);
+            }
+          }
+        }
+      }
+      
+    private:
+      const AABox *mBoxes;
+      Bounds *mBounds;
+      float *mCentroids;
+  };
+  
+  // ---
+  
+  BVH::BVH() {
+  }
+  
+  BVH::~BVH() {
+  }
+  
+  void BVH::clear() {
+    mNodes.clear();
+    mIndices.clear();
+    mBoxes.clear();
+  }
+  
+  bool BVH::build(const AABox *boxes, size_t n, size_t maxLeafSize) {
+    clear();
+    
+    if (!boxes || n == 0 || n > size_t(0xFFFFFFFF) || maxLeafSize < 1 || maxLeafSize > 255) {
+      return false;
+    }
+    
+    std::vector<float> centroids(3 * n);
+    mBoxes.resize(n);
+    mIndices.resize(n);
+    for (size_t i=0; i<n; ++i) {
+      mIndices[i] = (unsigned int) i;
+    }
+    
+    Parallel::For(n, BinningGrainSize, PrepareTask(boxes, &mBoxes[0], &centroids[0]));
+    
+    BuildContext ctx = {&mBoxes[0], &centroids[0], &mIndices[0], maxLeafSize};
+    
+    BuildRange root;
+    root.begin = 0;
+    root.end = n;
+    root.depth = 0;
+    ComputeBounds(ctx, root);
+    
+    // Top levels, then subtrees in parallel
+    std::vector<Node> top;
+    std::vector<BuildRange> ranges;
+    BuildNode(ctx, root, top, &ranges);
+    
+    std::vector< std::vector<Node> > subtrees(ranges.size());
+    Parallel::For(ranges.size(), 1, SubtreeTask(ctx, ranges, &subtrees[0]));
+    
+    // Flatten: deferred nodes are replaced by their subtree
+    std::vector<size_t> start(top.size());
+    size_t count = 0;
+    for (size_t i=0; i<top.size(); ++i) {
+      start[i] = count;
+      count += (top[i].axis == DeferredAxis ? subtrees[top[i].offset].size() : 1);
+    }
+    
+    mNodes.resize(count);
+    for (size_t i=0; i<top.size(); ++i) {
+      if (top[i].axis == DeferredAxis) {
+        const std::vector<Node> &sub = subtrees[top[i].offset];
+        for (size_t j=0; j<sub.size(); ++j) {
+          Node &node = mNodes[start[i] + j];
+          node = sub[j];
+          if (!IsLeaf(node)) {
+            node.offset += (unsigned int) start[i];
+          }
+        }
+      } else {
+        mNodes[start[i]] = top[i];
+        if (!IsLeaf(top[i])) {
+          mNodes[start[i]].offset = (unsigned int) start[top[i].offset];
+        }
+      }
+    }
+    
+    return true;
+  }
+  
+  bool BVH::refit(const AABox *boxes, size_t n) {
+    if (!boxes || n != mBoxes.size() || mNodes.empty()) {
+      return false;
+    }
+    
+    Parallel::For(n, BinningGrainSize, PrepareTask(boxes, &mBoxes[0], 0));
+    
+    // children always come after their parent
+    for (size_t i=mNodes.size(); i>0; --i) {
+      Node &node = mNodes[i-1];
+      Bounds b;
+      Reset(b);
+      if (IsLeaf(node)) {
+        for (unsigned int j=0; j<node.count; ++j) {
+          Grow(b, mBoxes[mIndices[node.offset + j]]);
+        }
+      } else {
+        Bounds cb;
+        GetBounds(mNodes[i], cb);
+        Grow(b, cb);
+        GetBounds(mNodes[node.offset], cb);
+        Grow(b, cb);
+      }
+      SetBounds(node, b);
+    }
+    
+    return true;
+  }
+  
+  AABox BVH::getBounds() const {
+    if (mNodes.empty()) {
+      return AABox();
+    }
+    const Node &root = mNodes[0];
+    return AABox(Vector3(root.bmin[0], root.bmin[1], root.bmin[2]), Vector3(root.bmax[0], root.bmax[1], root.bmax[2]));
+  }
+  
+  // ---
+  
+  struct RayData {
+    float org[3];
+    float inv[3];
+    
+    RayData(const Ray &ray) {
+      const Vector3 &o = ray.getOrigin();
+      const Vector3 &d = ray.getDirection();
+      for (int k=0; k<3; ++k) {
+        org[k] = o[k];
+        // large but finite so that origins on a slab boundary don't produce 0 * inf
+        inv[k] = (Abs(d[k]) > 1e-20f ? 1.0f / d[k] : 1e30f);
+      }
+    }
+    
+    // Entry distance of the ray in [0, tmax] if it hits the box
+    inline bool hit(const float *bmin, const float *bmax, float tmax, float &tnear) const {
+      float tn = 0.0f;
+      float tf = tmax;
+      for (int k=0; k<3; ++k) {
+        float t0 = (bmin[k] - org[k]) * inv[k];
+        float t1 = (bmax[k] - org[k]) * inv[k];
+        tn = std::max(tn, std::min(t0, t1));
+        tf = std::min(tf, std::max(t0, t1));
+      }
+      tnear = tn;
+      return (tn <= tf);
+    }
+  };
+  
+  struct StackEntry {
+    unsigned int node;
+    float t;
+  };
+  
+  size_t BVH::closestHit(const Ray &ray, float maxDist, float *dist, RayPrimitiveFunc func, void *userData) const {
+    float t;
+    RayData rd(ray);
+    
+    if (mNodes.empty() || !rd.hit(mNodes[0].bmin, mNodes[0].bmax, maxDist, t)) {
+      return InvalidIndex;
+    }
+    
+    StackEntry stack[StackSize];
+    size_t sp = 0;
+    size_t found = InvalidIndex;
+    float best = maxDist;
+    
+    stack[sp].node = 0;
+    stack[sp++].t = t;
+    
+    while (sp > 0) {
+      StackEntry e = stack[--sp];
+      if (e.t > best) {
+        continue;
+      }
+      
+      const Node &node = mNodes[e.node];
+      
+      if (IsLeaf(node)) {
+        for (unsigned int j=0; j<node.count; ++j) {
+          unsigned int idx = mIndices[node.offset + j];
+          if (func) {
+            float d = best;
+            if (func(idx, ray, &d, userData) && d <= best) {
+              best = d;
+              found = idx;
+            }
+          } else {
+            const Bounds &b = mBoxes[idx];
+            if (rd.hit(b.bmin, b.bmax, best, t) && (found == InvalidIndex || t < best)) {
+              best = t;
+              found = idx;
+            }
+          }
+        }
+      } else {
+        unsigned int c0 = e.node + 1;
+        unsigned int c1 = node.offset;
+        float t0, t1;
+        bool h0 = rd.hit(mNodes[c0].bmin, mNodes[c0].bmax, best, t0);
+        bool h1 = rd.hit(mNodes[c1].bmin, mNodes[c1].bmax, best, t1);
+        // push the farther child first so the nearer one is visited next
+        if (h0 && h1 && t0 < t1) {
+          std::swap(c0, c1);
+          std::swap(t0, t1);
+        }
+        if (h0 || h1) {
+          if (h0 && h1) {
+            stack[sp].node = c0;
+            stack[sp++].t = t0;
+            stack[sp].node = c1;
+            stack[sp++].t = t1;
+          } else {
+            stack[sp].node = (h0 ? e.node + 1 : node.offset);
+            stack[sp++].t = (h0 ? t0 : t1);
+          }
+        }
+      }
+    }
+    
+    if (dist && found != InvalidIndex) {
+      *dist = best;
+    }
+    
+    return found;
+  }
+  
+  bool BVH::anyHit(const Ray &ray, float maxDist, RayPrimitiveFunc func, void *userData) const {
+    float t;
+    RayData rd(ray);
+    
+    if (mNodes.empty() || !rd.hit(mNodes[0].bmin, mNodes[0].bmax, maxDist, t)) {
+      return false;
+    }
+    
+    unsigned int stack[StackSize];
+    size_t sp = 0;
+    
+    stack[sp++] = 0;
+    
+    while (sp > 0) {
+      unsigned int index = stack[--sp];
+      const Node &node = mNodes[index];
+      
+      if (IsLeaf(node)) {
+        for (unsigned int j=0; j<node.count; ++j) {
+          unsigned int idx = mIndices[node.offset + j];
+          if (func) {
+            float d = maxDist;
+            if (func(idx, ray, &d, userData)) {
+              return true;
+            }
+          } else if (rd.hit(mBoxes[idx].bmin, mBoxes[idx].bmax, maxDist, t)) {
+            return true;
+          }
+        }
+      } else {
+        if (rd.hit(mNodes[node.offset].bmin, mNodes[node.offset].bmax, maxDist, t)) {
+          stack[sp++] = node.offset;
+        }
+        if (rd.hit(mNodes[index + 1].bmin, mNodes[index + 1].bmax, maxDist, t)) {
+          stack[sp++] = index + 1;
+        }
+      }
+    }
+    
+    return false;
+  }
+  
+  // ---
+  
+  // Boxes of a subtree are contiguous in the indices array: from its leftmost leaf to
+  // its rightmost one
+  static size_t AppendSubtree(const std::vector<Node> &nodes, const std::vector<unsigned int> &indices, size_t index, std::vector<size_t> &out) {
+    size_t first = index;
+    while (!IsLeaf(nodes[first])) {
+      first = first + 1;
+    }
+    size_t last = index;
+    while (!IsLeaf(nodes[last])) {
+      last = nodes[last].offset;
+    }
+    size_t begin = nodes[first].offset;
+    size_t end = nodes[last].offset + nodes[last].count;
+    for (size_t i=begin; i<end; ++i) {
+      out.push_back(indices[i]);
+    }
+    return end - begin;
+  }
+  
+  size_t BVH::query(const Frustum &f, std::vector<size_t> &indices) const {
+    if (mNodes.empty()) {
+      return 0;
+    }
+    
+    float n[6][3];
+    float a[6][3];
+    float d[6];
+    for (unsigned char p=0; p<6; ++p) {
+      const Plane &pl = f.getPlane(p);
+      for (int k=0; k<3; ++k) {
+        n[p][k] = pl.getNormal()[k];
+        a[p][k] = Abs(n[p][k]);
+      }
+      d[p] = pl.getD();
+    }
+    
+    struct Entry {
+      unsigned int node;
+      unsigned char mask;
+    } stack[StackSize];
+    size_t sp = 0;
+    size_t count = 0;
+    
+    stack[sp].node = 0;
+    stack[sp++].mask = Frustum::ALL_PLANES_MASK;
+    
+    while (sp > 0) {
+      Entry e = stack[--sp];
+      const Node &node = mNodes[e.node];
+      
+      // same test as Frustum::classify, planes the node is inside of are skipped below it
+      float c[3], x[3];
+      for (int k=0; k<3; ++k) {
+        c[k] = 0.5f * (node.bmin[k] + node.bmax[k]);
+        x[k] = 0.5f * (node.bmax[k] - node.bmin[k]);
+      }
+      bool outside = false;
+      for (int p=0; p<6; ++p) {
+        if ((e.mask & (1 << p)) == 0) {
+          continue;
+        }
+        float dist = n[p][0] * c[0] + n[p][1] * c[1] + n[p][2] * c[2] + d[p];
+        float rad = a[p][0] * x[0] + a[p][1] * x[1] + a[p][2] * x[2];
+        if (dist - rad > 0) {
+          outside = true;
+          break;
+        }
+        if (dist + rad <= 0) {
+          e.mask &= (unsigned char) ~(1 << p);
+        }
+      }
+      
+      if (outside) {
+        continue;
+      }
+      
+      if (e.mask == 0) {
+        count += AppendSubtree(mNodes, mIndices, e.node, indices);
+      } else if (IsLeaf(node)) {
+        for (unsigned int j=0; j<node.count; ++j) {
+          unsigned int idx = mIndices[node.offset + j];
+          const Bounds &b = mBoxes[idx];
+          for (int k=0; k<3; ++k) {
+            c[k] = 0.5f * (b.bmin[k] + b.bmax[k]);
+            x[k] = 0.5f * (b.bmax[k] - b.bmin[k]);
+          }
+          bool out = false;
+          for (int p=0; p<6 && !out; ++p) {
+            if (e.mask & (1 << p)) {
+              float dist = n[p][0] * c[0] + n[p][1] * c[1] + n[p][2] * c[2] + d[p];
+              float rad = a[p][0] * x[0] + a[p][1] * x[1] + a[p][2] * x[2];
+              out = (dist - rad > 0);
+            }
+          }
+          if (!out) {
+            indices.push_back(idx);
+            ++count;
+          }
+        }
+      } else {
+        stack[sp].node = node.offset;
+        stack[sp++].mask = e.mask;
+        stack[sp].node = e.node + 1;
+        stack[sp++].mask = e.mask;
+      }
+    }
+    
+    return count;
+  }
+  
+  static inline bool Overlap(const float *bmin0, const float *bmax0, const float *bmin1, const float *bmax1) {
+    return (bmin0[0] <= bmax1[0] && bmin1[0] <= bmax0[0] &&
+            bmin0[1] <= bmax1[1] && bmin1[1] <= bmax0[1] &&
+            bmin0[2] <= bmax1[2] && bmin1[2] <= bmax0[2]);
+  }
+  
+  size_t BVH::query(const AABox &box, std::vector<size_t> &indices) const {
+    if (mNodes.empty()) {
+      return 0;
+    }
+    
+    float bmin[3] = {box.getMin().x, box.getMin().y, box.getMin().z};
+    float bmax[3] = {box.getMax().x, box.getMax().y, box.getMax().z};
+    
+    unsigned int stack[StackSize];
+    size_t sp = 0;
+    size_t count = 0;
+    
+    stack[sp++] = 0;
+    
+    while (sp > 0) {
+      unsigned int index = stack[--sp];
+      const Node &node = mNodes[index];
+      
+      if (!Overlap(node.bmin, node.bmax, bmin, bmax)) {
+        continue;
+      }
+      
+      if (IsLeaf(node)) {
+        for (unsigned int j=0; j<node.count; ++j) {
+          unsigned int idx = mIndices[node.offset + j];
+          if (Overlap(mBoxes[idx].bmin, mBoxes[idx].bmax, bmin, bmax)) {
+            indices.push_back(idx);
+            ++count;
+          }
+        }
+      } else {
+        stack[sp++] = node.offset;
+        stack[sp++] = index + 1;
+      }
+    }
+    
+    return count;
+  }
+  
+}
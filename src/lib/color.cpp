@@ -25,6 +25,10 @@ SOFTWARE.
 */
 
 #include <gmath/color.h>
+#include "batch.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace gmath
 {
@@ -776,6 +780,137 @@ const Matrix3& ColorSpace::getRGBtoXYZMatrix() const
    return mRGBtoXYZ;
 }
 
+Matrix3 ColorSpace::getRGBtoYUVMatrix() const
+{
+   // Same as RGBtoYUV
+   float Wr = mRGBtoXYZ(1, 0);
+   float Wg = mRGBtoXYZ(1, 1);
+   float Wb = mRGBtoXYZ(1, 2);
+   float su = Umax / (1.0f - Wb);
+   float sv = Vmax / (1.0f - Wr);
+   
+   return Matrix3(Wr, Wg, Wb,
+                  -su * Wr, -su * Wg, su * (1.0f - Wb),
+                  sv * (1.0f - Wr), -sv * Wg, -sv * Wb);
+}
+
+Matrix3 ColorSpace::getYUVtoRGBMatrix() const
+{
+   // Same as YUVtoRGB
+   float Wr = mRGBtoXYZ(1, 0);
+   float Wg = mRGBtoXYZ(1, 1);
+   float Wb = mRGBtoXYZ(1, 2);
+   float invWg = 1.0f / Wg;
+   float su = (1.0f - Wb) / Umax;
+   float sv = (1.0f - Wr) / Vmax;
+   
+   return Matrix3(1.0f, 0.0f, sv,
+                  1.0f, -invWg * Wb * su, -invWg * Wr * sv,
+                  1.0f, su, 0.0f);
+}
+
+template <typename T>
+static bool BatchTransform(const Matrix3 &m, const T *in, T *out, size_t npixels, size_t stride)
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(batch::TransformKernel(m), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+template <typename T>
+static bool BatchTransform(const Matrix3 &m, const T *const in[3], T *const out[3], size_t npixels)
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(batch::TransformKernel(m), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+bool ColorSpace::RGBtoXYZ(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(mRGBtoXYZ, in, out, npixels, stride);
+}
+
+bool ColorSpace::RGBtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchTransform(mRGBtoXYZ, in, out, npixels);
+}
+
+bool ColorSpace::XYZtoRGB(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(mXYZtoRGB, in, out, npixels, stride);
+}
+
+bool ColorSpace::XYZtoRGB(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchTransform(mXYZtoRGB, in, out, npixels);
+}
+
+bool ColorSpace::RGBtoYUV(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(getRGBtoYUVMatrix(), in, out, npixels, stride);
+}
+
+bool ColorSpace::RGBtoYUV(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchTransform(getRGBtoYUVMatrix(), in, out, npixels);
+}
+
+bool ColorSpace::YUVtoRGB(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(getYUVtoRGBMatrix(), in, out, npixels, stride);
+}
+
+bool ColorSpace::YUVtoRGB(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchTransform(getYUVtoRGBMatrix(), in, out, npixels);
+}
+
+bool ColorSpace::RGBtoXYZ(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(mRGBtoXYZ, in, out, npixels, stride);
+}
+
+bool ColorSpace::RGBtoXYZ(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   return BatchTransform(mRGBtoXYZ, in, out, npixels);
+}
+
+bool ColorSpace::XYZtoRGB(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(mXYZtoRGB, in, out, npixels, stride);
+}
+
+bool ColorSpace::XYZtoRGB(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   return BatchTransform(mXYZtoRGB, in, out, npixels);
+}
+
+bool ColorSpace::RGBtoYUV(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(getRGBtoYUVMatrix(), in, out, npixels, stride);
+}
+
+bool ColorSpace::RGBtoYUV(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   return BatchTransform(getRGBtoYUVMatrix(), in, out, npixels);
+}
+
+bool ColorSpace::YUVtoRGB(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   return BatchTransform(getYUVtoRGBMatrix(), in, out, npixels, stride);
+}
+
+bool ColorSpace::YUVtoRGB(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   return BatchTransform(getYUVtoRGBMatrix(), in, out, npixels);
+}
+
 void ColorSpace::getPrimaries(Chromaticity &r, Chromaticity &g, Chromaticity &b) const
 {
    r = mRed;
@@ -803,6 +938,7 @@ ToneMappingOperator::ToneMappingOperator(const ColorSpace &cs)
    , mImpl(0)
    , mValid(false)
 {
+   memset(&mCompiled, 0, sizeof(Compiled));
 }
    
 ToneMappingOperator::~ToneMappingOperator()
@@ -826,6 +962,10 @@ void ToneMappingOperator::setMethod(Method m)
             break;
          case Reinhard:
             delete (Impl<ReinhardParams>*)mImpl;
+            break;
+         case ReinhardLocal:
+            delete (Impl<ReinhardLocalParams>*)mImpl;
+            break;
          default:
             break;
          }
@@ -868,9 +1008,29 @@ void ToneMappingOperator::setMethod(Method m)
             mImpl = impl;
             mValid = false;
          }
+         break;
+      case ReinhardLocal:
+         {
+            Impl<ReinhardLocalParams> *impl = new Impl<ReinhardLocalParams>();
+            impl->params.set("key", 0.18f);
+            impl->params.set("Lavg", 0.0f);
+            impl->params.set("Lwht", 0.0f);
+            impl->params.set("phi", 8.0f);
+            impl->params.set("threshold", 0.05f);
+            impl->accessors.key = Params::accessor(impl->params, "key");
+            impl->accessors.Lavg = Params::accessor(impl->params, "Lavg");
+            impl->accessors.Lwht = Params::accessor(impl->params, "Lwht");
+            impl->accessors.phi = Params::accessor(impl->params, "phi");
+            impl->accessors.threshold = Params::accessor(impl->params, "threshold");
+            mImpl = impl;
+            mValid = false;
+         }
+         break;
       default:
          break;
       }
+      
+      compile();
    }
 }
 
@@ -937,9 +1097,43 @@ void ToneMappingOperator::updateParams(const Params &params)
          }
          mValid = (float(impl->accessors.Lavg) > 0.000001f);
       }
+      break;
+   case ReinhardLocal:
+      {
+         Impl<ReinhardLocalParams> *impl = (Impl<ReinhardLocalParams>*)mImpl;
+         float key = 0.18f;
+         float Lavg = 0.0f;
+         float Lwht = 0.0f;
+         float phi = 8.0f;
+         float threshold = 0.05f;
+         if (params.get("key", key))
+         {
+            impl->accessors.key = key;
+         }
+         if (params.get("Lavg", Lavg))
+         {
+            impl->accessors.Lavg = Lavg;
+         }
+         if (params.get("Lwht", Lwht))
+         {
+            impl->accessors.Lwht = Lwht;
+         }
+         if (params.get("phi", phi))
+         {
+            impl->accessors.phi = phi;
+         }
+         if (params.get("threshold", threshold))
+         {
+            impl->accessors.threshold = threshold;
+         }
+         mValid = (float(impl->accessors.Lavg) > 0.000001f);
+      }
+      break;
    default:
       break;
    }
+   
+   compile();
 }
 
 bool ToneMappingOperator::validate()
@@ -965,14 +1159,91 @@ bool ToneMappingOperator::validate()
             Impl<ReinhardParams> *impl = (Impl<ReinhardParams>*)mImpl;
             mValid = (float(impl->accessors.Lavg) > 0.000001f);
          }
+         break;
+      case ReinhardLocal:
+         {
+            Impl<ReinhardLocalParams> *impl = (Impl<ReinhardLocalParams>*)mImpl;
+            mValid = (float(impl->accessors.Lavg) > 0.000001f);
+         }
+         break;
       default:
          break;
       }
    }
    
+   compile();
+   
    return mValid;
 }
 
+void ToneMappingOperator::compile()
+{
+   Compiled &c = mCompiled;
+   
+   const Matrix3 &M = mColorSpace.getRGBtoXYZMatrix();
+   XYZ W = ChromaticityYtoXYZ(mColorSpace.getWhitePoint(), 1.0f);
+   RGB w = mColorSpace.XYZtoRGB(W);
+   
+   for (int j=0; j<3; ++j)
+   {
+      c.lum[j] = M(1, j);
+      c.sum[j] = M(0, j) + M(1, j) + M(2, j);
+   }
+   c.white[0] = w.r;
+   c.white[1] = w.g;
+   c.white[2] = w.b;
+   c.whiteXYZ[0] = W.x;
+   c.whiteXYZ[1] = W.y;
+   c.whiteXYZ[2] = W.z;
+   
+   c.k0 = 1.0f;
+   c.k1 = 0.0f;
+   c.k2 = 0.0f;
+   c.k3 = 0.0f;
+   
+   if (!mValid)
+   {
+      return;
+   }
+   
+   switch (mMethod)
+   {
+   case Linear:
+      {
+         Impl<LinearParams> *impl = (Impl<LinearParams>*)mImpl;
+         c.k0 = 1.0f / float(impl->accessors.Lmax);
+      }
+      break;
+   case Gamma:
+      {
+         Impl<GammaParams> *impl = (Impl<GammaParams>*)mImpl;
+         c.k0 = float(impl->accessors.gain);
+         c.k1 = float(impl->accessors.gamma) - 1.0f;
+      }
+      break;
+   case Reinhard:
+      {
+         Impl<ReinhardParams> *impl = (Impl<ReinhardParams>*)mImpl;
+         float Lwht = float(impl->accessors.Lwht);
+         c.k0 = float(impl->accessors.key) / float(impl->accessors.Lavg);
+         c.k1 = (Lwht > 0.000001f ? 1.0f / (Lwht * Lwht) : 0.0f);
+      }
+      break;
+   case ReinhardLocal:
+      {
+         Impl<ReinhardLocalParams> *impl = (Impl<ReinhardLocalParams>*)mImpl;
+         float Lwht = float(impl->accessors.Lwht);
+         c.k0 = float(impl->accessors.key) / float(impl->accessors.Lavg);
+         c.k1 = (Lwht > 0.000001f ? 1.0f / (Lwht * Lwht) : 0.0f);
+         c.k2 = powf(2.0f, float(impl->accessors.phi)) * float(impl->accessors.key);
+         c.k3 = float(impl->accessors.threshold);
+      }
+      break;
+   default:
+      break;
+   }
+}
+
 bool ToneMappingOperator::isValid() const
 {
   return mValid;
@@ -983,6 +1254,11 @@ ToneMappingOperator::Method ToneMappingOperator::getMethod() const
    return mMethod;
 }
 
+const ColorSpace& ToneMappingOperator::getColorSpace() const
+{
+   return mColorSpace;
+}
+
 void ToneMappingOperator::copyParams(Params &params) const
 {
    params.clear();
@@ -999,6 +1275,10 @@ void ToneMappingOperator::copyParams(Params &params) const
          break;
       case Reinhard:
          params = ((Impl<ReinhardParams>*)mImpl)->params;
+         break;
+      case ReinhardLocal:
+         params = ((Impl<ReinhardLocalParams>*)mImpl)->params;
+         break;
       default:
          break;
       }
@@ -1007,69 +1287,296 @@ void ToneMappingOperator::copyParams(Params &params) const
 
 XYZ ToneMappingOperator::operator()(const XYZ &input) const
 {
+   XYZ output = input;
+   float *c[3] = {&output.x, &output.y, &output.z};
+   eval(c, c, 1, true);
+   return output;
+}
+
+RGB ToneMappingOperator::operator()(const RGB &input) const
+{
+   return mColorSpace.XYZtoRGB(this->operator()(mColorSpace.RGBtoXYZ(input)));
+}
+
+// Per method luminance scale functors, see ToneMappingOperator::Compiled
+
+struct SimpleScale
+{
+   SimpleScale(float, float) {}
+   
+   inline float operator()(float L) const
+   {
+      return 1.0f / (1.0f + L);
+   }
+   
+#ifdef GMATH_SSE2
+   inline __m128 operator()(__m128 L) const
+   {
+      return _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_set1_ps(1.0f), L));
+   }
+#endif
+};
+
+struct LinearScale
+{
+   LinearScale(float k0, float) : k0(k0) {}
+   
+   inline float operator()(float) const
+   {
+      return k0;
+   }
+   
+#ifdef GMATH_SSE2
+   inline __m128 operator()(__m128) const
+   {
+      return _mm_set1_ps(k0);
+   }
+#endif
+   
+   float k0;
+};
+
+struct GammaScale
+{
+   GammaScale(float k0, float k1) : k0(k0), k1(k1) {}
+   
+   // black stays black (L^(gamma-1) is infinite at 0 for gamma < 1)
+   inline float operator()(float L) const
+   {
+      return (L > 0.0f ? k0 * powf(L, k1) : 0.0f);
+   }
+   
+#ifdef GMATH_SSE2
+   inline __m128 operator()(__m128 L) const
+   {
+      float tmp[4];
+      _mm_storeu_ps(tmp, L);
+      for (int i=0; i<4; ++i)
+      {
+         tmp[i] = (tmp[i] > 0.0f ? powf(tmp[i], k1) : 0.0f);
+      }
+      return _mm_mul_ps(_mm_set1_ps(k0), _mm_loadu_ps(tmp));
+   }
+#endif
+   
+   float k0;
+   float k1;
+};
+
+struct ReinhardScale
+{
+   ReinhardScale(float k0, float k1) : k0(k0), k1(k1) {}
+   
+   inline float operator()(float L) const
+   {
+      L *= k0;
+      return k0 * (1.0f + L * k1) / (1.0f + L);
+   }
+   
+#ifdef GMATH_SSE2
+   inline __m128 operator()(__m128 L) const
+   {
+      __m128 one = _mm_set1_ps(1.0f);
+      __m128 K0 = _mm_set1_ps(k0);
+      L = _mm_mul_ps(L, K0);
+      __m128 num = _mm_mul_ps(K0, _mm_add_ps(one, _mm_mul_ps(L, _mm_set1_ps(k1))));
+      return _mm_div_ps(num, _mm_add_ps(one, L));
+   }
+#endif
+   
+   float k0;
+   float k1;
+};
+
+// c' = c * scale(L) if c has a chromaticity (X + Y + Z >= 1e-6), white * L * scale(L) otherwise
+template <class Scale>
+static void ToneMap(const Scale &scale, const float lum[3], const float sum[3], const float white[3],
+                    const float *const in[3], float *const out[3], size_t count)
+{
+   const float *r = in[0];
+   const float *g = in[1];
+   const float *b = in[2];
+   size_t i = 0;
+   
+#ifdef GMATH_SSE2
+   __m128 l0 = _mm_set1_ps(lum[0]), l1 = _mm_set1_ps(lum[1]), l2 = _mm_set1_ps(lum[2]);
+   __m128 s0 = _mm_set1_ps(sum[0]), s1 = _mm_set1_ps(sum[1]), s2 = _mm_set1_ps(sum[2]);
+   __m128 w0 = _mm_set1_ps(white[0]), w1 = _mm_set1_ps(white[1]), w2 = _mm_set1_ps(white[2]);
+   __m128 eps = _mm_set1_ps(0.000001f);
+   
+   for (; i+4<=count; i+=4)
+   {
+      __m128 R = _mm_loadu_ps(r + i);
+      __m128 G = _mm_loadu_ps(g + i);
+      __m128 B = _mm_loadu_ps(b + i);
+      __m128 L = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, R), _mm_mul_ps(l1, G)), _mm_mul_ps(l2, B));
+      __m128 S = _mm_add_ps(_mm_add_ps(_mm_mul_ps(s0, R), _mm_mul_ps(s1, G)), _mm_mul_ps(s2, B));
+      __m128 k = scale(L);
+      __m128 m = _mm_cmpge_ps(S, eps);
+      __m128 Lo = _mm_mul_ps(L, k);
+      R = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(R, k)), _mm_andnot_ps(m, _mm_mul_ps(w0, Lo)));
+      G = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(G, k)), _mm_andnot_ps(m, _mm_mul_ps(w1, Lo)));
+      B = _mm_or_ps(_mm_and_ps(m, _mm_mul_ps(B, k)), _mm_andnot_ps(m, _mm_mul_ps(w2, Lo)));
+      _mm_storeu_ps(out[0] + i, R);
+      _mm_storeu_ps(out[1] + i, G);
+      _mm_storeu_ps(out[2] + i, B);
+   }
+#endif
+   
+   for (; i<count; ++i)
+   {
+      float R = r[i];
+      float G = g[i];
+      float B = b[i];
+      float L = lum[0] * R + lum[1] * G + lum[2] * B;
+      float S = sum[0] * R + sum[1] * G + sum[2] * B;
+      float k = scale(L);
+      if (S >= 0.000001f)
+      {
+         out[0][i] = R * k;
+         out[1][i] = G * k;
+         out[2][i] = B * k;
+      }
+      else
+      {
+         float Lo = L * k;
+         out[0][i] = white[0] * Lo;
+         out[1][i] = white[1] * Lo;
+         out[2][i] = white[2] * Lo;
+      }
+   }
+}
+
+static void CopyChannels(const float *const in[3], float *const out[3], size_t count)
+{
+   for (int c=0; c<3; ++c)
+   {
+      if (out[c] != in[c])
+      {
+         memcpy(out[c], in[c], count * sizeof(float));
+      }
+   }
+}
+
+void ToneMappingOperator::eval(const float *const in[3], float *const out[3], size_t count, bool xyz) const
+{
+   static const float sXYZLum[3] = {0.0f, 1.0f, 0.0f};
+   static const float sXYZSum[3] = {1.0f, 1.0f, 1.0f};
+   
    if (!mValid)
    {
-      return input;
+      CopyChannels(in, out, count);
+      return;
    }
    
-   Chromaticity chroma = XYZtoChromaticity(input, mColorSpace.getWhitePoint());
-   float Lout = input.y;
+   const Compiled &c = mCompiled;
+   const float *lum = (xyz ? sXYZLum : c.lum);
+   const float *sum = (xyz ? sXYZSum : c.sum);
+   const float *white = (xyz ? c.whiteXYZ : c.white);
    
    switch (mMethod)
    {
    case Simple:
-      Lout = Lout / (1.0f + Lout);
+      ToneMap(SimpleScale(c.k0, c.k1), lum, sum, white, in, out, count);
       break;
    case Linear:
-      {
-         Impl<LinearParams> *impl = (Impl<LinearParams>*)mImpl;
-         Lout = Lout / float(impl->accessors.Lmax);
-      }
+      ToneMap(LinearScale(c.k0, c.k1), lum, sum, white, in, out, count);
       break;
    case Gamma:
-      {
-         Impl<GammaParams> *impl = (Impl<GammaParams>*)mImpl;
-         Lout = float(impl->accessors.gain) * powf(Lout, float(impl->accessors.gamma));
-      }
+      ToneMap(GammaScale(c.k0, c.k1), lum, sum, white, in, out, count);
       break;
    case Reinhard:
-      {
-         Impl<ReinhardParams> *impl = (Impl<ReinhardParams>*)mImpl;
-         float L = float(impl->accessors.key) * Lout / float(impl->accessors.Lavg);
-         float Lwht = float(impl->accessors.Lwht);
-         if (Lwht > 0.000001f)
-         {
-            Lout = L * (1.0f + L / (Lwht * Lwht)) / (1.0f + L);
-         }
-         else
-         {
-            Lout = L / (1.0f + L);
-         }
-      }
+   case ReinhardLocal:
+      ToneMap(ReinhardScale(c.k0, c.k1), lum, sum, white, in, out, count);
       break;
    default:
+      // Undefined: identity, as the per pixel operators
+      CopyChannels(in, out, count);
       break;
    }
+}
+
+class ToneMapKernel
+{
+public:
+   ToneMapKernel(const ToneMappingOperator &tmo)
+      : mTMO(tmo)
+   {
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      mTMO.eval(in, out, count, false);
+   }
    
-   return ChromaticityYtoXYZ(chroma, Lout);
+private:
+   const ToneMappingOperator &mTMO;
+};
+
+void ToneMappingOperator::apply(RGB *pixels, size_t n) const
+{
+   if (pixels)
+   {
+      float *p = &(pixels[0].r);
+      apply(p, p, n, sizeof(RGB) / sizeof(float));
+   }
 }
 
-RGB ToneMappingOperator::operator()(const RGB &input) const
+bool ToneMappingOperator::apply(const float *in, float *out, size_t npixels, size_t stride) const
 {
-   return mColorSpace.XYZtoRGB(this->operator()(mColorSpace.RGBtoXYZ(input)));
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(ToneMapKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool ToneMappingOperator::apply(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(ToneMapKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+bool ToneMappingOperator::apply(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(ToneMapKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool ToneMappingOperator::apply(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(ToneMapKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
 }
 
 // ---
 
+// Integer temperature XYZ values, integrated on demand in chunks of ChunkSize kelvins
 class BlackbodyColor
 {
 public:
+   static const int ChunkSize = 16;
+
    ~BlackbodyColor()
    {
-      if (mValues)
+      for (int i=0; i<mChunkCount; ++i)
       {
-         delete[] mValues;
+         delete[] mChunks[i].load();
       }
+      delete[] mChunks;
    }
 
    XYZ operator()(float temp)
@@ -1079,19 +1586,21 @@ public:
       if (idx < 0 || idx >= mCount)
       {
          // value not cached, compute it
-         Blackbody bb(temp);
-         return IntegrateVisibleSpectrum(bb, (mUseObs1964 ? StandardObserver::CIE1964 : StandardObserver::CIE1931));
+         return Integrate(temp);
       }
       else
       {
+         // chunks hold ChunkSize + 1 values so that idx + 1 is always in the same chunk
+         const XYZ *values = getChunk(idx / ChunkSize);
+         int i = idx % ChunkSize;
          float dt = temp - float(idx);
          if (dt > 0 && idx + 1 < mCount)
          {
-            return mValues[idx] + dt * (mValues[idx + 1] - mValues[idx]);
+            return values[i] + dt * (values[i + 1] - values[i]);
          }
          else
          {
-            return mValues[idx];
+            return values[i];
          }
       }
    }
@@ -1104,6 +1613,9 @@ public:
 
 private:
    BlackbodyColor(int maxTemp=20000)
+      : mCount(0)
+      , mChunkCount(0)
+      , mChunks(0)
    {
       int evi = 0;
       char *ev = 0;
@@ -1122,23 +1634,53 @@ private:
          }
 
          mCount = maxTemp + 1;
-         mValues = new XYZ[mCount];
-
-         for (int i=0; i<mCount; ++i)
+         mChunkCount = (mCount + ChunkSize - 1) / ChunkSize;
+         mChunks = new std::atomic<XYZ*>[mChunkCount];
+         
+         for (int i=0; i<mChunkCount; ++i)
          {
-            Blackbody bb((float)i);
-            mValues[i] = IntegrateVisibleSpectrum(bb, (mUseObs1964 ? StandardObserver::CIE1964 : StandardObserver::CIE1931));
+            mChunks[i].store(0);
          }
       }
-      else
+   }
+   
+   XYZ Integrate(float temp) const
+   {
+      Blackbody bb(temp);
+      return IntegrateVisibleSpectrum(bb, (mUseObs1964 ? StandardObserver::CIE1964 : StandardObserver::CIE1931));
+   }
+   
+   const XYZ* getChunk(int chunk)
+   {
+      XYZ *values = mChunks[chunk].load(std::memory_order_acquire);
+      
+      if (!values)
       {
-         mCount = 0;
-         mValues = 0;
+         std::lock_guard<std::mutex> lock(mMutex);
+         
+         values = mChunks[chunk].load(std::memory_order_relaxed);
+         
+         if (!values)
+         {
+            values = new XYZ[ChunkSize + 1];
+            
+            int t = chunk * ChunkSize;
+            for (int i=0; i<=ChunkSize; ++i, ++t)
+            {
+               values[i] = Integrate(float(t));
+            }
+            
+            mChunks[chunk].store(values, std::memory_order_release);
+         }
       }
+      
+      return values;
    }
 
    int mCount;
-   XYZ *mValues;
+   int mChunkCount;
+   std::atomic<XYZ*> *mChunks;
+   std::mutex mMutex;
    bool mUseObs1964;
 };
 
@@ -1673,6 +2215,177 @@ XYZ ChromaticityYtoXYZ(const Chromaticity &c, float Y)
    return rv;
 }
 
+// ---
+
+static Matrix3 ComputeRGBtoRGB(const ColorSpace &from, const ColorSpace &to, int cat)
+{
+   if (cat < 0)
+   {
+      return to.getXYZtoRGBMatrix() * from.getRGBtoXYZMatrix();
+   }
+   XYZ fw = ChromaticityYtoXYZ(from.getWhitePoint(), 1.0f);
+   XYZ tw = ChromaticityYtoXYZ(to.getWhitePoint(), 1.0f);
+   return to.getXYZtoRGBMatrix() * ChromaticAdaptationMatrix(fw, tw, ChromaticAdaptationTransform(cat)) * from.getRGBtoXYZMatrix();
+}
+
+// RGB to RGB matrices by color space pair and adaptation (-1 for none)
+//   Pairs of built-in color spaces are found by address in a table filled at creation,
+//   other pairs are keyed on their primaries and white points
+class RGBtoRGBCache
+{
+public:
+   static RGBtoRGBCache& Get()
+   {
+      static RGBtoRGBCache sTheInstance;
+      return sTheInstance;
+   }
+   
+   Matrix3 get(const ColorSpace &from, const ColorSpace &to, int cat)
+   {
+      // unknown adaptations behave as CAT_XYZ, see ChromaticAdaptationMatrix
+      if (cat < -1 || cat > CAT_XYZ)
+      {
+         cat = CAT_XYZ;
+      }
+      
+      int i = BuiltinIndex(from);
+      int j = BuiltinIndex(to);
+      
+      if (i >= 0 && j >= 0)
+      {
+         return mBuiltins[i][j][cat + 1];
+      }
+      
+      Key key;
+      from.getPrimaries(key.c[0], key.c[1], key.c[2]);
+      key.c[3] = from.getWhitePoint();
+      to.getPrimaries(key.c[4], key.c[5], key.c[6]);
+      key.c[7] = to.getWhitePoint();
+      key.cat = cat;
+      
+      std::lock_guard<std::mutex> lock(mMutex);
+      
+      std::unordered_map<Key, Matrix3, KeyHash>::const_iterator it = mMatrices.find(key);
+      if (it != mMatrices.end())
+      {
+         return it->second;
+      }
+      
+      if (mMatrices.size() >= MaxEntries)
+      {
+         mMatrices.clear();
+      }
+      
+      Matrix3 m = ComputeRGBtoRGB(from, to, cat);
+      mMatrices[key] = m;
+      return m;
+   }
+   
+private:
+   
+   enum
+   {
+      NumBuiltins = 11,
+      NumAdaptations = CAT_XYZ + 2,
+      MaxEntries = 4096
+   };
+   
+   struct Key
+   {
+      Chromaticity c[8];
+      int cat;
+      
+      bool operator==(const Key &rhs) const
+      {
+         for (int i=0; i<8; ++i)
+         {
+            if (c[i].x != rhs.c[i].x || c[i].y != rhs.c[i].y)
+            {
+               return false;
+            }
+         }
+         return (cat == rhs.cat);
+      }
+   };
+   
+   struct KeyHash
+   {
+      size_t operator()(const Key &k) const
+      {
+         // FNV-1a over the coordinates bits
+         size_t h = 2166136261u;
+         for (int i=0; i<8; ++i)
+         {
+            unsigned int bits[2];
+            memcpy(&bits[0], &k.c[i].x, sizeof(float));
+            memcpy(&bits[1], &k.c[i].y, sizeof(float));
+            h = (h ^ bits[0]) * 16777619u;
+            h = (h ^ bits[1]) * 16777619u;
+         }
+         return (h ^ size_t(k.cat + 1)) * 16777619u;
+      }
+   };
+   
+   RGBtoRGBCache()
+   {
+      for (int i=0; i<NumBuiltins; ++i)
+      {
+         for (int j=0; j<NumBuiltins; ++j)
+         {
+            for (int cat=-1; cat<=CAT_XYZ; ++cat)
+            {
+               mBuiltins[i][j][cat + 1] = ComputeRGBtoRGB(*Builtin(i), *Builtin(j), cat);
+            }
+         }
+      }
+   }
+   
+   static const ColorSpace* Builtin(int i)
+   {
+      static const ColorSpace* const sBuiltins[NumBuiltins] =
+      {
+         &ColorSpace::Rec709,
+         &ColorSpace::NTSC,
+         &ColorSpace::SMPTE,
+         &ColorSpace::CIE,
+         &ColorSpace::UHDTV,
+         &ColorSpace::DCIP3,
+         &ColorSpace::AdobeWide,
+         &ColorSpace::AlexaWide,
+         &ColorSpace::AdobeRGB,
+         &ColorSpace::ACES_AP0,
+         &ColorSpace::ACES_AP1
+      };
+      return sBuiltins[i];
+   }
+   
+   static int BuiltinIndex(const ColorSpace &cs)
+   {
+      for (int i=0; i<NumBuiltins; ++i)
+      {
+         if (&cs == Builtin(i))
+         {
+            return i;
+         }
+      }
+      return -1;
+   }
+   
+   Matrix3 mBuiltins[NumBuiltins][NumBuiltins][NumAdaptations];
+   std::mutex mMutex;
+   std::unordered_map<Key, Matrix3, KeyHash> mMatrices;
+};
+
+Matrix3 RGBtoRGBMatrix(const ColorSpace &from, const ColorSpace &to)
+{
+   return RGBtoRGBCache::Get().get(from, to, -1);
+}
+
+Matrix3 RGBtoRGBMatrix(const ColorSpace &from, const ColorSpace &to, ChromaticAdaptationTransform cat)
+{
+   return RGBtoRGBCache::Get().get(from, to, int(cat));
+}
+
 } // namespace gmath
 
 std::ostream& operator<<(std::ostream &os, const gmath::ColorSpace &cs)
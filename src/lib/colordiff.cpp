@@ -0,0 +1,656 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colordiff.h>
+#include <gmath/parallel.h>
+#include "batch.h"
+#include <limits>
+
+namespace gmath
+{
+
+static const double Pow25_7 = 6103515625.0; // 25^7
+
+static inline double Degrees(double r)
+{
+   return r * 180.0 / M_PI;
+}
+
+static inline double Radians(double d)
+{
+   return d * M_PI / 180.0;
+}
+
+float DeltaE76(const LAB &c0, const LAB &c1)
+{
+   float dL = c1.l - c0.l;
+   float da = c1.a - c0.a;
+   float db = c1.b - c0.b;
+   return sqrtf(dL * dL + da * da + db * db);
+}
+
+float DeltaE94(const LAB &reference, const LAB &sample, float kL, float K1, float K2)
+{
+   float dL = reference.l - sample.l;
+   float da = reference.a - sample.a;
+   float db = reference.b - sample.b;
+   float C1 = sqrtf(reference.a * reference.a + reference.b * reference.b);
+   float C2 = sqrtf(sample.a * sample.a + sample.b * sample.b);
+   float dC = C1 - C2;
+   float dH2 = std::max(0.0f, da * da + db * db - dC * dC);
+   float SC = 1.0f + K1 * C1;
+   float SH = 1.0f + K2 * C1;
+   float tL = dL / kL;
+   float tC = dC / SC;
+   return sqrtf(tL * tL + tC * tC + dH2 / (SH * SH));
+}
+
+float DeltaE2000(const LAB &c0, const LAB &c1, float kL, float kC, float kH)
+{
+   // G. Sharma, W. Wu, E. N. Dalal, "The CIEDE2000 color-difference formula:
+   //   Implementation notes, supplementary test data, and mathematical observations", 2005
+   double C1 = sqrt(double(c0.a) * c0.a + double(c0.b) * c0.b);
+   double C2 = sqrt(double(c1.a) * c1.a + double(c1.b) * c1.b);
+   double Cb = 0.5 * (C1 + C2);
+   double Cb7 = pow(Cb, 7.0);
+   double G = 0.5 * (1.0 - sqrt(Cb7 / (Cb7 + Pow25_7)));
+   
+   double a1 = (1.0 + G) * c0.a;
+   double a2 = (1.0 + G) * c1.a;
+   double C1p = sqrt(a1 * a1 + double(c0.b) * c0.b);
+   double C2p = sqrt(a2 * a2 + double(c1.b) * c1.b);
+   double h1p = ((a1 == 0.0 && c0.b == 0.0f) ? 0.0 : Degrees(atan2(double(c0.b), a1)));
+   double h2p = ((a2 == 0.0 && c1.b == 0.0f) ? 0.0 : Degrees(atan2(double(c1.b), a2)));
+   if (h1p < 0.0)
+   {
+      h1p += 360.0;
+   }
+   if (h2p < 0.0)
+   {
+      h2p += 360.0;
+   }
+   
+   double CC = C1p * C2p;
+   
+   double dLp = double(c1.l) - double(c0.l);
+   double dCp = C2p - C1p;
+   double dhp = 0.0;
+   if (CC != 0.0)
+   {
+      dhp = h2p - h1p;
+      if (dhp > 180.0)
+      {
+         dhp -= 360.0;
+      }
+      else if (dhp < -180.0)
+      {
+         dhp += 360.0;
+      }
+   }
+   double dHp = 2.0 * sqrt(CC) * sin(Radians(0.5 * dhp));
+   
+   double Lbp = 0.5 * (double(c0.l) + double(c1.l));
+   double Cbp = 0.5 * (C1p + C2p);
+   double hbp = h1p + h2p;
+   if (CC != 0.0)
+   {
+      if (fabs(h1p - h2p) <= 180.0)
+      {
+         hbp *= 0.5;
+      }
+      else if (hbp < 360.0)
+      {
+         hbp = 0.5 * (hbp + 360.0);
+      }
+      else
+      {
+         hbp = 0.5 * (hbp - 360.0);
+      }
+   }
+   
+   double T = 1.0 - 0.17 * cos(Radians(hbp - 30.0))
+                  + 0.24 * cos(Radians(2.0 * hbp))
+                  + 0.32 * cos(Radians(3.0 * hbp + 6.0))
+                  - 0.20 * cos(Radians(4.0 * hbp - 63.0));
+   double dt = (hbp - 275.0) / 25.0;
+   double dTheta = 30.0 * exp(-dt * dt);
+   double Cbp7 = pow(Cbp, 7.0);
+   double RC = 2.0 * sqrt(Cbp7 / (Cbp7 + Pow25_7));
+   double Lb50 = (Lbp - 50.0) * (Lbp - 50.0);
+   double SL = 1.0 + 0.015 * Lb50 / sqrt(20.0 + Lb50);
+   double SC = 1.0 + 0.045 * Cbp;
+   double SH = 1.0 + 0.015 * Cbp * T;
+   double RT = -sin(Radians(2.0 * dTheta)) * RC;
+   
+   double tL = dLp / (kL * SL);
+   double tC = dCp / (kC * SC);
+   double tH = dHp / (kH * SH);
+   
+   return float(sqrt(tL * tL + tC * tC + tH * tH + RT * tC * tH));
+}
+
+float DeltaE(DeltaEFormula f, const LAB &c0, const LAB &c1)
+{
+   switch (f)
+   {
+   case DeltaE_CIE94:
+      return DeltaE94(c0, c1);
+   case DeltaE_CIEDE2000:
+      return DeltaE2000(c0, c1);
+   case DeltaE_CIE76:
+   default:
+      return DeltaE76(c0, c1);
+   }
+}
+
+// ---
+
+// Channel c of color i is at ch[c][i * stride]
+struct LABSpan
+{
+   const float *ch[3];
+   size_t stride;
+   
+   inline LAB operator[](size_t i) const
+   {
+      size_t o = i * stride;
+      return LAB(ch[0][o], ch[1][o], ch[2][o]);
+   }
+};
+
+static LABSpan Interleaved(const float *p, size_t stride)
+{
+   LABSpan s = {{p, p + 1, p + 2}, stride};
+   return s;
+}
+
+static LABSpan Planar(const float *const p[3])
+{
+   LABSpan s = {{p[0], p[1], p[2]}, 1};
+   return s;
+}
+
+static const size_t ChunkSize = 4096;
+
+class DeltaETask
+{
+public:
+   DeltaETask(DeltaEFormula f, const LABSpan &lab0, const LABSpan &lab1, float *out)
+      : mF(f), mLab0(lab0), mLab1(lab1), mOut(out)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         mOut[i] = DeltaE(mF, mLab0[i], mLab1[i]);
+      }
+   }
+   
+private:
+   DeltaEFormula mF;
+   LABSpan mLab0;
+   LABSpan mLab1;
+   float *mOut;
+};
+
+bool DeltaE(DeltaEFormula f, const float *lab0, const float *lab1, float *out, size_t n, size_t stride)
+{
+   if (!lab0 || !lab1 || !out || stride < 3)
+   {
+      return false;
+   }
+   Parallel::For(n, ChunkSize, DeltaETask(f, Interleaved(lab0, stride), Interleaved(lab1, stride), out));
+   return true;
+}
+
+bool DeltaE(DeltaEFormula f, const float *const lab0[3], const float *const lab1[3], float *out, size_t n)
+{
+   if (!lab0 || !lab1 || !out || !lab0[0] || !lab0[1] || !lab0[2] || !lab1[0] || !lab1[1] || !lab1[2])
+   {
+      return false;
+   }
+   Parallel::For(n, ChunkSize, DeltaETask(f, Planar(lab0), Planar(lab1), out));
+   return true;
+}
+
+// ---
+
+static inline float Distance2(const PaletteIndex::Entry &e, float L, float a, float b)
+{
+   float dL = e.L - L;
+   float da = e.a - a;
+   float db = e.b - b;
+   return dL * dL + da * da + db * db;
+}
+
+// Squared distances from box [bmin, bmax] to the closest and farthest points of e
+static inline void BoxDistances2(const float *bmin, const float *bmax, const PaletteIndex::Entry &e, float &dmin2, float &dmax2)
+{
+   const float p[3] = {e.L, e.a, e.b};
+   dmin2 = 0.0f;
+   dmax2 = 0.0f;
+   for (int c=0; c<3; ++c)
+   {
+      float d0 = bmin[c] - p[c];
+      float d1 = p[c] - bmax[c];
+      float dn = std::max(0.0f, std::max(d0, d1));
+      float df = std::max(Abs(d0), Abs(d1));
+      dmin2 += dn * dn;
+      dmax2 += df * df;
+   }
+}
+
+// Palette entries that may be the nearest to a point of the box
+static void BoxCandidates(const std::vector<PaletteIndex::Entry> &entries, const float *bmin, const float *bmax,
+                          std::vector<PaletteIndex::Entry> &candidates)
+{
+   float dmin2 = 0.0f;
+   float dmax2 = 0.0f;
+   float bound = std::numeric_limits<float>::max();
+   
+   for (size_t i=0; i<entries.size(); ++i)
+   {
+      BoxDistances2(bmin, bmax, entries[i], dmin2, dmax2);
+      bound = std::min(bound, dmax2);
+   }
+   
+   candidates.clear();
+   for (size_t i=0; i<entries.size(); ++i)
+   {
+      BoxDistances2(bmin, bmax, entries[i], dmin2, dmax2);
+      if (dmin2 <= bound)
+      {
+         candidates.push_back(entries[i]);
+      }
+   }
+}
+
+// Cells are processed in blocks of BlockCells^3, whose candidates are a superset of the
+//   candidates of their cells
+static const size_t BlockCells = 4;
+
+class CandidatesTask
+{
+public:
+   CandidatesTask(const std::vector<PaletteIndex::Entry> &palette, const size_t *res, const float *min,
+                  float cellSize, std::vector< std::vector<PaletteIndex::Entry> > &cells)
+      : mPalette(palette), mRes(res), mMin(min), mCellSize(cellSize), mCells(cells)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         mBlocks[c] = (res[c] + BlockCells - 1) / BlockCells;
+      }
+   }
+   
+   size_t count() const
+   {
+      return mBlocks[0] * mBlocks[1] * mBlocks[2];
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      std::vector<PaletteIndex::Entry> superset;
+      // expand boxes slightly so that rounding in cell lookup cannot miss a candidate
+      float pad = 0.001f * mCellSize;
+      float bmin[3];
+      float bmax[3];
+      size_t c0[3];
+      size_t c1[3];
+      
+      for (size_t b=begin; b<end; ++b)
+      {
+         size_t bi[3] = {b % mBlocks[0], (b / mBlocks[0]) % mBlocks[1], b / (mBlocks[0] * mBlocks[1])};
+         
+         for (int c=0; c<3; ++c)
+         {
+            c0[c] = bi[c] * BlockCells;
+            c1[c] = std::min(c0[c] + BlockCells, mRes[c]);
+            bmin[c] = mMin[c] + float(c0[c]) * mCellSize - pad;
+            bmax[c] = mMin[c] + float(c1[c]) * mCellSize + pad;
+         }
+         
+         BoxCandidates(mPalette, bmin, bmax, superset);
+         
+         for (size_t k=c0[2]; k<c1[2]; ++k)
+         {
+            for (size_t j=c0[1]; j<c1[1]; ++j)
+            {
+               for (size_t i=c0[0]; i<c1[0]; ++i)
+               {
+                  size_t ci[3] = {i, j, k};
+                  for (int c=0; c<3; ++c)
+                  {
+                     bmin[c] = mMin[c] + float(ci[c]) * mCellSize - pad;
+                     bmax[c] = mMin[c] + float(ci[c] + 1) * mCellSize + pad;
+                  }
+                  BoxCandidates(superset, bmin, bmax, mCells[i + mRes[0] * (j + mRes[1] * k)]);
+               }
+            }
+         }
+      }
+   }
+   
+private:
+   const std::vector<PaletteIndex::Entry> &mPalette;
+   const size_t *mRes;
+   const float *mMin;
+   float mCellSize;
+   size_t mBlocks[3];
+   std::vector< std::vector<PaletteIndex::Entry> > &mCells;
+};
+
+PaletteIndex::PaletteIndex()
+{
+   clear();
+}
+
+PaletteIndex::~PaletteIndex()
+{
+}
+
+void PaletteIndex::clear()
+{
+   mPalette.clear();
+   for (int c=0; c<3; ++c)
+   {
+      mCandidates[c].clear();
+      mRes[c] = 0;
+      mMin[c] = 0.0f;
+   }
+   mCandidateIndices.clear();
+   mCellStart.clear();
+   mCellSize = 1.0f;
+}
+
+bool PaletteIndex::build(const LAB *palette, size_t n)
+{
+   if (!palette)
+   {
+      return false;
+   }
+   return build(&(palette[0].l), n, sizeof(LAB) / sizeof(float));
+}
+
+bool PaletteIndex::build(const float *lab, size_t n, size_t stride)
+{
+   static const size_t CellsPerColor = 16;
+   static const size_t MaxCells = size_t(1) << 20;
+   
+   clear();
+   
+   if (!lab || stride < 3 || n == 0 || n > size_t(0xFFFFFFFF))
+   {
+      return false;
+   }
+   
+   mPalette.resize(n);
+   
+   float max[3] = {100.0f, 128.0f, 128.0f};
+   mMin[0] = 0.0f;
+   mMin[1] = -128.0f;
+   mMin[2] = -128.0f;
+   
+   for (size_t i=0; i<n; ++i, lab+=stride)
+   {
+      Entry &e = mPalette[i];
+      e.L = lab[0];
+      e.a = lab[1];
+      e.b = lab[2];
+      e.index = (unsigned int) i;
+      
+      for (int c=0; c<3; ++c)
+      {
+         mMin[c] = std::min(mMin[c], lab[c]);
+         max[c] = std::max(max[c], lab[c]);
+      }
+   }
+   
+   double volume = double(max[0] - mMin[0]) * double(max[1] - mMin[1]) * double(max[2] - mMin[2]);
+   size_t ncells = std::min(MaxCells, CellsPerColor * n);
+   
+   mCellSize = float(cbrt(volume / double(ncells)));
+   
+   ncells = 1;
+   for (int c=0; c<3; ++c)
+   {
+      mRes[c] = std::max<size_t>(1, size_t(ceilf((max[c] - mMin[c]) / mCellSize)));
+      ncells *= mRes[c];
+   }
+   
+   std::vector< std::vector<Entry> > cells(ncells);
+   
+   CandidatesTask task(mPalette, mRes, mMin, mCellSize, cells);
+   Parallel::For(task.count(), 1, task);
+   
+   // flatten, padding each cell to a multiple of 4 with far away entries
+   mCellStart.resize(ncells + 1);
+   size_t total = 0;
+   for (size_t c=0; c<ncells; ++c)
+   {
+      mCellStart[c] = total;
+      total += (cells[c].size() + 3) & ~size_t(3);
+   }
+   mCellStart[ncells] = total;
+   
+   for (int c=0; c<3; ++c)
+   {
+      mCandidates[c].assign(total, 1e18f);
+   }
+   mCandidateIndices.assign(total, 0xFFFFFFFF);
+   
+   for (size_t c=0; c<ncells; ++c)
+   {
+      size_t o = mCellStart[c];
+      for (size_t i=0; i<cells[c].size(); ++i, ++o)
+      {
+         const Entry &e = cells[c][i];
+         mCandidates[0][o] = e.L;
+         mCandidates[1][o] = e.a;
+         mCandidates[2][o] = e.b;
+         mCandidateIndices[o] = e.index;
+      }
+   }
+   
+   return true;
+}
+
+size_t PaletteIndex::size() const
+{
+   return mPalette.size();
+}
+
+LAB PaletteIndex::getColor(size_t i) const
+{
+   const Entry &e = mPalette[i];
+   return LAB(e.L, e.a, e.b);
+}
+
+size_t PaletteIndex::cell(float L, float a, float b) const
+{
+   // negated tests so that NaNs fall outside
+   float x = (L - mMin[0]) / mCellSize;
+   float y = (a - mMin[1]) / mCellSize;
+   float z = (b - mMin[2]) / mCellSize;
+   if (!(x >= 0.0f && x < float(mRes[0]) && y >= 0.0f && y < float(mRes[1]) && z >= 0.0f && z < float(mRes[2])))
+   {
+      return size_t(-1);
+   }
+   size_t i = std::min(size_t(x), mRes[0] - 1);
+   size_t j = std::min(size_t(y), mRes[1] - 1);
+   size_t k = std::min(size_t(z), mRes[2] - 1);
+   return i + mRes[0] * (j + mRes[1] * k);
+}
+
+size_t PaletteIndex::nearest(const LAB &c, float *distance) const
+{
+   if (mPalette.empty())
+   {
+      if (distance)
+      {
+         *distance = std::numeric_limits<float>::max();
+      }
+      return mPalette.size();
+   }
+   
+   size_t ci = cell(c.l, c.a, c.b);
+   
+   float d2 = 0.0f;
+   unsigned int idx = 0;
+   
+   if (ci == size_t(-1))
+   {
+      const Entry *first = &mPalette[0];
+      const Entry *last = first + mPalette.size();
+      d2 = Distance2(*first, c.l, c.a, c.b);
+      for (const Entry *e=first+1; e<last; ++e)
+      {
+         float d = Distance2(*e, c.l, c.a, c.b);
+         if (d < d2)
+         {
+            d2 = d;
+            idx = e->index;
+         }
+      }
+   }
+   else
+   {
+      const float *L = &mCandidates[0][0];
+      const float *A = &mCandidates[1][0];
+      const float *B = &mCandidates[2][0];
+      const unsigned int *I = &mCandidateIndices[0];
+      size_t begin = mCellStart[ci];
+      size_t end = mCellStart[ci + 1];
+      
+#ifdef GMATH_SSE2
+      __m128 qL = _mm_set1_ps(c.l);
+      __m128 qa = _mm_set1_ps(c.a);
+      __m128 qb = _mm_set1_ps(c.b);
+      __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+      __m128i bestIdx = _mm_set1_epi32(-1);
+      
+      for (size_t i=begin; i<end; i+=4)
+      {
+         __m128 dL = _mm_sub_ps(_mm_loadu_ps(L + i), qL);
+         __m128 da = _mm_sub_ps(_mm_loadu_ps(A + i), qa);
+         __m128 db = _mm_sub_ps(_mm_loadu_ps(B + i), qb);
+         __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dL, dL), _mm_mul_ps(da, da)), _mm_mul_ps(db, db));
+         __m128 closer = _mm_cmplt_ps(d, best);
+         __m128i ci = _mm_castps_si128(closer);
+         best = _mm_min_ps(d, best);
+         bestIdx = _mm_or_si128(_mm_and_si128(ci, _mm_loadu_si128((const __m128i*)(I + i))), _mm_andnot_si128(ci, bestIdx));
+      }
+      
+      float bd[4];
+      unsigned int bi[4];
+      _mm_storeu_ps(bd, best);
+      _mm_storeu_si128((__m128i*)bi, bestIdx);
+      d2 = bd[0];
+      idx = bi[0];
+      for (int k=1; k<4; ++k)
+      {
+         if (bd[k] < d2 || (bd[k] == d2 && bi[k] < idx))
+         {
+            d2 = bd[k];
+            idx = bi[k];
+         }
+      }
+#else
+      d2 = std::numeric_limits<float>::max();
+      idx = 0xFFFFFFFF;
+      for (size_t i=begin; i<end; ++i)
+      {
+         float dL = L[i] - c.l;
+         float da = A[i] - c.a;
+         float db = B[i] - c.b;
+         float d = dL * dL + da * da + db * db;
+         if (d < d2)
+         {
+            d2 = d;
+            idx = I[i];
+         }
+      }
+#endif
+   }
+   
+   if (distance)
+   {
+      *distance = sqrtf(d2);
+   }
+   
+   return idx;
+}
+
+class NearestTask
+{
+public:
+   NearestTask(const PaletteIndex &index, const LABSpan &lab, unsigned int *indices, float *distances)
+      : mIndex(index), mLab(lab), mIndices(indices), mDistances(distances)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      float d = 0.0f;
+      for (size_t i=begin; i<end; ++i)
+      {
+         mIndices[i] = (unsigned int) mIndex.nearest(mLab[i], &d);
+         if (mDistances)
+         {
+            mDistances[i] = d;
+         }
+      }
+   }
+   
+private:
+   const PaletteIndex &mIndex;
+   LABSpan mLab;
+   unsigned int *mIndices;
+   float *mDistances;
+};
+
+bool PaletteIndex::nearest(const float *lab, size_t n, unsigned int *indices, float *distances, size_t stride) const
+{
+   if (!lab || !indices || stride < 3 || mPalette.empty())
+   {
+      return false;
+   }
+   Parallel::For(n, ChunkSize, NearestTask(*this, Interleaved(lab, stride), indices, distances));
+   return true;
+}
+
+bool PaletteIndex::nearest(const float *const lab[3], size_t n, unsigned int *indices, float *distances) const
+{
+   if (!lab || !lab[0] || !lab[1] || !lab[2] || !indices || mPalette.empty())
+   {
+      return false;
+   }
+   Parallel::For(n, ChunkSize, NearestTask(*this, Planar(lab), indices, distances));
+   return true;
+}
+
+}
@@ -0,0 +1,368 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colorpipeline.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+static bool IsIdentity(const Matrix3 &m, const Vector3 &t)
+{
+   if (Abs(t.x) > EPS6 || Abs(t.y) > EPS6 || Abs(t.z) > EPS6)
+   {
+      return false;
+   }
+
+   for (int i=0; i<3; ++i)
+   {
+      for (int j=0; j<3; ++j)
+      {
+         if (Abs(m(i, j) - (i == j ? 1.0f : 0.0f)) > EPS6)
+         {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+class PipelineKernel
+{
+public:
+   PipelineKernel(const std::vector<ColorPipeline::Stage> &stages)
+      : mStages(stages)
+   {
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      const float *const *src = in;
+      
+      if (mStages.empty())
+      {
+         for (int c=0; c<3; ++c)
+         {
+            if (out[c] != in[c])
+            {
+               memcpy(out[c], in[c], count * sizeof(float));
+            }
+         }
+         return;
+      }
+      
+      for (size_t s=0; s<mStages.size(); ++s)
+      {
+         const ColorPipeline::Stage &stage = mStages[s];
+         
+         switch (stage.type)
+         {
+         case ColorPipeline::Transform:
+            batch::Transform(stage.matrix, stage.offset, src, out, count);
+            break;
+         case ColorPipeline::Linearize:
+            for (int c=0; c<3; ++c)
+            {
+               batch::Linearize(stage.gamma, src[c], out[c], count);
+            }
+            break;
+         case ColorPipeline::Unlinearize:
+            for (int c=0; c<3; ++c)
+            {
+               batch::Unlinearize(stage.gamma, src[c], out[c], count);
+            }
+            break;
+         case ColorPipeline::ToneMap:
+            stage.tmo->eval(src, out, count, true);
+            break;
+         case ColorPipeline::ToneMapRGB:
+            stage.tmo->eval(src, out, count, false);
+            break;
+         case ColorPipeline::GamutMap:
+            stage.gamut->eval(src, out, count);
+            break;
+         case ColorPipeline::Grade:
+            stage.grader->eval(src, out, count);
+            break;
+         default:
+            break;
+         }
+         
+         // following stages work in place
+         src = out;
+      }
+   }
+   
+private:
+   const std::vector<ColorPipeline::Stage> &mStages;
+};
+
+// ---
+
+ColorPipeline::ColorPipeline()
+{
+}
+
+ColorPipeline::ColorPipeline(const ColorPipeline &rhs)
+   : mStages(rhs.mStages)
+{
+}
+
+ColorPipeline::~ColorPipeline()
+{
+}
+
+ColorPipeline& ColorPipeline::operator=(const ColorPipeline &rhs)
+{
+   if (this != &rhs)
+   {
+      mStages = rhs.mStages;
+   }
+   return *this;
+}
+
+void ColorPipeline::clear()
+{
+   mStages.clear();
+}
+
+void ColorPipeline::add(const Stage &stage)
+{
+   if (stage.type == Transform)
+   {
+      if (!mStages.empty() && mStages.back().type == Transform)
+      {
+         Stage &last = mStages.back();
+         
+         // applied after last
+         last.offset = stage.matrix * last.offset + stage.offset;
+         last.matrix = stage.matrix * last.matrix;
+         
+         if (IsIdentity(last.matrix, last.offset))
+         {
+            mStages.pop_back();
+         }
+         return;
+      }
+      else if (IsIdentity(stage.matrix, stage.offset))
+      {
+         return;
+      }
+   }
+   
+   mStages.push_back(stage);
+}
+
+ColorPipeline& ColorPipeline::linearize(Gamma::Function gf)
+{
+   Stage stage;
+   stage.type = Linearize;
+   stage.gamma = gf;
+   stage.tmo = 0;
+   stage.gamut = 0;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::unlinearize(Gamma::Function gf)
+{
+   Stage stage;
+   stage.type = Unlinearize;
+   stage.gamma = gf;
+   stage.tmo = 0;
+   stage.gamut = 0;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::transform(const Matrix3 &m)
+{
+   Stage stage;
+   stage.type = Transform;
+   stage.gamma = Gamma::sRGB;
+   stage.matrix = m;
+   stage.tmo = 0;
+   stage.gamut = 0;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::RGBtoXYZ(const ColorSpace &cs)
+{
+   return transform(cs.getRGBtoXYZMatrix());
+}
+
+ColorPipeline& ColorPipeline::XYZtoRGB(const ColorSpace &cs)
+{
+   return transform(cs.getXYZtoRGBMatrix());
+}
+
+ColorPipeline& ColorPipeline::RGBtoRGB(const ColorSpace &from, const ColorSpace &to)
+{
+   return transform(RGBtoRGBMatrix(from, to));
+}
+
+ColorPipeline& ColorPipeline::RGBtoRGB(const ColorSpace &from, const ColorSpace &to, ChromaticAdaptationTransform cat)
+{
+   return transform(RGBtoRGBMatrix(from, to, cat));
+}
+
+ColorPipeline& ColorPipeline::adapt(const XYZ &from, const XYZ &to, ChromaticAdaptationTransform cat)
+{
+   return transform(ChromaticAdaptationMatrix(from, to, cat));
+}
+
+ColorPipeline& ColorPipeline::toneMap(const ToneMappingOperator &tmo)
+{
+   Stage stage;
+   stage.type = ToneMapRGB;
+   stage.gamma = Gamma::sRGB;
+   stage.tmo = &tmo;
+   stage.gamut = 0;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::toneMapXYZ(const ToneMappingOperator &tmo)
+{
+   Stage stage;
+   stage.type = ToneMap;
+   stage.gamma = Gamma::sRGB;
+   stage.tmo = &tmo;
+   stage.gamut = 0;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::gamutMap(const GamutMapper &gm)
+{
+   Stage stage;
+   stage.type = GamutMap;
+   stage.gamma = Gamma::sRGB;
+   stage.tmo = 0;
+   stage.gamut = &gm;
+   stage.grader = 0;
+   add(stage);
+   return *this;
+}
+
+ColorPipeline& ColorPipeline::grade(const Grader &g)
+{
+   if (g.hasGamma())
+   {
+      Stage stage;
+      stage.type = Grade;
+      stage.gamma = Gamma::sRGB;
+      stage.tmo = 0;
+      stage.gamut = 0;
+      stage.grader = &g;
+      add(stage);
+   }
+   else
+   {
+      const RGB &scale = g.getScale();
+      const RGB &offset = g.getOffset();
+      
+      Stage stage;
+      stage.type = Transform;
+      stage.gamma = Gamma::sRGB;
+      stage.matrix = Matrix3(scale.r, 0.0f, 0.0f,
+                             0.0f, scale.g, 0.0f,
+                             0.0f, 0.0f, scale.b);
+      stage.offset = Vector3(offset.r, offset.g, offset.b);
+      stage.tmo = 0;
+      stage.gamut = 0;
+      stage.grader = 0;
+      add(stage);
+   }
+   return *this;
+}
+
+size_t ColorPipeline::getStageCount() const
+{
+   return mStages.size();
+}
+
+ColorPipeline::StageType ColorPipeline::getStageType(size_t i) const
+{
+   return mStages[i].type;
+}
+
+RGB ColorPipeline::operator()(const RGB &input) const
+{
+   RGB output = input;
+   float *c[3] = {&output.r, &output.g, &output.b};
+   PipelineKernel kernel(mStages);
+   kernel(c, c, 1);
+   return output;
+}
+
+bool ColorPipeline::apply(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(PipelineKernel(mStages), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool ColorPipeline::apply(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(PipelineKernel(mStages), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+bool ColorPipeline::apply(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(PipelineKernel(mStages), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool ColorPipeline::apply(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(PipelineKernel(mStages), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+}
@@ -0,0 +1,339 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colorstats.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+static const int HistogramMinExponent = -16;
+static const int HistogramMaxExponent = 16;
+static const int HistogramBinBits = 7;
+static const unsigned int HistogramLowBits = (unsigned int)(127 + HistogramMinExponent) << 23;
+static const unsigned int HistogramHighBits = (unsigned int)(127 + HistogramMaxExponent) << 23;
+// bin 0 holds values below 2^-16 (and 0, negative values, nan)
+static const size_t HistogramSize = ((size_t)(HistogramMaxExponent - HistogramMinExponent) << HistogramBinBits) + 2;
+
+static const size_t StatsGrainSize = 65536;
+
+union StatsFloatBits
+{
+   float f;
+   unsigned int u;
+};
+
+const float LuminanceStats::LogDelta = 1e-4f;
+
+void LuminanceStats::Accumulator::reset()
+{
+   count = 0;
+   min = std::numeric_limits<float>::max();
+   max = -std::numeric_limits<float>::max();
+   sum = 0.0;
+   logSum = 0.0;
+   histogram.assign(HistogramSize, 0);
+}
+
+void LuminanceStats::Accumulator::add(const float *L, size_t n)
+{
+   double s = 0.0;
+   double ls = 0.0;
+   unsigned int *hist = &histogram[0];
+   StatsFloatBits fb;
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      float l = L[i];
+      
+      min = std::min(min, l);
+      max = std::max(max, l);
+      s += l;
+      
+      float lp = (l > 0.0f ? l : 0.0f);
+      ls += logf(LogDelta + lp);
+      
+      fb.f = lp;
+      if (fb.u < HistogramLowBits)
+      {
+         hist[0] += 1;
+      }
+      else if (fb.u >= HistogramHighBits)
+      {
+         hist[HistogramSize - 1] += 1;
+      }
+      else
+      {
+         hist[1 + ((fb.u - HistogramLowBits) >> (23 - HistogramBinBits))] += 1;
+      }
+   }
+   
+   count += n;
+   sum += s;
+   logSum += ls;
+}
+
+void LuminanceStats::Accumulator::merge(const Accumulator &rhs)
+{
+   count += rhs.count;
+   min = std::min(min, rhs.min);
+   max = std::max(max, rhs.max);
+   sum += rhs.sum;
+   logSum += rhs.logSum;
+   for (size_t i=0; i<HistogramSize; ++i)
+   {
+      histogram[i] += rhs.histogram[i];
+   }
+}
+
+// ---
+
+struct PixelSource
+{
+   batch::Pixels px;
+   float w[3];
+   
+   void operator()(size_t offset, size_t count, float *L) const
+   {
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      
+      batch::Load(px, offset, count, storage, soa);
+      
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 w0 = _mm_set1_ps(w[0]);
+      __m128 w1 = _mm_set1_ps(w[1]);
+      __m128 w2 = _mm_set1_ps(w[2]);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 l = _mm_add_ps(_mm_add_ps(_mm_mul_ps(w0, _mm_loadu_ps(soa[0] + i)),
+                                          _mm_mul_ps(w1, _mm_loadu_ps(soa[1] + i))),
+                               _mm_mul_ps(w2, _mm_loadu_ps(soa[2] + i)));
+         _mm_storeu_ps(L + i, l);
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         L[i] = w[0] * soa[0][i] + w[1] * soa[1][i] + w[2] * soa[2][i];
+      }
+   }
+};
+
+struct LuminanceSource
+{
+   const float *values;
+   
+   void operator()(size_t offset, size_t count, float *L) const
+   {
+      memcpy(L, values + offset, count * sizeof(float));
+   }
+};
+
+template <class Source>
+struct StatsTask
+{
+   const Source *src;
+   LuminanceStats::Accumulator *partials;
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      LuminanceStats::Accumulator &acc = partials[begin / StatsGrainSize];
+      float L[batch::BlockSize];
+      
+      acc.reset();
+      
+      for (size_t i=begin; i<end; i+=batch::BlockSize)
+      {
+         size_t count = std::min(batch::BlockSize, end - i);
+         (*src)(i, count, L);
+         acc.add(L, count);
+      }
+   }
+};
+
+template <class Source>
+bool LuminanceStats::reduce(const Source &src, size_t n)
+{
+   clear();
+   
+   std::vector<Accumulator> partials(Parallel::ChunkCount(n, StatsGrainSize));
+   
+   StatsTask<Source> task = {&src, (partials.empty() ? 0 : &partials[0])};
+   Parallel::For(n, StatsGrainSize, task);
+   
+   // merge in chunk order so results don't depend on the thread count
+   for (size_t i=0; i<partials.size(); ++i)
+   {
+      mAcc.merge(partials[i]);
+   }
+   
+   return true;
+}
+
+// ---
+
+LuminanceStats::LuminanceStats()
+{
+   clear();
+}
+
+void LuminanceStats::clear()
+{
+   mAcc.reset();
+}
+
+bool LuminanceStats::compute(const ColorSpace &cs, const float *rgb, size_t npixels, size_t stride)
+{
+   if (!rgb || stride < 3)
+   {
+      return false;
+   }
+   const Matrix3 &M = cs.getRGBtoXYZMatrix();
+   PixelSource src = {batch::Interleaved(rgb, stride), {M(1, 0), M(1, 1), M(1, 2)}};
+   return reduce(src, npixels);
+}
+
+bool LuminanceStats::compute(const ColorSpace &cs, const float *const rgb[3], size_t npixels)
+{
+   if (!rgb || !rgb[0] || !rgb[1] || !rgb[2])
+   {
+      return false;
+   }
+   const Matrix3 &M = cs.getRGBtoXYZMatrix();
+   PixelSource src = {batch::Planar(rgb), {M(1, 0), M(1, 1), M(1, 2)}};
+   return reduce(src, npixels);
+}
+
+bool LuminanceStats::compute(const float *L, size_t n)
+{
+   if (!L)
+   {
+      return false;
+   }
+   LuminanceSource src = {L};
+   return reduce(src, n);
+}
+
+size_t LuminanceStats::getCount() const
+{
+   return mAcc.count;
+}
+
+float LuminanceStats::getMin() const
+{
+   return (mAcc.count > 0 ? mAcc.min : 0.0f);
+}
+
+float LuminanceStats::getMax() const
+{
+   return (mAcc.count > 0 ? mAcc.max : 0.0f);
+}
+
+float LuminanceStats::getAverage() const
+{
+   return (mAcc.count > 0 ? float(mAcc.sum / double(mAcc.count)) : 0.0f);
+}
+
+float LuminanceStats::getLogAverage() const
+{
+   return (mAcc.count > 0 ? float(exp(mAcc.logSum / double(mAcc.count))) : 0.0f);
+}
+
+float LuminanceStats::getPercentile(float p) const
+{
+   if (mAcc.count == 0)
+   {
+      return 0.0f;
+   }
+   
+   double target = double(Clamp(p, 0.0f, 100.0f)) * 0.01 * double(mAcc.count);
+   double cumul = 0.0;
+   float rv = getMax();
+   
+   for (size_t i=0; i<HistogramSize; ++i)
+   {
+      double count = double(mAcc.histogram[i]);
+      
+      if (count > 0.0 && cumul + count >= target)
+      {
+         if (i == 0)
+         {
+            rv = 0.0f;
+         }
+         else if (i == HistogramSize - 1)
+         {
+            rv = getMax();
+         }
+         else
+         {
+            // bins split each octave linearly (float mantissa bits), interpolate within the bin
+            double t = (target - cumul) / count;
+            int e = HistogramMinExponent + int((i - 1) >> HistogramBinBits);
+            size_t m = (i - 1) & ((size_t(1) << HistogramBinBits) - 1);
+            rv = float(ldexp(1.0 + (double(m) + t) / double(1 << HistogramBinBits), e));
+         }
+         break;
+      }
+      
+      cumul += count;
+   }
+   
+   return Clamp(rv, getMin(), getMax());
+}
+
+bool LuminanceStats::updateToneMapping(ToneMappingOperator &tmo, float whitePercentile) const
+{
+   Params params;
+   
+   switch (tmo.getMethod())
+   {
+   case ToneMappingOperator::Linear:
+      params.set("Lmax", getPercentile(whitePercentile));
+      tmo.updateParams(params);
+      break;
+   case ToneMappingOperator::Reinhard:
+   case ToneMappingOperator::ReinhardLocal:
+      {
+         // Lwht is compared against the scaled luminance key * L / Lavg
+         float key = 0.18f;
+         float Lavg = getLogAverage();
+         Params current;
+         tmo.copyParams(current);
+         current.get("key", key);
+         params.set("Lavg", Lavg);
+         params.set("Lwht", (Lavg > 0.0f ? getPercentile(whitePercentile) * key / Lavg : 0.0f));
+         tmo.updateParams(params);
+      }
+      break;
+   default:
+      break;
+   }
+   
+   return tmo.isValid();
+}
+
+}
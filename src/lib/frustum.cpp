@@ -25,6 +25,10 @@ SOFTWARE.
 */
 
 #include <gmath/frustum.h>
+#include <gmath/aabox.h>
+#include <gmath/obox.h>
+#include <gmath/sphere.h>
+#include "batch.h"
 
 namespace gmath {
   
@@ -182,5 +186,249 @@ namespace gmath {
     return *this;
   }
   
+  // ---
+  
+  // Planes in SoA layout for the batch functions
+  struct FrustumPlanes {
+    float n[3][6];
+    float a[3][6]; // |n|
+    float d[6];
+  };
+  
+  struct BoxRadius {
+    const float *const *extents;
+    
+    inline float operator()(const FrustumPlanes &fp, int p, size_t i) const {
+      return fp.a[0][p] * extents[0][i] + fp.a[1][p] * extents[1][i] + fp.a[2][p] * extents[2][i];
+    }
+    
+#ifdef GMATH_SSE2
+    inline __m128 operator()(const FrustumPlanes &fp, int p, size_t i, __m128) const {
+      return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fp.a[0][p]), _mm_loadu_ps(extents[0] + i)),
+                                   _mm_mul_ps(_mm_set1_ps(fp.a[1][p]), _mm_loadu_ps(extents[1] + i))),
+                        _mm_mul_ps(_mm_set1_ps(fp.a[2][p]), _mm_loadu_ps(extents[2] + i)));
+    }
+#endif
+  };
+  
+  struct SphereRadius {
+    const float *radius;
+    
+    inline float operator()(const FrustumPlanes &, int, size_t i) const {
+      return radius[i];
+    }
+    
+#ifdef GMATH_SSE2
+    // loaded once per group by the caller
+    inline __m128 operator()(const FrustumPlanes &, int, size_t, __m128 r) const {
+      return r;
+    }
+#endif
+  };
+  
+  template <class Radius>
+  static size_t ClassifyBatch(const FrustumPlanes &fp, const float *const center[3], const Radius &radius,
+                              const float *sphereRadius, size_t n, unsigned char *results, unsigned char *masks) {
+    size_t visible = 0;
+    // plane that culled the last rejected group, tried first
+    int first = 0;
+    size_t i = 0;
+    
+#ifdef GMATH_SSE2
+    __m128 zero = _mm_setzero_ps();
+    
+    for (; i+4<=n; i+=4) {
+      __m128i lanes = _mm_set1_epi32(Frustum::ALL_PLANES_MASK);
+      int used = Frustum::ALL_PLANES_MASK;
+      if (masks) {
+        lanes = _mm_set_epi32(masks[i+3], masks[i+2], masks[i+1], masks[i]);
+        used = masks[i] | masks[i+1] | masks[i+2] | masks[i+3];
+      }
+      
+      __m128 cx = _mm_loadu_ps(center[0] + i);
+      __m128 cy = _mm_loadu_ps(center[1] + i);
+      __m128 cz = _mm_loadu_ps(center[2] + i);
+      __m128 r = (sphereRadius ? _mm_loadu_ps(sphereRadius + i) : zero);
+      __m128 outside = zero;
+      
+      for (int k=0; k<6; ++k) {
+        int p = (first + k) % 6;
+        if ((used & (1 << p)) == 0) {
+          continue;
+        }
+        __m128i bit = _mm_set1_epi32(1 << p);
+        __m128 active = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lanes, bit), bit));
+        
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(fp.n[0][p]), cx),
+                                                       _mm_mul_ps(_mm_set1_ps(fp.n[1][p]), cy)),
+                                            _mm_mul_ps(_mm_set1_ps(fp.n[2][p]), cz)),
+                                 _mm_set1_ps(fp.d[p]));
+        __m128 rad = radius(fp, p, i, r);
+        
+        outside = _mm_or_ps(outside, _mm_and_ps(active, _mm_cmpgt_ps(_mm_sub_ps(dist, rad), zero)));
+        __m128 inside = _mm_and_ps(active, _mm_cmple_ps(_mm_add_ps(dist, rad), zero));
+        lanes = _mm_andnot_si128(_mm_and_si128(_mm_castps_si128(inside), bit), lanes);
+        
+        if (_mm_movemask_ps(outside) == 0xF) {
+          first = p;
+          break;
+        }
+      }
+      
+      int out = _mm_movemask_ps(outside);
+      int m[4];
+      _mm_storeu_si128((__m128i*) m, lanes);
+      
+      for (int j=0; j<4; ++j) {
+        if (out & (1 << j)) {
+          results[i+j] = Frustum::OUTSIDE;
+        } else {
+          results[i+j] = (unsigned char) (m[j] == 0 ? Frustum::INSIDE : Frustum::INTERSECTING);
+          ++visible;
+        }
+        if (masks) {
+          masks[i+j] = (unsigned char) m[j];
+        }
+      }
+    }
+#endif
+    
+    for (; i<n; ++i) {
+      int mask = (masks ? int(masks[i]) : int(Frustum::ALL_PLANES_MASK));
+      bool outside = false;
+      
+      for (int k=0; k<6; ++k) {
+        int p = (first + k) % 6;
+        if ((mask & (1 << p)) == 0) {
+          continue;
+        }
+        float dist = fp.n[0][p] * center[0][i] + fp.n[1][p] * center[1][i] + fp.n[2][p] * center[2][i] + fp.d[p];
+        float rad = radius(fp, p, i);
+        if (dist - rad > 0) {
+          outside = true;
+          first = p;
+          break;
+        }
+        if (dist + rad <= 0) {
+          mask &= ~(1 << p);
+        }
+      }
+      
+      if (outside) {
+        results[i] = Frustum::OUTSIDE;
+      } else {
+        results[i] = (unsigned char) (mask == 0 ? Frustum::INSIDE : Frustum::INTERSECTING);
+        ++visible;
+      }
+      if (masks) {
+        masks[i] = (unsigned char) mask;
+      }
+    }
+    
+    return visible;
+  }
+  
+  // center distance and projected radius along each plane normal
+  static Frustum::Visibility Classify(const Plane *planes, const Vector3 &c, const Vector3 *axis, const Vector3 &e, float r) {
+    Frustum::Visibility vis = Frustum::INSIDE;
+    for (int p=0; p<6; ++p) {
+      const Vector3 &n = planes[p].getNormal();
+      float dist = n.dot(c) + planes[p].getD();
+      float rad = r;
+      if (axis) {
+        rad = e.x * Abs(n.dot(axis[0])) + e.y * Abs(n.dot(axis[1])) + e.z * Abs(n.dot(axis[2]));
+      }
+      if (dist - rad > 0) {
+        return Frustum::OUTSIDE;
+      }
+      if (dist + rad > 0) {
+        vis = Frustum::INTERSECTING;
+      }
+    }
+    return vis;
+  }
+  
+  Frustum::Visibility Frustum::classify(const AABox &b) const {
+    static const Vector3 axis[3] = {Vector3::UNIT_X, Vector3::UNIT_Y, Vector3::UNIT_Z};
+    if (mDirty) {
+      update();
+    }
+    return Classify(mPlanes, 0.5f * (b.getMin() + b.getMax()), axis, 0.5f * (b.getMax() - b.getMin()), 0);
+  }
+  
+  Frustum::Visibility Frustum::classify(const OBox &b) const {
+    const Vector3 axis[3] = {b.getX(), b.getY(), b.getZ()};
+    if (mDirty) {
+      update();
+    }
+    return Classify(mPlanes, b.getCenter(), axis, b.getExtents(), 0);
+  }
+  
+  Frustum::Visibility Frustum::classify(const Sphere &s) const {
+    if (mDirty) {
+      update();
+    }
+    return Classify(mPlanes, s.getCenter(), 0, Vector3::ZERO, s.getRadius());
+  }
+  
+  Frustum::Visibility Frustum::classify(const AABox &b, unsigned char &planeMask, unsigned char &lastPlane) const {
+    if (mDirty) {
+      update();
+    }
+    Vector3 c = 0.5f * (b.getMin() + b.getMax());
+    Vector3 e = 0.5f * (b.getMax() - b.getMin());
+    int first = (lastPlane < 6 ? lastPlane : 0);
+    for (int k=0; k<6; ++k) {
+      int p = (first + k) % 6;
+      if ((planeMask & (1 << p)) == 0) {
+        continue;
+      }
+      const Vector3 &n = mPlanes[p].getNormal();
+      float dist = n.dot(c) + mPlanes[p].getD();
+      float rad = e.x * Abs(n.x) + e.y * Abs(n.y) + e.z * Abs(n.z);
+      if (dist - rad > 0) {
+        lastPlane = (unsigned char) p;
+        return OUTSIDE;
+      }
+      if (dist + rad <= 0) {
+        planeMask &= (unsigned char) ~(1 << p);
+      }
+    }
+    return (planeMask == 0 ? INSIDE : INTERSECTING);
+  }
+  
+  static void GetPlanes(const Frustum &f, FrustumPlanes &fp) {
+    for (unsigned char p=0; p<6; ++p) {
+      const Plane &pl = f.getPlane(p);
+      const Vector3 &n = pl.getNormal();
+      fp.n[0][p] = n.x;
+      fp.n[1][p] = n.y;
+      fp.n[2][p] = n.z;
+      fp.a[0][p] = Abs(n.x);
+      fp.a[1][p] = Abs(n.y);
+      fp.a[2][p] = Abs(n.z);
+      fp.d[p] = pl.getD();
+    }
+  }
+  
+  size_t Frustum::classify(const float *const center[3], const float *const extents[3], size_t n, unsigned char *results, unsigned char *masks) const {
+    if (!center || !extents || !results) {
+      return 0;
+    }
+    FrustumPlanes fp;
+    GetPlanes(*this, fp);
+    BoxRadius radius = {extents};
+    return ClassifyBatch(fp, center, radius, 0, n, results, masks);
+  }
+  
+  size_t Frustum::classify(const float *const center[3], const float *radius, size_t n, unsigned char *results, unsigned char *masks) const {
+    if (!center || !radius || !results) {
+      return 0;
+    }
+    FrustumPlanes fp;
+    GetPlanes(*this, fp);
+    SphereRadius sr = {radius};
+    return ClassifyBatch(fp, center, sr, radius, n, results, masks);
+  }
+  
 }
-
@@ -0,0 +1,371 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include "batch.h"
+#include <atomic>
+#include <mutex>
+
+namespace gmath
+{
+
+// Float transfer tables: 256 segments per octave over [2^-14, 2^8)
+
+static const int TableMinExponent = -14;
+static const int TableMaxExponent = 8;
+static const int TableSegmentBits = 8;
+static const int TableFracBits = 23 - TableSegmentBits;
+static const unsigned int TableFracMask = (1u << TableFracBits) - 1;
+static const unsigned int TableLowBits = (unsigned int)(127 + TableMinExponent) << 23;
+static const unsigned int TableHighBits = (unsigned int)(127 + TableMaxExponent) << 23;
+static const size_t TableSize = ((size_t)(TableMaxExponent - TableMinExponent) << TableSegmentBits) + 1;
+static const float TableFracScale = 1.0f / float(1u << TableFracBits);
+
+static const int NumFunctions = Gamma::Rec2020 + 1;
+
+union FloatBits
+{
+   float f;
+   unsigned int u;
+};
+
+// Segments whose interpolation error goes over this (function discontinuities) use the exact path
+static const float TableTolerance = 5e-5f;
+
+struct TransferTable
+{
+   float zero;
+   float values[TableSize];
+   bool exact[TableSize];
+};
+
+struct CodeTable
+{
+   std::vector<float> values;
+};
+
+static std::mutex gTablesMutex;
+static std::atomic<TransferTable*> gTransferTables[2][NumFunctions];
+static std::atomic<CodeTable*> gCodeTables[NumFunctions][17];
+
+static inline float Exact(float v, Gamma::Function gf, bool inverse)
+{
+   RGB c(v);
+   return (inverse ? Gamma::Unlinearize(c, gf).r : Gamma::Linearize(c, gf).r);
+}
+
+class TableCleanup
+{
+public:
+   ~TableCleanup()
+   {
+      for (int i=0; i<NumFunctions; ++i)
+      {
+         delete gTransferTables[0][i].load();
+         delete gTransferTables[1][i].load();
+         for (int j=0; j<=16; ++j)
+         {
+            delete gCodeTables[i][j].load();
+         }
+      }
+   }
+};
+
+static TableCleanup gTableCleanup;
+
+static const TransferTable* GetTransferTable(Gamma::Function gf, bool inverse)
+{
+   std::atomic<TransferTable*> &slot = gTransferTables[inverse ? 1 : 0][gf];
+   
+   TransferTable *table = slot.load(std::memory_order_acquire);
+   
+   if (!table)
+   {
+      std::lock_guard<std::mutex> lock(gTablesMutex);
+      
+      table = slot.load(std::memory_order_relaxed);
+      
+      if (!table)
+      {
+         table = new TransferTable();
+         table->zero = Exact(0.0f, gf, inverse);
+         
+         FloatBits fb;
+         for (size_t i=0; i<TableSize; ++i)
+         {
+            fb.u = TableLowBits + (unsigned int)(i << TableFracBits);
+            table->values[i] = Exact(fb.f, gf, inverse);
+            table->exact[i] = false;
+         }
+         
+         for (size_t i=0; i+1<TableSize; ++i)
+         {
+            float v0 = table->values[i];
+            float v1 = table->values[i + 1];
+            
+            for (unsigned int j=1; j<8; ++j)
+            {
+               fb.u = TableLowBits + (unsigned int)(i << TableFracBits) + (j << (TableFracBits - 3));
+               float ref = Exact(fb.f, gf, inverse);
+               float v = v0 + 0.125f * float(j) * (v1 - v0);
+               if (!(Abs(v - ref) <= TableTolerance * std::max(1.0f, Abs(ref))))
+               {
+                  table->exact[i] = true;
+                  break;
+               }
+            }
+         }
+         
+         slot.store(table, std::memory_order_release);
+      }
+   }
+   
+   return table;
+}
+
+static const CodeTable* GetCodeTable(Gamma::Function gf, int bits)
+{
+   std::atomic<CodeTable*> &slot = gCodeTables[gf][bits];
+   
+   CodeTable *table = slot.load(std::memory_order_acquire);
+   
+   if (!table)
+   {
+      std::lock_guard<std::mutex> lock(gTablesMutex);
+      
+      table = slot.load(std::memory_order_relaxed);
+      
+      if (!table)
+      {
+         size_t count = size_t(1) << bits;
+         float maxCode = float(count - 1);
+         
+         table = new CodeTable();
+         table->values.resize(count);
+         
+         for (size_t i=0; i<count; ++i)
+         {
+            table->values[i] = Exact(float(i) / maxCode, gf, false);
+         }
+         
+         slot.store(table, std::memory_order_release);
+      }
+   }
+   
+   return table;
+}
+
+static void Transfer(Gamma::Function gf, bool inverse, const float *in, float *out, size_t n)
+{
+   if (gf < 0 || gf >= NumFunctions)
+   {
+      for (size_t i=0; i<n; ++i)
+      {
+         out[i] = Exact(in[i], gf, inverse);
+      }
+      return;
+   }
+   
+   const TransferTable *table = GetTransferTable(gf, inverse);
+   
+   FloatBits fb;
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      fb.f = in[i];
+      
+      unsigned int offset = fb.u - TableLowBits;
+      unsigned int idx = offset >> TableFracBits;
+      
+      if (fb.u >= TableLowBits && fb.u < TableHighBits && !table->exact[idx])
+      {
+         float t = float(offset & TableFracMask) * TableFracScale;
+         float v0 = table->values[idx];
+         float v1 = table->values[idx + 1];
+         out[i] = v0 + t * (v1 - v0);
+      }
+      else if (fb.f == 0.0f)
+      {
+         out[i] = table->zero;
+      }
+      else
+      {
+         out[i] = Exact(fb.f, gf, inverse);
+      }
+   }
+}
+
+void batch::Linearize(Gamma::Function gf, const float *in, float *out, size_t n)
+{
+   Transfer(gf, false, in, out, n);
+}
+
+void batch::Unlinearize(Gamma::Function gf, const float *in, float *out, size_t n)
+{
+   Transfer(gf, true, in, out, n);
+}
+
+// ---
+
+static const size_t GammaGrainSize = 16384;
+
+struct TransferTask
+{
+   Gamma::Function gf;
+   bool inverse;
+   const float *in;
+   float *out;
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      Transfer(gf, inverse, in + begin, out + begin, end - begin);
+   }
+};
+
+template <typename T>
+struct CodeLinearizeTask
+{
+   const float *table;
+   unsigned int maxCode;
+   const T *in;
+   float *out;
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         unsigned int c = in[i];
+         out[i] = table[c < maxCode ? c : maxCode];
+      }
+   }
+};
+
+template <typename T>
+struct CodeUnlinearizeTask
+{
+   Gamma::Function gf;
+   float maxCode;
+   const float *in;
+   T *out;
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      float tmp[256];
+      
+      for (size_t i=begin; i<end; i+=256)
+      {
+         size_t count = std::min<size_t>(256, end - i);
+         
+         Transfer(gf, true, in + i, tmp, count);
+         
+         for (size_t j=0; j<count; ++j)
+         {
+            // also maps nan to 0
+            float v = tmp[j] * maxCode + 0.5f;
+            out[i + j] = T(v > 0.0f ? (v < maxCode ? v : maxCode) : 0.0f);
+         }
+      }
+   }
+};
+
+void Gamma::Linearize(const float *in, float *out, size_t n, Gamma::Function gf)
+{
+   if (!in || !out)
+   {
+      return;
+   }
+   TransferTask task = {gf, false, in, out};
+   Parallel::For(n, GammaGrainSize, task);
+}
+
+void Gamma::Unlinearize(const float *in, float *out, size_t n, Gamma::Function gf)
+{
+   if (!in || !out)
+   {
+      return;
+   }
+   TransferTask task = {gf, true, in, out};
+   Parallel::For(n, GammaGrainSize, task);
+}
+
+template <typename T>
+static void LinearizeCodes(const T *in, int bits, float *out, size_t n, Gamma::Function gf)
+{
+   unsigned int maxCode = (1u << bits) - 1;
+   
+   if (gf < 0 || gf >= NumFunctions)
+   {
+      for (size_t i=0; i<n; ++i)
+      {
+         unsigned int c = in[i];
+         out[i] = Exact(float(c < maxCode ? c : maxCode) / float(maxCode), gf, false);
+      }
+      return;
+   }
+   
+   CodeLinearizeTask<T> task = {&(GetCodeTable(gf, bits)->values[0]), maxCode, in, out};
+   Parallel::For(n, GammaGrainSize, task);
+}
+
+void Gamma::Linearize(const unsigned char *in, float *out, size_t n, Gamma::Function gf)
+{
+   if (!in || !out)
+   {
+      return;
+   }
+   LinearizeCodes(in, 8, out, n, gf);
+}
+
+void Gamma::Linearize(const unsigned short *in, int bits, float *out, size_t n, Gamma::Function gf)
+{
+   if (!in || !out || bits < 1 || bits > 16)
+   {
+      return;
+   }
+   LinearizeCodes(in, bits, out, n, gf);
+}
+
+void Gamma::Unlinearize(const float *in, unsigned char *out, size_t n, Gamma::Function gf)
+{
+   if (!in || !out)
+   {
+      return;
+   }
+   CodeUnlinearizeTask<unsigned char> task = {gf, 255.0f, in, out};
+   Parallel::For(n, GammaGrainSize, task);
+}
+
+void Gamma::Unlinearize(const float *in, unsigned short *out, int bits, size_t n, Gamma::Function gf)
+{
+   if (!in || !out || bits < 1 || bits > 16)
+   {
+      return;
+   }
+   CodeUnlinearizeTask<unsigned short> task = {gf, float((1u << bits) - 1), in, out};
+   Parallel::For(n, GammaGrainSize, task);
+}
+
+}
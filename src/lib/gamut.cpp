@@ -0,0 +1,576 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/gamut.h>
+#include <gmath/parallel.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+static const float Delta = 6.0f / 29.0f;
+
+static inline float LABf(float t)
+{
+   return (t > Delta * Delta * Delta ? batch::Cbrt(t) : t / (3.0f * Delta * Delta) + 4.0f / 29.0f);
+}
+
+static inline float InvLABf(float t)
+{
+   return (t > Delta ? t * t * t : 3.0f * Delta * Delta * (t - 4.0f / 29.0f));
+}
+
+// ---
+
+GamutMapper::GamutMapper(const ColorSpace &cs, Method method, bool bounded)
+   : mColorSpace(cs)
+   , mMethod(method)
+   , mBounded(bounded)
+   , mPower(1.2f)
+{
+   mThreshold[0] = 0.815f;
+   mThreshold[1] = 0.803f;
+   mThreshold[2] = 0.880f;
+   mLimit[0] = 1.147f;
+   mLimit[1] = 1.264f;
+   mLimit[2] = 1.312f;
+   update();
+}
+
+GamutMapper::GamutMapper(const GamutMapper &rhs)
+   : mColorSpace(rhs.mColorSpace)
+   , mMethod(rhs.mMethod)
+   , mBounded(rhs.mBounded)
+   , mPower(rhs.mPower)
+{
+   for (int c=0; c<3; ++c)
+   {
+      mThreshold[c] = rhs.mThreshold[c];
+      mLimit[c] = rhs.mLimit[c];
+   }
+   update();
+}
+
+GamutMapper::~GamutMapper()
+{
+}
+
+void GamutMapper::update()
+{
+   for (int c=0; c<3; ++c)
+   {
+      float t = mThreshold[c];
+      float l = mLimit[c];
+      mScale[c] = (l - t) / powf(powf((1.0f - t) / (l - t), -mPower) - 1.0f, 1.0f / mPower);
+   }
+   
+   XYZ W = ChromaticityYtoXYZ(mColorSpace.getWhitePoint(), 1.0f);
+   mWhite[0] = W.x;
+   mWhite[1] = W.y;
+   mWhite[2] = W.z;
+}
+
+void GamutMapper::setMethod(Method method)
+{
+   mMethod = method;
+}
+
+GamutMapper::Method GamutMapper::getMethod() const
+{
+   return mMethod;
+}
+
+void GamutMapper::setBounded(bool bounded)
+{
+   mBounded = bounded;
+}
+
+bool GamutMapper::isBounded() const
+{
+   return mBounded;
+}
+
+bool GamutMapper::setCompression(const float threshold[3], const float limit[3], float power)
+{
+   if (!threshold || !limit || !(power > 0.0f))
+   {
+      return false;
+   }
+   for (int c=0; c<3; ++c)
+   {
+      if (!(threshold[c] >= 0.0f && threshold[c] < 1.0f && limit[c] > 1.0f))
+      {
+         return false;
+      }
+   }
+   for (int c=0; c<3; ++c)
+   {
+      mThreshold[c] = threshold[c];
+      mLimit[c] = limit[c];
+   }
+   mPower = power;
+   update();
+   return true;
+}
+
+const ColorSpace& GamutMapper::getColorSpace() const
+{
+   return mColorSpace;
+}
+
+bool GamutMapper::inGamut(const RGB &rgb) const
+{
+   float m = std::min(rgb.r, std::min(rgb.g, rgb.b));
+   float M = std::max(rgb.r, std::max(rgb.g, rgb.b));
+   return (m >= 0.0f && (!mBounded || M <= 1.0f));
+}
+
+bool GamutMapper::inGamut(const XYZ &xyz) const
+{
+   return inGamut(mColorSpace.XYZtoRGB(xyz));
+}
+
+RGB GamutMapper::operator()(const RGB &rgb) const
+{
+   RGB out = rgb;
+   float *c[3] = {&out.r, &out.g, &out.b};
+   eval(c, c, 1);
+   return out;
+}
+
+// ---
+
+void GamutMapper::map(float *c) const
+{
+   float hi = (mBounded ? 1.0f : std::numeric_limits<float>::max());
+   
+   switch (mMethod)
+   {
+   case Compress:
+      {
+         float ach = std::max(c[0], std::max(c[1], c[2]));
+         if (ach == 0.0f)
+         {
+            return;
+         }
+         float aach = Abs(ach);
+         for (int i=0; i<3; ++i)
+         {
+            float d = (ach - c[i]) / aach;
+            if (d > mThreshold[i])
+            {
+               float s = mScale[i];
+               float x = (d - mThreshold[i]) / s;
+               d = mThreshold[i] + s * x / powf(1.0f + powf(x, mPower), 1.0f / mPower);
+               c[i] = ach - d * aach;
+            }
+         }
+      }
+      return;
+   case Desaturate:
+      {
+         const Matrix3 &toXYZ = mColorSpace.getRGBtoXYZMatrix();
+         const Matrix3 &toRGB = mColorSpace.getXYZtoRGBMatrix();
+         
+         float X = toXYZ(0, 0) * c[0] + toXYZ(0, 1) * c[1] + toXYZ(0, 2) * c[2];
+         float Y = toXYZ(1, 0) * c[0] + toXYZ(1, 1) * c[1] + toXYZ(1, 2) * c[2];
+         float Z = toXYZ(2, 0) * c[0] + toXYZ(2, 1) * c[1] + toXYZ(2, 2) * c[2];
+         
+         // the grey of same lightness must fit (greys have r = g = b = Y / Yw)
+         float grey = Y / mWhite[1];
+         if (grey >= 0.0f && grey <= hi)
+         {
+            float fy = LABf(grey);
+            float da = LABf(X / mWhite[0]) - fy;
+            float db = fy - LABf(Z / mWhite[2]);
+            
+            // largest chroma scale in [0, 1] that fits
+            float lo = 0.0f;
+            float up = 1.0f;
+            float rgb[3] = {grey, grey, grey};
+            
+            for (int i=0; i<14; ++i)
+            {
+               float k = 0.5f * (lo + up);
+               float x = mWhite[0] * InvLABf(fy + k * da);
+               float z = mWhite[2] * InvLABf(fy - k * db);
+               float r = toRGB(0, 0) * x + toRGB(0, 1) * Y + toRGB(0, 2) * z;
+               float g = toRGB(1, 0) * x + toRGB(1, 1) * Y + toRGB(1, 2) * z;
+               float b = toRGB(2, 0) * x + toRGB(2, 1) * Y + toRGB(2, 2) * z;
+               
+               if (std::min(r, std::min(g, b)) >= 0.0f && std::max(r, std::max(g, b)) <= hi)
+               {
+                  lo = k;
+                  rgb[0] = r;
+                  rgb[1] = g;
+                  rgb[2] = b;
+               }
+               else
+               {
+                  up = k;
+               }
+            }
+            
+            c[0] = rgb[0];
+            c[1] = rgb[1];
+            c[2] = rgb[2];
+            return;
+         }
+      }
+      // fall through - no grey to desaturate to, clip
+   case Clip:
+   default:
+      for (int i=0; i<3; ++i)
+      {
+         c[i] = std::min(hi, std::max(0.0f, c[i]));
+      }
+      return;
+   }
+}
+
+#ifdef GMATH_SSE2
+
+static inline __m128 LABf(__m128 t)
+{
+   __m128 lin = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(1.0f / (3.0f * Delta * Delta))), _mm_set1_ps(4.0f / 29.0f));
+   // keep the cube root input positive in lanes that use the linear part
+   __m128 cb = batch::Cbrt(_mm_max_ps(t, _mm_set1_ps(Delta * Delta * Delta)));
+   return batch::Select(_mm_cmpgt_ps(t, _mm_set1_ps(Delta * Delta * Delta)), cb, lin);
+}
+
+static inline __m128 InvLABf(__m128 t)
+{
+   __m128 lin = _mm_mul_ps(_mm_set1_ps(3.0f * Delta * Delta), _mm_sub_ps(t, _mm_set1_ps(4.0f / 29.0f)));
+   return batch::Select(_mm_cmpgt_ps(t, _mm_set1_ps(Delta)), _mm_mul_ps(_mm_mul_ps(t, t), t), lin);
+}
+
+// Vector version of GamutMapper::map for Desaturate, lanes not in mask are left untouched
+static void DesaturateLanes(const ColorSpace &cs, const float white[3], bool bounded, __m128 mask, __m128 &R, __m128 &G, __m128 &B)
+{
+   const Matrix3 &toXYZ = cs.getRGBtoXYZMatrix();
+   const Matrix3 &toRGB = cs.getXYZtoRGBMatrix();
+   
+   __m128 zero = _mm_setzero_ps();
+   __m128 hi = _mm_set1_ps(bounded ? 1.0f : std::numeric_limits<float>::max());
+   
+   #define ROW(M, r, x, y, z) _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(M(r, 0)), x), _mm_mul_ps(_mm_set1_ps(M(r, 1)), y)), _mm_mul_ps(_mm_set1_ps(M(r, 2)), z))
+   
+   __m128 X = ROW(toXYZ, 0, R, G, B);
+   __m128 Y = ROW(toXYZ, 1, R, G, B);
+   __m128 Z = ROW(toXYZ, 2, R, G, B);
+   
+   __m128 grey = _mm_mul_ps(Y, _mm_set1_ps(1.0f / white[1]));
+   __m128 valid = _mm_and_ps(_mm_cmpge_ps(grey, zero), _mm_cmple_ps(grey, hi));
+   
+   __m128 fy = LABf(grey);
+   __m128 da = _mm_sub_ps(LABf(_mm_mul_ps(X, _mm_set1_ps(1.0f / white[0]))), fy);
+   __m128 db = _mm_sub_ps(fy, LABf(_mm_mul_ps(Z, _mm_set1_ps(1.0f / white[2]))));
+   
+   __m128 Wx = _mm_set1_ps(white[0]);
+   __m128 Wz = _mm_set1_ps(white[2]);
+   __m128 lo = zero;
+   __m128 up = _mm_set1_ps(1.0f);
+   __m128 half = _mm_set1_ps(0.5f);
+   __m128 r = grey, g = grey, b = grey;
+   
+   for (int i=0; i<14; ++i)
+   {
+      __m128 k = _mm_mul_ps(half, _mm_add_ps(lo, up));
+      __m128 x = _mm_mul_ps(Wx, InvLABf(_mm_add_ps(fy, _mm_mul_ps(k, da))));
+      __m128 z = _mm_mul_ps(Wz, InvLABf(_mm_sub_ps(fy, _mm_mul_ps(k, db))));
+      __m128 tr = ROW(toRGB, 0, x, Y, z);
+      __m128 tg = ROW(toRGB, 1, x, Y, z);
+      __m128 tb = ROW(toRGB, 2, x, Y, z);
+      
+      __m128 fits = _mm_and_ps(_mm_cmpge_ps(_mm_min_ps(tr, _mm_min_ps(tg, tb)), zero),
+                               _mm_cmple_ps(_mm_max_ps(tr, _mm_max_ps(tg, tb)), hi));
+      lo = batch::Select(fits, k, lo);
+      up = batch::Select(fits, up, k);
+      r = batch::Select(fits, tr, r);
+      g = batch::Select(fits, tg, g);
+      b = batch::Select(fits, tb, b);
+   }
+   
+   #undef ROW
+   
+   // lanes without an in gamut grey are clipped
+   r = batch::Select(valid, r, _mm_min_ps(hi, _mm_max_ps(zero, R)));
+   g = batch::Select(valid, g, _mm_min_ps(hi, _mm_max_ps(zero, G)));
+   b = batch::Select(valid, b, _mm_min_ps(hi, _mm_max_ps(zero, B)));
+   
+   R = batch::Select(mask, r, R);
+   G = batch::Select(mask, g, G);
+   B = batch::Select(mask, b, B);
+}
+
+#endif
+
+void GamutMapper::eval(const float *const in[3], float *const out[3], size_t count) const
+{
+   for (int c=0; c<3; ++c)
+   {
+      if (out[c] != in[c])
+      {
+         memcpy(out[c], in[c], count * sizeof(float));
+      }
+   }
+   
+   float *r = out[0];
+   float *g = out[1];
+   float *b = out[2];
+   
+   size_t i = 0;
+   
+#ifdef GMATH_SSE2
+   __m128 zero = _mm_setzero_ps();
+   __m128 one = _mm_set1_ps(1.0f);
+   __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+   __m128 t0 = _mm_set1_ps(mThreshold[0]);
+   __m128 t1 = _mm_set1_ps(mThreshold[1]);
+   __m128 t2 = _mm_set1_ps(mThreshold[2]);
+   
+   for (; i+4<=count; i+=4)
+   {
+      __m128 R = _mm_loadu_ps(r + i);
+      __m128 G = _mm_loadu_ps(g + i);
+      __m128 B = _mm_loadu_ps(b + i);
+      
+      if (mMethod == Clip)
+      {
+         if (mBounded)
+         {
+            R = _mm_min_ps(R, one);
+            G = _mm_min_ps(G, one);
+            B = _mm_min_ps(B, one);
+         }
+         _mm_storeu_ps(r + i, _mm_max_ps(R, zero));
+         _mm_storeu_ps(g + i, _mm_max_ps(G, zero));
+         _mm_storeu_ps(b + i, _mm_max_ps(B, zero));
+         continue;
+      }
+      
+      int mask = 0;
+      
+      if (mMethod == Desaturate)
+      {
+         __m128 m = _mm_cmplt_ps(_mm_min_ps(R, _mm_min_ps(G, B)), zero);
+         if (mBounded)
+         {
+            m = _mm_or_ps(m, _mm_cmpgt_ps(_mm_max_ps(R, _mm_max_ps(G, B)), one));
+         }
+         if (_mm_movemask_ps(m) != 0)
+         {
+            DesaturateLanes(mColorSpace, mWhite, mBounded, m, R, G, B);
+            _mm_storeu_ps(r + i, R);
+            _mm_storeu_ps(g + i, G);
+            _mm_storeu_ps(b + i, B);
+         }
+         continue;
+      }
+      else if (mMethod == Compress)
+      {
+         // (ach - c) > threshold * |ach|
+         __m128 ach = _mm_max_ps(R, _mm_max_ps(G, B));
+         __m128 aach = _mm_and_ps(ach, absMask);
+         __m128 m = _mm_or_ps(_mm_or_ps(_mm_cmpgt_ps(_mm_sub_ps(ach, R), _mm_mul_ps(t0, aach)),
+                                        _mm_cmpgt_ps(_mm_sub_ps(ach, G), _mm_mul_ps(t1, aach))),
+                              _mm_cmpgt_ps(_mm_sub_ps(ach, B), _mm_mul_ps(t2, aach)));
+         mask = _mm_movemask_ps(m);
+      }
+      
+      for (int j=0; mask!=0; ++j, mask>>=1)
+      {
+         if (mask & 1)
+         {
+            float c[3] = {r[i + j], g[i + j], b[i + j]};
+            map(c);
+            r[i + j] = c[0];
+            g[i + j] = c[1];
+            b[i + j] = c[2];
+         }
+      }
+   }
+#endif
+   
+   for (; i<count; ++i)
+   {
+      float c[3] = {r[i], g[i], b[i]};
+      if (mMethod == Clip || mMethod == Compress || !inGamut(RGB(c[0], c[1], c[2])))
+      {
+         map(c);
+         r[i] = c[0];
+         g[i] = c[1];
+         b[i] = c[2];
+      }
+   }
+}
+
+// ---
+
+class GamutKernel
+{
+public:
+   GamutKernel(const GamutMapper &gm)
+      : mGM(gm)
+   {
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      mGM.eval(in, out, count);
+   }
+   
+private:
+   const GamutMapper &mGM;
+};
+
+bool GamutMapper::apply(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(GamutKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool GamutMapper::apply(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(GamutKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+// ---
+
+class ClassifyTask
+{
+public:
+   ClassifyTask(const batch::Pixels &px, bool bounded, unsigned char *mask, size_t *counts)
+      : mPx(px), mBounded(bounded), mMask(mask), mCounts(counts)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      size_t n = 0;
+      
+      for (size_t offset=begin; offset<end; offset+=batch::BlockSize)
+      {
+         size_t count = std::min(batch::BlockSize, end - offset);
+         batch::Load(mPx, offset, count, storage, soa);
+         
+         size_t i = 0;
+         
+#ifdef GMATH_SSE2
+         __m128 zero = _mm_setzero_ps();
+         __m128 one = _mm_set1_ps(1.0f);
+         
+         for (; i+4<=count; i+=4)
+         {
+            __m128 R = _mm_loadu_ps(soa[0] + i);
+            __m128 G = _mm_loadu_ps(soa[1] + i);
+            __m128 B = _mm_loadu_ps(soa[2] + i);
+            __m128 m = _mm_cmplt_ps(_mm_min_ps(R, _mm_min_ps(G, B)), zero);
+            if (mBounded)
+            {
+               m = _mm_or_ps(m, _mm_cmpgt_ps(_mm_max_ps(R, _mm_max_ps(G, B)), one));
+            }
+            int bits = _mm_movemask_ps(m);
+            if (mMask)
+            {
+               for (int j=0; j<4; ++j)
+               {
+                  mMask[offset + i + j] = (unsigned char)((bits >> j) & 1);
+               }
+            }
+            n += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1);
+         }
+#endif
+         
+         for (; i<count; ++i)
+         {
+            float lo = std::min(soa[0][i], std::min(soa[1][i], soa[2][i]));
+            float hi = std::max(soa[0][i], std::max(soa[1][i], soa[2][i]));
+            unsigned char out = (lo < 0.0f || (mBounded && hi > 1.0f) ? 1 : 0);
+            if (mMask)
+            {
+               mMask[offset + i] = out;
+            }
+            n += out;
+         }
+      }
+      
+      mCounts[begin / batch::ChunkSize] = n;
+   }
+   
+private:
+   batch::Pixels mPx;
+   bool mBounded;
+   unsigned char *mMask;
+   size_t *mCounts;
+};
+
+static size_t Classify(const batch::Pixels &px, bool bounded, unsigned char *mask, size_t npixels)
+{
+   std::vector<size_t> counts(Parallel::ChunkCount(npixels, batch::ChunkSize), 0);
+   if (counts.empty())
+   {
+      return 0;
+   }
+   Parallel::For(npixels, batch::ChunkSize, ClassifyTask(px, bounded, mask, &counts[0]));
+   size_t n = 0;
+   for (size_t i=0; i<counts.size(); ++i)
+   {
+      n += counts[i];
+   }
+   return n;
+}
+
+size_t GamutMapper::classify(const float *in, unsigned char *mask, size_t npixels, size_t stride) const
+{
+   if (!in || stride < 3)
+   {
+      return 0;
+   }
+   return Classify(batch::Interleaved(in, stride), mBounded, mask, npixels);
+}
+
+size_t GamutMapper::classify(const float *const in[3], unsigned char *mask, size_t npixels) const
+{
+   if (!in || !in[0] || !in[1] || !in[2])
+   {
+      return 0;
+   }
+   return Classify(batch::Planar(in), mBounded, mask, npixels);
+}
+
+}
@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/grader.h>
+#include "batch.h"
+#include <cfloat>
+
+namespace gmath
+{
+
+Grader::Grader()
+   : mScale(1.0f, 1.0f, 1.0f)
+   , mOffset(0.0f, 0.0f, 0.0f)
+   , mGamma(1.0f, 1.0f, 1.0f)
+   , mHasGamma(false)
+{
+   mExponent[0] = mExponent[1] = mExponent[2] = 1.0f;
+}
+
+Grader::Grader(const RGB &black, const RGB &white, const RGB &lift, const RGB &gain, const RGB &gamma)
+   : mScale(1.0f, 1.0f, 1.0f)
+   , mOffset(0.0f, 0.0f, 0.0f)
+   , mGamma(1.0f, 1.0f, 1.0f)
+   , mHasGamma(false)
+{
+   mExponent[0] = mExponent[1] = mExponent[2] = 1.0f;
+   set(black, white, lift, gain, gamma);
+}
+
+Grader::Grader(const Grader &rhs)
+   : mScale(rhs.mScale)
+   , mOffset(rhs.mOffset)
+   , mGamma(rhs.mGamma)
+   , mHasGamma(rhs.mHasGamma)
+{
+   for (int c=0; c<3; ++c)
+   {
+      mExponent[c] = rhs.mExponent[c];
+   }
+}
+
+Grader::~Grader()
+{
+}
+
+Grader& Grader::operator=(const Grader &rhs)
+{
+   if (this != &rhs)
+   {
+      mScale = rhs.mScale;
+      mOffset = rhs.mOffset;
+      mGamma = rhs.mGamma;
+      mHasGamma = rhs.mHasGamma;
+      for (int c=0; c<3; ++c)
+      {
+         mExponent[c] = rhs.mExponent[c];
+      }
+   }
+   return *this;
+}
+
+bool Grader::set(const RGB &black, const RGB &white, const RGB &lift, const RGB &gain, const RGB &gamma)
+{
+   for (int c=0; c<3; ++c)
+   {
+      if (white[c] == black[c] || !(gamma[c] > 0.0f))
+      {
+         return false;
+      }
+   }
+   
+   mHasGamma = false;
+   
+   for (int c=0; c<3; ++c)
+   {
+      mScale[c] = (gain[c] - lift[c]) / (white[c] - black[c]);
+      mOffset[c] = lift[c] - black[c] * mScale[c];
+      mGamma[c] = gamma[c];
+      mExponent[c] = 1.0f / gamma[c];
+      mHasGamma = mHasGamma || (gamma[c] != 1.0f);
+   }
+   
+   return true;
+}
+
+const RGB& Grader::getScale() const
+{
+   return mScale;
+}
+
+const RGB& Grader::getOffset() const
+{
+   return mOffset;
+}
+
+const RGB& Grader::getGamma() const
+{
+   return mGamma;
+}
+
+bool Grader::hasGamma() const
+{
+   return mHasGamma;
+}
+
+RGB Grader::operator()(const RGB &rgb) const
+{
+   RGB out = rgb;
+   float *c[3] = {&out.r, &out.g, &out.b};
+   eval(c, c, 1);
+   return out;
+}
+
+void Grader::eval(const float *const in[3], float *const out[3], size_t count) const
+{
+   for (int c=0; c<3; ++c)
+   {
+      const float *src = in[c];
+      float *dst = out[c];
+      float scale = mScale[c];
+      float offset = mOffset[c];
+      float exponent = mExponent[c];
+      bool power = (exponent != 1.0f);
+      
+      size_t i = 0;
+      
+#ifdef GMATH_SSE2
+      __m128 S = _mm_set1_ps(scale);
+      __m128 O = _mm_set1_ps(offset);
+      __m128 E = _mm_set1_ps(exponent);
+      __m128 zero = _mm_setzero_ps();
+      __m128 minNormal = _mm_set1_ps(FLT_MIN);
+      __m128 minExp = _mm_set1_ps(-126.0f);
+      __m128 maxExp = _mm_set1_ps(127.0f);
+      
+      if (power)
+      {
+         for (; i+4<=count; i+=4)
+         {
+            __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), S), O);
+            __m128 positive = _mm_cmpgt_ps(v, zero);
+            __m128 y = _mm_mul_ps(E, batch::Log2(_mm_max_ps(v, minNormal)));
+            _mm_storeu_ps(dst + i, batch::Select(positive, batch::Exp2(y), v));
+            
+            // subnormal inputs and results outside the normal range (where Exp2 clamps)
+            //   are rare, redo them with powf
+            __m128 slow = _mm_or_ps(_mm_cmplt_ps(v, minNormal), _mm_or_ps(_mm_cmplt_ps(y, minExp), _mm_cmpgt_ps(y, maxExp)));
+            int mask = _mm_movemask_ps(_mm_and_ps(positive, slow));
+            if (mask != 0)
+            {
+               for (int j=0; j<4; ++j)
+               {
+                  if (mask & (1 << j))
+                  {
+                     dst[i + j] = powf(src[i + j] * scale + offset, exponent);
+                  }
+               }
+            }
+         }
+      }
+      else
+      {
+         for (; i+4<=count; i+=4)
+         {
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), S), O));
+         }
+      }
+#endif
+      
+      for (; i<count; ++i)
+      {
+         float v = src[i] * scale + offset;
+         dst[i] = (power && v > 0.0f ? powf(v, exponent) : v);
+      }
+   }
+}
+
+// ---
+
+class GradeKernel
+{
+public:
+   GradeKernel(const Grader &grader)
+      : mGrader(grader)
+   {
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      mGrader.eval(in, out, count);
+   }
+   
+private:
+   const Grader &mGrader;
+};
+
+bool Grader::apply(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(GradeKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool Grader::apply(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(GradeKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+bool Grader::apply(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(GradeKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool Grader::apply(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(GradeKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+}
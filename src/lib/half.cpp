@@ -0,0 +1,275 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/half.h>
+#include "batch.h"
+
+#if defined(GMATH_SSE2) && !defined(GMATH_NO_F16C) && (defined(__GNUC__) || defined(_MSC_VER))
+#  define GMATH_F16C
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__GNUC__)
+#    include <intrin.h>
+#    define GMATH_F16C_TARGET
+#  else
+#    include <cpuid.h>
+#    define GMATH_F16C_TARGET __attribute__((target("f16c")))
+#  endif
+#endif
+
+namespace gmath
+{
+
+// Half to float: mantissa + exponent tables (exact, subnormals normalized in the mantissa table)
+// Float to half: base + rounded shifted mantissa per float exponent
+//   h = sign | (base[e] + round_to_nearest_even((1.mantissa) >> shift[e]))
+//   Carries out of the mantissa bump the exponent, up to infinity for values >= 65520.
+struct HalfTables
+{
+   unsigned int mantissa[2048];
+   unsigned int exponent[64];
+   unsigned short offset[64];
+   unsigned short base[256];
+   unsigned char shift[256];
+   
+   HalfTables()
+   {
+      mantissa[0] = 0;
+      for (unsigned int i=1; i<1024; ++i)
+      {
+         unsigned int m = i << 13;
+         unsigned int e = 0;
+         while (!(m & 0x00800000))
+         {
+            e -= 0x00800000;
+            m <<= 1;
+         }
+         mantissa[i] = (m & ~0x00800000) | (e + 0x38800000);
+      }
+      for (unsigned int i=1024; i<2048; ++i)
+      {
+         mantissa[i] = 0x38000000 + ((i - 1024) << 13);
+      }
+      
+      for (unsigned int i=0; i<64; ++i)
+      {
+         unsigned int e = i & 31;
+         exponent[i] = (e == 31 ? 0x47800000 : e << 23) | (i >= 32 ? 0x80000000 : 0);
+         offset[i] = (e == 0 ? 0 : 1024);
+      }
+      
+      for (int e=0; e<256; ++e)
+      {
+         if (e <= 101)
+         {
+            // rounds to zero
+            base[e] = 0;
+            shift[e] = 25;
+         }
+         else if (e <= 112)
+         {
+            // half subnormals (or smallest normal after rounding)
+            base[e] = 0;
+            shift[e] = (unsigned char)(126 - e);
+         }
+         else if (e <= 142)
+         {
+            base[e] = (unsigned short)((e - 113) << 10);
+            shift[e] = 13;
+         }
+         else
+         {
+            // overflow to infinity
+            base[e] = 0x7C00;
+            shift[e] = 25;
+         }
+      }
+   }
+};
+
+static const HalfTables& Tables()
+{
+   static HalfTables sTables;
+   return sTables;
+}
+
+static inline float TableHalfToFloat(const HalfTables &t, unsigned short h)
+{
+   unsigned int e = h >> 10;
+   unsigned int bits = t.mantissa[t.offset[e] + (h & 0x3FF)] + t.exponent[e];
+   if ((h & 0x7C00) == 0x7C00 && (h & 0x3FF) != 0)
+   {
+      // quiet signaling NaNs, as vcvtph2ps does
+      bits |= 0x00400000;
+   }
+   float f;
+   memcpy(&f, &bits, sizeof(float));
+   return f;
+}
+
+static inline unsigned short TableFloatToHalf(const HalfTables &t, float f)
+{
+   unsigned int bits;
+   memcpy(&bits, &f, sizeof(float));
+   
+   unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+   unsigned int e = (bits >> 23) & 0xFF;
+   unsigned int m = bits & 0x007FFFFF;
+   
+   if (e == 255 && m != 0)
+   {
+      // quiet NaN, keep the payload high bits
+      return sign | 0x7E00 | (unsigned short)(m >> 13);
+   }
+   
+   m |= 0x00800000;
+   unsigned int s = t.shift[e];
+   unsigned int r = (m + (1u << (s - 1)) - 1 + ((m >> s) & 1)) >> s;
+   return sign | (unsigned short)(t.base[e] + r);
+}
+
+// ---
+
+#ifdef GMATH_F16C
+
+static bool DetectF16C()
+{
+   unsigned int ecx = 0;
+#  if defined(_MSC_VER) && !defined(__GNUC__)
+   int regs[4];
+   __cpuid(regs, 1);
+   ecx = (unsigned int) regs[2];
+#  else
+   unsigned int eax = 0, ebx = 0, edx = 0;
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+   {
+      return false;
+   }
+#  endif
+   
+   // F16C (29), AVX (28) and OSXSAVE (27): F16C instructions are VEX encoded and need
+   // the OS to save the extended register state
+   const unsigned int required = (1u << 29) | (1u << 28) | (1u << 27);
+   if ((ecx & required) != required)
+   {
+      return false;
+   }
+   
+#  if defined(_MSC_VER) && !defined(__GNUC__)
+   unsigned long long xcr0 = _xgetbv(0);
+#  else
+   unsigned int lo = 0, hi = 0;
+   __asm__ __volatile__ ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+   unsigned long long xcr0 = ((unsigned long long) hi << 32) | lo;
+#  endif
+   
+   return ((xcr0 & 6) == 6);
+}
+
+GMATH_F16C_TARGET static void HalfToFloatF16C(const Half *in, float *out, size_t n)
+{
+   for (size_t i=0; i<n; i+=8)
+   {
+      __m128i h = _mm_loadu_si128((const __m128i*) (in + i));
+      _mm_storeu_ps(out + i, _mm_cvtph_ps(h));
+      _mm_storeu_ps(out + i + 4, _mm_cvtph_ps(_mm_srli_si128(h, 8)));
+   }
+}
+
+GMATH_F16C_TARGET static void FloatToHalfF16C(const float *in, Half *out, size_t n)
+{
+   for (size_t i=0; i<n; i+=8)
+   {
+      __m128i h0 = _mm_cvtps_ph(_mm_loadu_ps(in + i), 0);
+      __m128i h1 = _mm_cvtps_ph(_mm_loadu_ps(in + i + 4), 0);
+      _mm_storeu_si128((__m128i*) (out + i), _mm_unpacklo_epi64(h0, h1));
+   }
+}
+
+#endif
+
+bool HasF16C()
+{
+#ifdef GMATH_F16C
+   static const bool sHasF16C = DetectF16C();
+   return sHasF16C;
+#else
+   return false;
+#endif
+}
+
+// ---
+
+float HalfToFloat(Half h)
+{
+   return TableHalfToFloat(Tables(), h.bits);
+}
+
+Half FloatToHalf(float f)
+{
+   Half h;
+   h.bits = TableFloatToHalf(Tables(), f);
+   return h;
+}
+
+void HalfToFloat(const Half *in, float *out, size_t n)
+{
+   size_t i = 0;
+   
+#ifdef GMATH_F16C
+   if (HasF16C())
+   {
+      i = n & ~size_t(7);
+      HalfToFloatF16C(in, out, i);
+   }
+#endif
+   
+   const HalfTables &t = Tables();
+   for (; i<n; ++i)
+   {
+      out[i] = TableHalfToFloat(t, in[i].bits);
+   }
+}
+
+void FloatToHalf(const float *in, Half *out, size_t n)
+{
+   size_t i = 0;
+   
+#ifdef GMATH_F16C
+   if (HasF16C())
+   {
+      i = n & ~size_t(7);
+      FloatToHalfF16C(in, out, i);
+   }
+#endif
+   
+   const HalfTables &t = Tables();
+   for (; i<n; ++i)
+   {
+      out[i].bits = TableFloatToHalf(t, in[i]);
+   }
+}
+
+}
@@ -0,0 +1,737 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/lut3d.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+static const int CubeShaperSize = 4096;
+
+static void PipelineBatch(const float *in, float *out, size_t npixels, void *userData)
+{
+   ((const ColorPipeline*) userData)->apply(in, out, npixels, 3);
+}
+
+class LUTKernel
+{
+public:
+   LUTKernel(const LUT3D &lut)
+      : mLUT(lut)
+   {
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      mLUT.eval(in, out, count);
+   }
+   
+private:
+   const LUT3D &mLUT;
+};
+
+// ---
+
+LUT3D::LUT3D()
+   : mSize(0)
+   , mShaperType(0)
+   , mShaperGamma(Gamma::sRGB)
+   , mShaperOffset(0.0f)
+   , mShaperScale(1.0f)
+   , mShaperSize(0)
+   , mInterpolation(Tetrahedral)
+{
+   for (int c=0; c<3; ++c)
+   {
+      mMin[c] = mShaperMin[c] = 0.0f;
+      mMax[c] = mShaperMax[c] = 1.0f;
+   }
+}
+
+LUT3D::LUT3D(const LUT3D &rhs)
+{
+   *this = rhs;
+}
+
+LUT3D::~LUT3D()
+{
+}
+
+LUT3D& LUT3D::operator=(const LUT3D &rhs)
+{
+   if (this != &rhs)
+   {
+      mSize = rhs.mSize;
+      mData = rhs.mData;
+      mShaperType = rhs.mShaperType;
+      mShaperGamma = rhs.mShaperGamma;
+      mShaperOffset = rhs.mShaperOffset;
+      mShaperScale = rhs.mShaperScale;
+      mShaperSize = rhs.mShaperSize;
+      mShaper = rhs.mShaper;
+      mInterpolation = rhs.mInterpolation;
+      for (int c=0; c<3; ++c)
+      {
+         mMin[c] = rhs.mMin[c];
+         mMax[c] = rhs.mMax[c];
+         mShaperMin[c] = rhs.mShaperMin[c];
+         mShaperMax[c] = rhs.mShaperMax[c];
+      }
+   }
+   return *this;
+}
+
+void LUT3D::clear()
+{
+   mSize = 0;
+   mData.clear();
+   mShaperType = 0;
+   mShaperSize = 0;
+   mShaper.clear();
+}
+
+bool LUT3D::isValid() const
+{
+   return (mSize >= 2);
+}
+
+bool LUT3D::setup(int size, float domainMin, float domainMax)
+{
+   float dmin[3] = {domainMin, domainMin, domainMin};
+   float dmax[3] = {domainMax, domainMax, domainMax};
+   return setup(size, dmin, dmax);
+}
+
+bool LUT3D::setup(int size, const float domainMin[3], const float domainMax[3])
+{
+   clear();
+   
+   if (size < 2 || !(domainMax[0] > domainMin[0]) || !(domainMax[1] > domainMin[1]) || !(domainMax[2] > domainMin[2]))
+   {
+      return false;
+   }
+   
+   mSize = size;
+   mData.resize(3 * size_t(size) * size * size);
+   
+   float *entry = &mData[0];
+   float step = 1.0f / float(size - 1);
+   
+   for (int b=0; b<size; ++b)
+   {
+      for (int g=0; g<size; ++g)
+      {
+         for (int r=0; r<size; ++r, entry+=3)
+         {
+            entry[0] = domainMin[0] + float(r) * step * (domainMax[0] - domainMin[0]);
+            entry[1] = domainMin[1] + float(g) * step * (domainMax[1] - domainMin[1]);
+            entry[2] = domainMin[2] + float(b) * step * (domainMax[2] - domainMin[2]);
+         }
+      }
+   }
+   
+   for (int c=0; c<3; ++c)
+   {
+      mMin[c] = domainMin[c];
+      mMax[c] = domainMax[c];
+   }
+   
+   return true;
+}
+
+bool LUT3D::bake(BatchFunc func, void *userData, int size, const Gamma::Function *shaper, float domainMin, float domainMax)
+{
+   if (!func || size < 2 || !(domainMax > domainMin))
+   {
+      clear();
+      return false;
+   }
+   
+   if (!shaper)
+   {
+      if (!setup(size, domainMin, domainMax))
+      {
+         return false;
+      }
+   }
+   else
+   {
+      float e0 = Gamma::Unlinearize(RGB(domainMin), *shaper).r;
+      float e1 = Gamma::Unlinearize(RGB(domainMax), *shaper).r;
+      
+      if (!(e1 > e0) || !setup(size, 0.0f, 1.0f))
+      {
+         clear();
+         return false;
+      }
+      
+      // lattice points evenly spaced in the shaper output
+      for (size_t i=0; i<mData.size(); ++i)
+      {
+         mData[i] = Gamma::Linearize(RGB(e0 + mData[i] * (e1 - e0)), *shaper).r;
+      }
+      
+      mShaperType = 1;
+      mShaperGamma = *shaper;
+      mShaperOffset = e0;
+      mShaperScale = 1.0f / (e1 - e0);
+      for (int c=0; c<3; ++c)
+      {
+         mShaperMin[c] = domainMin;
+         mShaperMax[c] = domainMax;
+      }
+   }
+   
+   std::vector<float> in(mData);
+   
+   func(&in[0], &mData[0], in.size() / 3, userData);
+   
+   return true;
+}
+
+bool LUT3D::bake(const ColorPipeline &pipeline, int size, float domainMin, float domainMax)
+{
+   return bake(PipelineBatch, (void*) &pipeline, size, 0, domainMin, domainMax);
+}
+
+bool LUT3D::bake(const ColorPipeline &pipeline, int size, Gamma::Function shaper, float domainMin, float domainMax)
+{
+   return bake(PipelineBatch, (void*) &pipeline, size, &shaper, domainMin, domainMax);
+}
+
+bool LUT3D::bake(BatchFunc func, void *userData, int size, float domainMin, float domainMax)
+{
+   return bake(func, userData, size, 0, domainMin, domainMax);
+}
+
+bool LUT3D::bake(BatchFunc func, void *userData, int size, Gamma::Function shaper, float domainMin, float domainMax)
+{
+   return bake(func, userData, size, &shaper, domainMin, domainMax);
+}
+
+int LUT3D::getSize() const
+{
+   return mSize;
+}
+
+void LUT3D::getDomain(float domainMin[3], float domainMax[3]) const
+{
+   for (int c=0; c<3; ++c)
+   {
+      domainMin[c] = mMin[c];
+      domainMax[c] = mMax[c];
+   }
+}
+
+const float* LUT3D::getData() const
+{
+   return (mData.empty() ? 0 : &mData[0]);
+}
+
+float* LUT3D::getData()
+{
+   return (mData.empty() ? 0 : &mData[0]);
+}
+
+bool LUT3D::hasShaper() const
+{
+   return (mShaperType != 0);
+}
+
+void LUT3D::setInterpolation(LUT3D::Interpolation interp)
+{
+   mInterpolation = interp;
+}
+
+LUT3D::Interpolation LUT3D::getInterpolation() const
+{
+   return mInterpolation;
+}
+
+void LUT3D::shape(const float *const in[3], float *const out[3], size_t count) const
+{
+   if (mShaperType == 1)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         batch::Unlinearize(mShaperGamma, in[c], out[c], count);
+         
+         for (size_t i=0; i<count; ++i)
+         {
+            out[c][i] = (out[c][i] - mShaperOffset) * mShaperScale;
+         }
+      }
+   }
+   else if (mShaperType == 2)
+   {
+      float hi = float(mShaperSize - 1);
+      
+      for (int c=0; c<3; ++c)
+      {
+         float scale = hi / (mShaperMax[c] - mShaperMin[c]);
+         const float *table = &mShaper[c];
+         
+         for (size_t i=0; i<count; ++i)
+         {
+            float t = (in[c][i] - mShaperMin[c]) * scale;
+            t = (t > 0.0f ? (t < hi ? t : hi) : 0.0f);
+            int j = std::min(int(t), mShaperSize - 2);
+            float f = t - float(j);
+            float v0 = table[3 * j];
+            float v1 = table[3 * (j + 1)];
+            out[c][i] = v0 + f * (v1 - v0);
+         }
+      }
+   }
+}
+
+void LUT3D::eval(const float *const in[3], float *const out[3], size_t count) const
+{
+   if (mSize < 2)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         if (out[c] != in[c])
+         {
+            memcpy(out[c], in[c], count * sizeof(float));
+         }
+      }
+      return;
+   }
+   
+   float coords[3][batch::BlockSize];
+   float *cp[3] = {coords[0], coords[1], coords[2]};
+   
+   float hi = float(mSize - 1);
+   size_t strideG = 3 * size_t(mSize);
+   size_t strideB = strideG * mSize;
+   const float *data = &mData[0];
+   
+   for (size_t offset=0; offset<count; offset+=batch::BlockSize)
+   {
+      size_t n = std::min(batch::BlockSize, count - offset);
+      const float *src[3] = {in[0] + offset, in[1] + offset, in[2] + offset};
+      
+      if (mShaperType != 0)
+      {
+         shape(src, cp, n);
+         src[0] = cp[0];
+         src[1] = cp[1];
+         src[2] = cp[2];
+      }
+      
+      // lattice coordinates
+      for (int c=0; c<3; ++c)
+      {
+         float lo = mMin[c];
+         float scale = hi / (mMax[c] - mMin[c]);
+         size_t i = 0;
+         
+#ifdef GMATH_SSE2
+         __m128 vlo = _mm_set1_ps(lo);
+         __m128 vscale = _mm_set1_ps(scale);
+         __m128 vhi = _mm_set1_ps(hi);
+         __m128 vzero = _mm_setzero_ps();
+         
+         for (; i+4<=n; i+=4)
+         {
+            __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src[c] + i), vlo), vscale);
+            // max/min return their second operand for nan
+            t = _mm_min_ps(_mm_max_ps(t, vzero), vhi);
+            _mm_storeu_ps(cp[c] + i, t);
+         }
+#endif
+         for (; i<n; ++i)
+         {
+            float t = (src[c][i] - lo) * scale;
+            cp[c][i] = (t > 0.0f ? (t < hi ? t : hi) : 0.0f);
+         }
+      }
+      
+      for (size_t i=0; i<n; ++i)
+      {
+         int ir = std::min(int(cp[0][i]), mSize - 2);
+         int ig = std::min(int(cp[1][i]), mSize - 2);
+         int ib = std::min(int(cp[2][i]), mSize - 2);
+         float fr = cp[0][i] - float(ir);
+         float fg = cp[1][i] - float(ig);
+         float fb = cp[2][i] - float(ib);
+         
+         const float *c000 = data + ib * strideB + ig * strideG + 3 * ir;
+         const float *c100 = c000 + 3;
+         const float *c010 = c000 + strideG;
+         const float *c110 = c010 + 3;
+         const float *c001 = c000 + strideB;
+         const float *c101 = c001 + 3;
+         const float *c011 = c001 + strideG;
+         const float *c111 = c011 + 3;
+         
+         float rgb[3];
+         
+         if (mInterpolation == Tetrahedral)
+         {
+            const float *p1, *p2;
+            float w0, w1, w2, w3;
+            
+            if (fr > fg)
+            {
+               if (fg > fb)
+               {
+                  p1 = c100; p2 = c110; w0 = 1.0f - fr; w1 = fr - fg; w2 = fg - fb; w3 = fb;
+               }
+               else if (fr > fb)
+               {
+                  p1 = c100; p2 = c101; w0 = 1.0f - fr; w1 = fr - fb; w2 = fb - fg; w3 = fg;
+               }
+               else
+               {
+                  p1 = c001; p2 = c101; w0 = 1.0f - fb; w1 = fb - fr; w2 = fr - fg; w3 = fg;
+               }
+            }
+            else
+            {
+               if (fb > fg)
+               {
+                  p1 = c001; p2 = c011; w0 = 1.0f - fb; w1 = fb - fg; w2 = fg - fr; w3 = fr;
+               }
+               else if (fb > fr)
+               {
+                  p1 = c010; p2 = c011; w0 = 1.0f - fg; w1 = fg - fb; w2 = fb - fr; w3 = fr;
+               }
+               else
+               {
+                  p1 = c010; p2 = c110; w0 = 1.0f - fg; w1 = fg - fr; w2 = fr - fb; w3 = fb;
+               }
+            }
+            
+            for (int c=0; c<3; ++c)
+            {
+               rgb[c] = w0 * c000[c] + w1 * p1[c] + w2 * p2[c] + w3 * c111[c];
+            }
+         }
+         else
+         {
+            for (int c=0; c<3; ++c)
+            {
+               float v00 = c000[c] + fr * (c100[c] - c000[c]);
+               float v10 = c010[c] + fr * (c110[c] - c010[c]);
+               float v01 = c001[c] + fr * (c101[c] - c001[c]);
+               float v11 = c011[c] + fr * (c111[c] - c011[c]);
+               float v0 = v00 + fg * (v10 - v00);
+               float v1 = v01 + fg * (v11 - v01);
+               rgb[c] = v0 + fb * (v1 - v0);
+            }
+         }
+         
+         out[0][offset + i] = rgb[0];
+         out[1][offset + i] = rgb[1];
+         out[2][offset + i] = rgb[2];
+      }
+   }
+}
+
+RGB LUT3D::operator()(const RGB &input) const
+{
+   RGB output = input;
+   float *c[3] = {&output.r, &output.g, &output.b};
+   eval(c, c, 1);
+   return output;
+}
+
+bool LUT3D::apply(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(LUTKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool LUT3D::apply(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(LUTKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+bool LUT3D::apply(const Half *in, Half *out, size_t npixels, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(LUTKernel(*this), batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+bool LUT3D::apply(const Half *const in[3], Half *const out[3], size_t npixels) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(LUTKernel(*this), batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+// ---
+
+bool LUT3D::read(const char *path)
+{
+   FILE *f = (path ? fopen(path, "r") : 0);
+   
+   if (!f)
+   {
+      return false;
+   }
+   
+   int size1D = 0;
+   int size3D = 0;
+   float domainMin[3] = {0.0f, 0.0f, 0.0f};
+   float domainMax[3] = {1.0f, 1.0f, 1.0f};
+   float range1D[2] = {0.0f, 1.0f};
+   float range3D[2] = {0.0f, 1.0f};
+   bool hasDomain = false;
+   bool hasRange1D = false;
+   bool hasRange3D = false;
+   bool failed = false;
+   std::vector<float> values;
+   char line[1024];
+   
+   while (!failed && fgets(line, sizeof(line), f))
+   {
+      char *p = line;
+      while (*p == ' ' || *p == '\t')
+      {
+         ++p;
+      }
+      
+      if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#')
+      {
+         continue;
+      }
+      
+      float v[3];
+      
+      if (!strncmp(p, "LUT_1D_SIZE", 11))
+      {
+         failed = (sscanf(p + 11, "%d", &size1D) != 1 || size1D < 2);
+      }
+      else if (!strncmp(p, "LUT_3D_SIZE", 11))
+      {
+         failed = (sscanf(p + 11, "%d", &size3D) != 1 || size3D < 2);
+      }
+      else if (!strncmp(p, "LUT_1D_INPUT_RANGE", 18))
+      {
+         failed = (sscanf(p + 18, "%f %f", &range1D[0], &range1D[1]) != 2);
+         hasRange1D = true;
+      }
+      else if (!strncmp(p, "LUT_3D_INPUT_RANGE", 18))
+      {
+         failed = (sscanf(p + 18, "%f %f", &range3D[0], &range3D[1]) != 2);
+         hasRange3D = true;
+      }
+      else if (!strncmp(p, "DOMAIN_MIN", 10))
+      {
+         failed = (sscanf(p + 10, "%f %f %f", &domainMin[0], &domainMin[1], &domainMin[2]) != 3);
+         hasDomain = true;
+      }
+      else if (!strncmp(p, "DOMAIN_MAX", 10))
+      {
+         failed = (sscanf(p + 10, "%f %f %f", &domainMax[0], &domainMax[1], &domainMax[2]) != 3);
+         hasDomain = true;
+      }
+      else if (sscanf(p, "%f %f %f", &v[0], &v[1], &v[2]) == 3)
+      {
+         values.push_back(v[0]);
+         values.push_back(v[1]);
+         values.push_back(v[2]);
+      }
+      // other keywords (TITLE, LUT_IN_VIDEO_RANGE, ...) are ignored
+   }
+   
+   fclose(f);
+   
+   size_t count1D = size_t(size1D);
+   size_t count3D = size_t(size3D) * size3D * size3D;
+   
+   if (failed || (size1D == 0 && size3D == 0) || values.size() != 3 * (count1D + count3D))
+   {
+      return false;
+   }
+   
+   clear();
+   
+   if (size1D > 0)
+   {
+      mShaperType = 2;
+      mShaperSize = size1D;
+      mShaper.assign(values.begin(), values.begin() + 3 * count1D);
+      for (int c=0; c<3; ++c)
+      {
+         mShaperMin[c] = (hasRange1D || !hasDomain ? range1D[0] : domainMin[c]);
+         mShaperMax[c] = (hasRange1D || !hasDomain ? range1D[1] : domainMax[c]);
+      }
+   }
+   
+   if (size3D > 0)
+   {
+      mSize = size3D;
+      mData.assign(values.begin() + 3 * count1D, values.end());
+      for (int c=0; c<3; ++c)
+      {
+         mMin[c] = (hasRange3D || size1D > 0 || !hasDomain ? range3D[0] : domainMin[c]);
+         mMax[c] = (hasRange3D || size1D > 0 || !hasDomain ? range3D[1] : domainMax[c]);
+      }
+   }
+   else
+   {
+      // 1D only: identity lattice over the range of the 1D values
+      int type = mShaperType;
+      int shaperSize = mShaperSize;
+      std::vector<float> shaper;
+      float smin[3], smax[3], vmin[3], vmax[3];
+      
+      shaper.swap(mShaper);
+      
+      for (int c=0; c<3; ++c)
+      {
+         smin[c] = mShaperMin[c];
+         smax[c] = mShaperMax[c];
+         vmin[c] = vmax[c] = shaper[c];
+         for (size_t i=1; i<count1D; ++i)
+         {
+            vmin[c] = std::min(vmin[c], shaper[3 * i + c]);
+            vmax[c] = std::max(vmax[c], shaper[3 * i + c]);
+         }
+         if (!(vmax[c] > vmin[c]))
+         {
+            vmax[c] = vmin[c] + 1.0f;
+         }
+      }
+      
+      setup(2, vmin, vmax);
+      
+      mShaperType = type;
+      mShaperSize = shaperSize;
+      mShaper.swap(shaper);
+      for (int c=0; c<3; ++c)
+      {
+         mShaperMin[c] = smin[c];
+         mShaperMax[c] = smax[c];
+      }
+   }
+   
+   for (int c=0; c<3; ++c)
+   {
+      if (!(mMax[c] > mMin[c]) || (mShaperType != 0 && !(mShaperMax[c] > mShaperMin[c])))
+      {
+         clear();
+         return false;
+      }
+   }
+   
+   return true;
+}
+
+bool LUT3D::write(const char *path, const char *title) const
+{
+   if (mSize < 2)
+   {
+      return false;
+   }
+   
+   FILE *f = (path ? fopen(path, "w") : 0);
+   
+   if (!f)
+   {
+      return false;
+   }
+   
+   fprintf(f, "# Created by gmath\n");
+   if (title)
+   {
+      fprintf(f, "TITLE \"%s\"\n", title);
+   }
+   
+   if (mShaperType != 0)
+   {
+      // Resolve style: 1D shaper then 3D table, single input range per table
+      int size1D = (mShaperType == 1 ? CubeShaperSize : mShaperSize);
+      
+      fprintf(f, "LUT_1D_SIZE %d\n", size1D);
+      fprintf(f, "LUT_1D_INPUT_RANGE %.6f %.6f\n", mShaperMin[0], mShaperMax[0]);
+      fprintf(f, "LUT_3D_SIZE %d\n", mSize);
+      fprintf(f, "LUT_3D_INPUT_RANGE %.6f %.6f\n", mMin[0], mMax[0]);
+      
+      if (mShaperType == 1)
+      {
+         std::vector<float> x(size1D), y(size1D);
+         for (int i=0; i<size1D; ++i)
+         {
+            x[i] = mShaperMin[0] + (mShaperMax[0] - mShaperMin[0]) * float(i) / float(size1D - 1);
+         }
+         const float *in[3] = {&x[0], &x[0], &x[0]};
+         float *out[3] = {&y[0], &y[0], &y[0]};
+         shape(in, out, size1D);
+         for (int i=0; i<size1D; ++i)
+         {
+            fprintf(f, "%.6f %.6f %.6f\n", y[i], y[i], y[i]);
+         }
+      }
+      else
+      {
+         for (int i=0; i<size1D; ++i)
+         {
+            fprintf(f, "%.6f %.6f %.6f\n", mShaper[3 * i], mShaper[3 * i + 1], mShaper[3 * i + 2]);
+         }
+      }
+   }
+   else
+   {
+      fprintf(f, "LUT_3D_SIZE %d\n", mSize);
+      fprintf(f, "DOMAIN_MIN %.6f %.6f %.6f\n", mMin[0], mMin[1], mMin[2]);
+      fprintf(f, "DOMAIN_MAX %.6f %.6f %.6f\n", mMax[0], mMax[1], mMax[2]);
+   }
+   
+   for (size_t i=0; i<mData.size(); i+=3)
+   {
+      fprintf(f, "%.6f %.6f %.6f\n", mData[i], mData[i + 1], mData[i + 2]);
+   }
+   
+   bool ok = !ferror(f);
+   
+   fclose(f);
+   
+   return ok;
+}
+
+}
@@ -0,0 +1,282 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/parallel.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace gmath
+{
+
+static thread_local bool tInParallelLoop = false;
+
+class ThreadPool
+{
+public:
+   ~ThreadPool()
+   {
+      stopWorkers();
+   }
+   
+   static ThreadPool& Get()
+   {
+      static ThreadPool sTheInstance;
+      return sTheInstance;
+   }
+   
+   size_t threadCount() const
+   {
+      return mThreadCount;
+   }
+   
+   void setThreadCount(size_t n)
+   {
+      std::lock_guard<std::mutex> lock(mRunMutex);
+      
+      n = (n == 0 ? DefaultThreadCount() : n);
+      
+      if (n != mThreadCount)
+      {
+         // workers are re-spawned lazily by the next parallel loop
+         stopWorkers();
+         mThreadCount = n;
+      }
+   }
+   
+   void run(size_t count, size_t grain, Parallel::RangeFunc func, void *userData)
+   {
+      size_t nchunks = Parallel::ChunkCount(count, grain);
+      
+      if (nchunks == 0)
+      {
+         return;
+      }
+      
+      std::unique_lock<std::mutex> runLock(mRunMutex, std::defer_lock);
+      
+      // Run serially when there's nothing to share, when called from a worker
+      // (nested loop) or when another thread already owns the pool
+      if (nchunks == 1 || tInParallelLoop || !runLock.try_lock() || mThreadCount <= 1)
+      {
+         for (size_t i=0, b=0; i<nchunks; ++i, b+=grain)
+         {
+            func(b, std::min(count, b + grain), userData);
+         }
+         return;
+      }
+      
+      if (mWorkers.size() == 0)
+      {
+         startWorkers();
+      }
+      
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mFunc = func;
+         mUserData = userData;
+         mCount = count;
+         mGrain = grain;
+         mChunks = nchunks;
+         mNext = 0;
+         mFinished = 0;
+         ++mGeneration;
+      }
+      mWake.notify_all();
+      
+      size_t done = process();
+      
+      std::unique_lock<std::mutex> lock(mMutex);
+      mFinished += done;
+      // Also wait for all workers to leave the job so that none of them can pick
+      // a chunk index of the next job using this job's function
+      while (mFinished < mChunks || mActive > 0)
+      {
+         mDone.wait(lock);
+      }
+      mFunc = 0;
+      mUserData = 0;
+   }
+
+private:
+   
+   ThreadPool()
+      : mThreadCount(DefaultThreadCount())
+      , mStop(false)
+      , mGeneration(0)
+      , mFunc(0)
+      , mUserData(0)
+      , mCount(0)
+      , mGrain(1)
+      , mChunks(0)
+      , mNext(0)
+      , mFinished(0)
+      , mActive(0)
+   {
+   }
+   
+   static size_t DefaultThreadCount()
+   {
+      int evi = 0;
+      char *ev = getenv("GMATH_NUM_THREADS");
+      
+      if (ev && sscanf(ev, "%d", &evi) == 1 && evi > 0)
+      {
+         return size_t(evi);
+      }
+      else
+      {
+         size_t n = size_t(std::thread::hardware_concurrency());
+         return (n > 0 ? n : 1);
+      }
+   }
+   
+   void startWorkers()
+   {
+      mStop = false;
+      // the calling thread takes part in the loop
+      for (size_t i=1; i<mThreadCount; ++i)
+      {
+         mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this));
+      }
+   }
+   
+   void stopWorkers()
+   {
+      {
+         std::lock_guard<std::mutex> lock(mMutex);
+         mStop = true;
+      }
+      mWake.notify_all();
+      for (size_t i=0; i<mWorkers.size(); ++i)
+      {
+         mWorkers[i].join();
+      }
+      mWorkers.clear();
+   }
+   
+   size_t process()
+   {
+      size_t done = 0;
+      
+      tInParallelLoop = true;
+      
+      for (size_t i = mNext++; i < mChunks; i = mNext++, ++done)
+      {
+         size_t b = i * mGrain;
+         mFunc(b, std::min(mCount, b + mGrain), mUserData);
+      }
+      
+      tInParallelLoop = false;
+      
+      return done;
+   }
+   
+   void workerLoop()
+   {
+      unsigned long seen = 0;
+      
+      std::unique_lock<std::mutex> lock(mMutex);
+      
+      while (true)
+      {
+         while (!mStop && (seen == mGeneration || !mFunc))
+         {
+            mWake.wait(lock);
+         }
+         
+         if (mStop)
+         {
+            break;
+         }
+         
+         seen = mGeneration;
+         ++mActive;
+         lock.unlock();
+         
+         size_t done = process();
+         
+         lock.lock();
+         mFinished += done;
+         --mActive;
+         if (mFinished >= mChunks && mActive == 0)
+         {
+            mDone.notify_all();
+         }
+      }
+   }
+   
+private:
+   
+   std::mutex mRunMutex;
+   std::atomic<size_t> mThreadCount;
+   std::vector<std::thread> mWorkers;
+   
+   std::mutex mMutex;
+   std::condition_variable mWake;
+   std::condition_variable mDone;
+   bool mStop;
+   unsigned long mGeneration;
+   
+   // current loop, mChunks and job description only change while mActive is 0
+   Parallel::RangeFunc mFunc;
+   void *mUserData;
+   size_t mCount;
+   size_t mGrain;
+   size_t mChunks;
+   std::atomic<size_t> mNext;
+   size_t mFinished;
+   size_t mActive;
+};
+
+// ---
+
+void Parallel::SetThreadCount(size_t n)
+{
+   ThreadPool::Get().setThreadCount(n);
+}
+
+size_t Parallel::GetThreadCount()
+{
+   return ThreadPool::Get().threadCount();
+}
+
+size_t Parallel::ChunkCount(size_t count, size_t grain)
+{
+   return (grain == 0 ? count : (count + grain - 1) / grain);
+}
+
+void Parallel::For(size_t count, size_t grain, Parallel::RangeFunc func, void *userData)
+{
+   if (!func)
+   {
+      return;
+   }
+   ThreadPool::Get().run(count, (grain == 0 ? 1 : grain), func, userData);
+}
+
+} // namespace gmath
@@ -0,0 +1,553 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+static const float d = 6.0f / 29.0f;
+static const float d2 = d * d;
+static const float d3 = d * d2;
+static const float s4over29 = 4.0f / 29.0f;
+static const float s29over3c = (29.0f * 29.0f * 29.0f) / 27.0f;
+
+template <class Kernel>
+static bool BatchRun(const Kernel &kernel, const float *in, float *out, size_t npixels, size_t stride)
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   batch::Run(kernel, batch::Interleaved(in, stride), batch::Interleaved(out, stride), npixels);
+   return true;
+}
+
+template <class Kernel>
+static bool BatchRun(const Kernel &kernel, const float *const in[3], float *const out[3], size_t npixels)
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   batch::Run(kernel, batch::Planar(in), batch::Planar(out), npixels);
+   return true;
+}
+
+// ---
+
+// f(t) = t^1/3 if t > d^3, t / (3 * d^2) + 4 / 29 otherwise
+static inline float LABf(float t)
+{
+   return (t > d3 ? batch::Cbrt(t) : t / (3.0f * d2) + s4over29);
+}
+
+static inline float LABfinv(float t)
+{
+   return (t > d ? t * t * t : 3.0f * d2 * (t - s4over29));
+}
+
+#ifdef GMATH_SSE2
+static inline __m128 LABf(__m128 t)
+{
+   __m128 lin = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(1.0f / (3.0f * d2))), _mm_set1_ps(s4over29));
+   return batch::Select(_mm_cmpgt_ps(t, _mm_set1_ps(d3)), batch::Cbrt(t), lin);
+}
+
+static inline __m128 LABfinv(__m128 t)
+{
+   __m128 lin = _mm_mul_ps(_mm_set1_ps(3.0f * d2), _mm_sub_ps(t, _mm_set1_ps(s4over29)));
+   return batch::Select(_mm_cmpgt_ps(t, _mm_set1_ps(d)), _mm_mul_ps(_mm_mul_ps(t, t), t), lin);
+}
+#endif
+
+class XYZtoLABKernel
+{
+public:
+   XYZtoLABKernel(const XYZ &W)
+   {
+      mIW[0] = 1.0f / W.x;
+      mIW[1] = 1.0f / W.y;
+      mIW[2] = 1.0f / W.z;
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 iwx = _mm_set1_ps(mIW[0]), iwy = _mm_set1_ps(mIW[1]), iwz = _mm_set1_ps(mIW[2]);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 fx = LABf(_mm_mul_ps(_mm_loadu_ps(in[0] + i), iwx));
+         __m128 fy = LABf(_mm_mul_ps(_mm_loadu_ps(in[1] + i), iwy));
+         __m128 fz = LABf(_mm_mul_ps(_mm_loadu_ps(in[2] + i), iwz));
+         _mm_storeu_ps(out[0] + i, _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.0f), fy), _mm_set1_ps(16.0f)));
+         _mm_storeu_ps(out[1] + i, _mm_mul_ps(_mm_set1_ps(500.0f), _mm_sub_ps(fx, fy)));
+         _mm_storeu_ps(out[2] + i, _mm_mul_ps(_mm_set1_ps(200.0f), _mm_sub_ps(fy, fz)));
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         float fx = LABf(in[0][i] * mIW[0]);
+         float fy = LABf(in[1][i] * mIW[1]);
+         float fz = LABf(in[2][i] * mIW[2]);
+         out[0][i] = 116.0f * fy - 16.0f;
+         out[1][i] = 500.0f * (fx - fy);
+         out[2][i] = 200.0f * (fy - fz);
+      }
+   }
+   
+private:
+   float mIW[3];
+};
+
+class LABtoXYZKernel
+{
+public:
+   LABtoXYZKernel(const XYZ &W)
+   {
+      mW[0] = W.x;
+      mW[1] = W.y;
+      mW[2] = W.z;
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 wx = _mm_set1_ps(mW[0]), wy = _mm_set1_ps(mW[1]), wz = _mm_set1_ps(mW[2]);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 fy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(in[0] + i), _mm_set1_ps(16.0f)), _mm_set1_ps(1.0f / 116.0f));
+         __m128 fx = _mm_add_ps(fy, _mm_mul_ps(_mm_loadu_ps(in[1] + i), _mm_set1_ps(1.0f / 500.0f)));
+         __m128 fz = _mm_sub_ps(fy, _mm_mul_ps(_mm_loadu_ps(in[2] + i), _mm_set1_ps(1.0f / 200.0f)));
+         _mm_storeu_ps(out[0] + i, _mm_mul_ps(wx, LABfinv(fx)));
+         _mm_storeu_ps(out[1] + i, _mm_mul_ps(wy, LABfinv(fy)));
+         _mm_storeu_ps(out[2] + i, _mm_mul_ps(wz, LABfinv(fz)));
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         float fy = (in[0][i] + 16.0f) * (1.0f / 116.0f);
+         float fx = fy + in[1][i] * (1.0f / 500.0f);
+         float fz = fy - in[2][i] * (1.0f / 200.0f);
+         out[0][i] = mW[0] * LABfinv(fx);
+         out[1][i] = mW[1] * LABfinv(fy);
+         out[2][i] = mW[2] * LABfinv(fz);
+      }
+   }
+   
+private:
+   float mW[3];
+};
+
+// ---
+
+class XYZtoLUVKernel
+{
+public:
+   XYZtoLUVKernel(const XYZ &W)
+   {
+      float den = W.x + 15.0f * W.y + 3.0f * W.z;
+      mUW = 4.0f * W.x / den;
+      mVW = 9.0f * W.y / den;
+      mIWy = 1.0f / W.y;
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 uw = _mm_set1_ps(mUW), vw = _mm_set1_ps(mVW), iwy = _mm_set1_ps(mIWy);
+      __m128 zero = _mm_setzero_ps();
+      for (; i+4<=count; i+=4)
+      {
+         __m128 X = _mm_loadu_ps(in[0] + i);
+         __m128 Y = _mm_loadu_ps(in[1] + i);
+         __m128 Z = _mm_loadu_ps(in[2] + i);
+         __m128 den = _mm_add_ps(_mm_add_ps(X, _mm_mul_ps(_mm_set1_ps(15.0f), Y)), _mm_mul_ps(_mm_set1_ps(3.0f), Z));
+         __m128 valid = _mm_cmpneq_ps(den, zero);
+         __m128 iden = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), den));
+         __m128 y = _mm_mul_ps(Y, iwy);
+         __m128 L = batch::Select(_mm_cmpgt_ps(y, _mm_set1_ps(d3)),
+                                  _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(116.0f), batch::Cbrt(y)), _mm_set1_ps(16.0f)),
+                                  _mm_mul_ps(_mm_set1_ps(s29over3c), y));
+         __m128 L13 = _mm_and_ps(valid, _mm_mul_ps(_mm_set1_ps(13.0f), L));
+         __m128 u = _mm_mul_ps(L13, _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(4.0f), X), iden), uw));
+         __m128 v = _mm_mul_ps(L13, _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(9.0f), Y), iden), vw));
+         _mm_storeu_ps(out[0] + i, L);
+         _mm_storeu_ps(out[1] + i, u);
+         _mm_storeu_ps(out[2] + i, v);
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         float X = in[0][i];
+         float Y = in[1][i];
+         float Z = in[2][i];
+         float den = X + 15.0f * Y + 3.0f * Z;
+         float y = Y * mIWy;
+         float L = (y > d3 ? 116.0f * batch::Cbrt(y) - 16.0f : s29over3c * y);
+         out[0][i] = L;
+         if (den != 0.0f)
+         {
+            float iden = 1.0f / den;
+            out[1][i] = 13.0f * L * (4.0f * X * iden - mUW);
+            out[2][i] = 13.0f * L * (9.0f * Y * iden - mVW);
+         }
+         else
+         {
+            out[1][i] = 0.0f;
+            out[2][i] = 0.0f;
+         }
+      }
+   }
+   
+private:
+   float mUW;
+   float mVW;
+   float mIWy;
+};
+
+class LUVtoXYZKernel
+{
+public:
+   LUVtoXYZKernel(const XYZ &W)
+   {
+      float den = W.x + 15.0f * W.y + 3.0f * W.z;
+      mUW = 4.0f * W.x / den;
+      mVW = 9.0f * W.y / den;
+      mWy = W.y;
+   }
+   
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 uw = _mm_set1_ps(mUW), vw = _mm_set1_ps(mVW), wy = _mm_set1_ps(mWy);
+      __m128 zero = _mm_setzero_ps();
+      for (; i+4<=count; i+=4)
+      {
+         __m128 L = _mm_loadu_ps(in[0] + i);
+         __m128 valid = _mm_cmpneq_ps(L, zero);
+         __m128 iL13 = _mm_div_ps(_mm_set1_ps(1.0f / 13.0f), L);
+         __m128 up = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in[1] + i), iL13), uw);
+         __m128 vp = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in[2] + i), iL13), vw);
+         __m128 t = _mm_mul_ps(_mm_add_ps(L, _mm_set1_ps(16.0f)), _mm_set1_ps(1.0f / 116.0f));
+         __m128 Y = batch::Select(_mm_cmpgt_ps(L, _mm_set1_ps(8.0f)),
+                                  _mm_mul_ps(_mm_mul_ps(t, t), t),
+                                  _mm_mul_ps(L, _mm_set1_ps(1.0f / s29over3c)));
+         Y = _mm_and_ps(valid, _mm_mul_ps(wy, Y));
+         __m128 Yi4v = _mm_and_ps(valid, _mm_div_ps(Y, _mm_mul_ps(_mm_set1_ps(4.0f), vp)));
+         __m128 X = _mm_mul_ps(Yi4v, _mm_mul_ps(_mm_set1_ps(9.0f), up));
+         __m128 Z = _mm_mul_ps(Yi4v, _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(12.0f), _mm_mul_ps(_mm_set1_ps(3.0f), up)),
+                                                 _mm_mul_ps(_mm_set1_ps(20.0f), vp)));
+         _mm_storeu_ps(out[0] + i, X);
+         _mm_storeu_ps(out[1] + i, Y);
+         _mm_storeu_ps(out[2] + i, Z);
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         float L = in[0][i];
+         if (L == 0.0f)
+         {
+            out[0][i] = 0.0f;
+            out[1][i] = 0.0f;
+            out[2][i] = 0.0f;
+            continue;
+         }
+         float iL13 = (1.0f / 13.0f) / L;
+         float up = in[1][i] * iL13 + mUW;
+         float vp = in[2][i] * iL13 + mVW;
+         float t = (L + 16.0f) * (1.0f / 116.0f);
+         float Y = mWy * (L > 8.0f ? t * t * t : L * (1.0f / s29over3c));
+         float Yi4v = Y / (4.0f * vp);
+         out[0][i] = Yi4v * 9.0f * up;
+         out[1][i] = Y;
+         out[2][i] = Yi4v * (12.0f - 3.0f * up - 20.0f * vp);
+      }
+   }
+   
+private:
+   float mUW;
+   float mVW;
+   float mWy;
+};
+
+bool ColorSpace::XYZtoLAB(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchRun(XYZtoLABKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels, stride);
+}
+
+bool ColorSpace::XYZtoLAB(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchRun(XYZtoLABKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels);
+}
+
+bool ColorSpace::LABtoXYZ(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchRun(LABtoXYZKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels, stride);
+}
+
+bool ColorSpace::LABtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchRun(LABtoXYZKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels);
+}
+
+bool ColorSpace::XYZtoLUV(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchRun(XYZtoLUVKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels, stride);
+}
+
+bool ColorSpace::XYZtoLUV(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchRun(XYZtoLUVKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels);
+}
+
+bool ColorSpace::LUVtoXYZ(const float *in, float *out, size_t npixels, size_t stride) const
+{
+   return BatchRun(LUVtoXYZKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels, stride);
+}
+
+bool ColorSpace::LUVtoXYZ(const float *const in[3], float *const out[3], size_t npixels) const
+{
+   return BatchRun(LUVtoXYZKernel(ChromaticityYtoXYZ(mWhite, 1.0f)), in, out, npixels);
+}
+
+// ---
+
+#ifdef GMATH_SSE2
+
+// Hue in [0, 1) from max channel, matching RGBtoHSV/RGBtoHSL (red first, then green)
+static inline __m128 Hue(__m128 R, __m128 G, __m128 B, __m128 M, __m128 C)
+{
+   __m128 iC = _mm_div_ps(_mm_set1_ps(1.0f), C);
+   __m128 hr = _mm_mul_ps(_mm_sub_ps(G, B), iC);
+   __m128 hg = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(B, R), iC), _mm_set1_ps(2.0f));
+   __m128 hb = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(R, G), iC), _mm_set1_ps(4.0f));
+   __m128 h = batch::Select(_mm_cmpeq_ps(M, R), hr, batch::Select(_mm_cmpeq_ps(M, G), hg, hb));
+   h = _mm_mul_ps(h, _mm_set1_ps(1.0f / 6.0f));
+   return _mm_add_ps(h, _mm_and_ps(_mm_cmplt_ps(h, _mm_setzero_ps()), _mm_set1_ps(1.0f)));
+}
+
+// RGB from hue and chroma, matching HSVtoRGB/HSLtoRGB (m added by the caller)
+static inline void HueChroma(__m128 H, __m128 C, __m128 &R, __m128 &G, __m128 &B)
+{
+   __m128 zero = _mm_setzero_ps();
+   __m128 h = _mm_mul_ps(H, _mm_set1_ps(6.0f));
+   // fmod(h, 2)
+   __m128 half = _mm_mul_ps(h, _mm_set1_ps(0.5f));
+   __m128 fm = _mm_sub_ps(h, _mm_mul_ps(_mm_set1_ps(2.0f), _mm_cvtepi32_ps(_mm_cvttps_epi32(half))));
+   __m128 ad = _mm_sub_ps(fm, _mm_set1_ps(1.0f));
+   ad = _mm_andnot_ps(_mm_set1_ps(-0.0f), ad);
+   __m128 X = _mm_mul_ps(C, _mm_sub_ps(_mm_set1_ps(1.0f), ad));
+   __m128 m1 = _mm_cmplt_ps(h, _mm_set1_ps(1.0f));
+   __m128 m2 = _mm_cmplt_ps(h, _mm_set1_ps(2.0f));
+   __m128 m3 = _mm_cmplt_ps(h, _mm_set1_ps(3.0f));
+   __m128 m4 = _mm_cmplt_ps(h, _mm_set1_ps(4.0f));
+   __m128 m5 = _mm_cmplt_ps(h, _mm_set1_ps(5.0f));
+   R = batch::Select(m1, C, batch::Select(m2, X, batch::Select(m4, zero, batch::Select(m5, X, C))));
+   G = batch::Select(m1, X, batch::Select(m3, C, batch::Select(m4, X, zero)));
+   B = batch::Select(m2, zero, batch::Select(m3, X, batch::Select(m5, C, X)));
+}
+
+#endif
+
+class RGBtoHSVKernel
+{
+public:
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 eps = _mm_set1_ps(EPS6);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 R = _mm_loadu_ps(in[0] + i);
+         __m128 G = _mm_loadu_ps(in[1] + i);
+         __m128 B = _mm_loadu_ps(in[2] + i);
+         __m128 M = _mm_max_ps(R, _mm_max_ps(G, B));
+         __m128 m = _mm_min_ps(R, _mm_min_ps(G, B));
+         __m128 C = _mm_sub_ps(M, m);
+         __m128 S = _mm_and_ps(_mm_cmpge_ps(M, eps), _mm_div_ps(C, M));
+         __m128 H = _mm_and_ps(_mm_cmpge_ps(S, eps), Hue(R, G, B, M, C));
+         _mm_storeu_ps(out[0] + i, H);
+         _mm_storeu_ps(out[1] + i, S);
+         _mm_storeu_ps(out[2] + i, M);
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         HSV hsv = RGBtoHSV(RGB(in[0][i], in[1][i], in[2][i]));
+         out[0][i] = hsv.h;
+         out[1][i] = hsv.s;
+         out[2][i] = hsv.v;
+      }
+   }
+};
+
+class HSVtoRGBKernel
+{
+public:
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      for (; i+4<=count; i+=4)
+      {
+         __m128 S = _mm_loadu_ps(in[1] + i);
+         __m128 V = _mm_loadu_ps(in[2] + i);
+         __m128 C = _mm_mul_ps(V, S);
+         __m128 m = _mm_sub_ps(V, C);
+         __m128 R, G, B;
+         HueChroma(_mm_loadu_ps(in[0] + i), C, R, G, B);
+         _mm_storeu_ps(out[0] + i, _mm_add_ps(R, m));
+         _mm_storeu_ps(out[1] + i, _mm_add_ps(G, m));
+         _mm_storeu_ps(out[2] + i, _mm_add_ps(B, m));
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         RGB rgb = HSVtoRGB(HSV(in[0][i], in[1][i], in[2][i]));
+         out[0][i] = rgb.r;
+         out[1][i] = rgb.g;
+         out[2][i] = rgb.b;
+      }
+   }
+};
+
+class RGBtoHSLKernel
+{
+public:
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 eps = _mm_set1_ps(EPS6);
+      __m128 half = _mm_set1_ps(0.5f);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 R = _mm_loadu_ps(in[0] + i);
+         __m128 G = _mm_loadu_ps(in[1] + i);
+         __m128 B = _mm_loadu_ps(in[2] + i);
+         __m128 M = _mm_max_ps(R, _mm_max_ps(G, B));
+         __m128 m = _mm_min_ps(R, _mm_min_ps(G, B));
+         __m128 C = _mm_sub_ps(M, m);
+         __m128 L = _mm_mul_ps(half, _mm_add_ps(m, M));
+         __m128 chromatic = _mm_cmpge_ps(C, eps);
+         __m128 den = batch::Select(_mm_cmple_ps(L, half), L, _mm_sub_ps(_mm_set1_ps(1.0f), L));
+         __m128 S = _mm_and_ps(chromatic, _mm_div_ps(C, _mm_add_ps(den, den)));
+         __m128 H = _mm_and_ps(chromatic, Hue(R, G, B, M, C));
+         _mm_storeu_ps(out[0] + i, H);
+         _mm_storeu_ps(out[1] + i, S);
+         _mm_storeu_ps(out[2] + i, L);
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         HSL hsl = RGBtoHSL(RGB(in[0][i], in[1][i], in[2][i]));
+         out[0][i] = hsl.h;
+         out[1][i] = hsl.s;
+         out[2][i] = hsl.l;
+      }
+   }
+};
+
+class HSLtoRGBKernel
+{
+public:
+   void operator()(const float *const in[3], float *const out[3], size_t count) const
+   {
+      size_t i = 0;
+#ifdef GMATH_SSE2
+      __m128 half = _mm_set1_ps(0.5f);
+      for (; i+4<=count; i+=4)
+      {
+         __m128 S = _mm_loadu_ps(in[1] + i);
+         __m128 L = _mm_loadu_ps(in[2] + i);
+         __m128 L2 = _mm_add_ps(L, L);
+         __m128 C = _mm_mul_ps(S, batch::Select(_mm_cmple_ps(L, half), L2, _mm_sub_ps(_mm_set1_ps(2.0f), L2)));
+         __m128 m = _mm_sub_ps(L, _mm_mul_ps(half, C));
+         __m128 R, G, B;
+         HueChroma(_mm_loadu_ps(in[0] + i), C, R, G, B);
+         _mm_storeu_ps(out[0] + i, _mm_add_ps(R, m));
+         _mm_storeu_ps(out[1] + i, _mm_add_ps(G, m));
+         _mm_storeu_ps(out[2] + i, _mm_add_ps(B, m));
+      }
+#endif
+      for (; i<count; ++i)
+      {
+         RGB rgb = HSLtoRGB(HSL(in[0][i], in[1][i], in[2][i]));
+         out[0][i] = rgb.r;
+         out[1][i] = rgb.g;
+         out[2][i] = rgb.b;
+      }
+   }
+};
+
+bool RGBtoHSV(const float *in, float *out, size_t npixels, size_t stride)
+{
+   return BatchRun(RGBtoHSVKernel(), in, out, npixels, stride);
+}
+
+bool RGBtoHSV(const float *const in[3], float *const out[3], size_t npixels)
+{
+   return BatchRun(RGBtoHSVKernel(), in, out, npixels);
+}
+
+bool HSVtoRGB(const float *in, float *out, size_t npixels, size_t stride)
+{
+   return BatchRun(HSVtoRGBKernel(), in, out, npixels, stride);
+}
+
+bool HSVtoRGB(const float *const in[3], float *const out[3], size_t npixels)
+{
+   return BatchRun(HSVtoRGBKernel(), in, out, npixels);
+}
+
+bool RGBtoHSL(const float *in, float *out, size_t npixels, size_t stride)
+{
+   return BatchRun(RGBtoHSLKernel(), in, out, npixels, stride);
+}
+
+bool RGBtoHSL(const float *const in[3], float *const out[3], size_t npixels)
+{
+   return BatchRun(RGBtoHSLKernel(), in, out, npixels);
+}
+
+bool HSLtoRGB(const float *in, float *out, size_t npixels, size_t stride)
+{
+   return BatchRun(HSLtoRGBKernel(), in, out, npixels, stride);
+}
+
+bool HSLtoRGB(const float *const in[3], float *const out[3], size_t npixels)
+{
+   return BatchRun(HSLtoRGBKernel(), in, out, npixels);
+}
+
+}
@@ -0,0 +1,845 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/quantizer.h>
+#include <gmath/parallel.h>
+#include "batch.h"
+#include <algorithm>
+#include <limits>
+
+namespace gmath
+{
+
+static const int HistogramBits = 5;
+static const size_t HistogramSize = size_t(1) << (3 * HistogramBits);
+static const size_t HistogramGrainSize = size_t(1) << 19;
+
+static const int TableBits = 6;
+static const size_t TableSize = size_t(1) << (3 * TableBits);
+
+static const size_t DiffusionBandRows = 32;
+
+static const unsigned char Bayer8[8][8] =
+{
+   { 0, 32,  8, 40,  2, 34, 10, 42},
+   {48, 16, 56, 24, 50, 18, 58, 26},
+   {12, 44,  4, 36, 14, 46,  6, 38},
+   {60, 28, 52, 20, 62, 30, 54, 22},
+   { 3, 35, 11, 43,  1, 33,  9, 41},
+   {51, 19, 59, 27, 49, 17, 57, 25},
+   {15, 47,  7, 39, 13, 45,  5, 37},
+   {63, 31, 55, 23, 61, 29, 53, 21}
+};
+
+// nan goes to 0
+static inline float Clamp01(float v)
+{
+   return (v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f);
+}
+
+// v in [0, 1]
+static inline unsigned int QuantizeUnit(float v, int bits)
+{
+   int n = 1 << bits;
+   int q = int(v * float(n));
+   return (unsigned int)(q < n ? q : n - 1);
+}
+
+static inline size_t TableCell(float r, float g, float b)
+{
+   return ((size_t)QuantizeUnit(r, TableBits) << (2 * TableBits)) |
+          ((size_t)QuantizeUnit(g, TableBits) << TableBits) |
+          (size_t)QuantizeUnit(b, TableBits);
+}
+
+// ---
+
+class HistogramTask
+{
+public:
+   HistogramTask(const batch::Pixels &px, std::vector<ColorQuantizer::Bin> *partials)
+      : mPx(px), mPartials(partials)
+   {
+   }
+   
+   static void Flush(ColorQuantizer::Bin &bin, double sum[3], unsigned int &count)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         bin.sum[c] += sum[c];
+         sum[c] = 0.0;
+      }
+      bin.count += count;
+      count = 0;
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      static const ColorQuantizer::Bin Empty = {{0.0, 0.0, 0.0}, 0};
+      
+      std::vector<ColorQuantizer::Bin> &bins = mPartials[begin / HistogramGrainSize];
+      bins.assign(HistogramSize, Empty);
+      
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      
+      // neighbouring pixels often fall in the same bin, sum them before touching it
+      size_t run = HistogramSize;
+      double sum[3] = {0.0, 0.0, 0.0};
+      unsigned int count = 0;
+      
+      for (size_t i=begin; i<end; i+=batch::BlockSize)
+      {
+         size_t n = std::min(batch::BlockSize, end - i);
+         
+         batch::Load(mPx, i, n, storage, soa);
+         
+         for (size_t j=0; j<n; ++j)
+         {
+            float r = Clamp01(soa[0][j]);
+            float g = Clamp01(soa[1][j]);
+            float b = Clamp01(soa[2][j]);
+            
+            size_t bin = (QuantizeUnit(r, HistogramBits) << (2 * HistogramBits)) |
+                         (QuantizeUnit(g, HistogramBits) << HistogramBits) |
+                         QuantizeUnit(b, HistogramBits);
+            
+            if (bin != run)
+            {
+               if (count > 0)
+               {
+                  Flush(bins[run], sum, count);
+               }
+               run = bin;
+            }
+            
+            sum[0] += r;
+            sum[1] += g;
+            sum[2] += b;
+            count += 1;
+         }
+      }
+      
+      if (count > 0)
+      {
+         Flush(bins[run], sum, count);
+      }
+   }
+   
+private:
+   batch::Pixels mPx;
+   std::vector<ColorQuantizer::Bin> *mPartials;
+};
+
+static void AccumulateHistogram(const batch::Pixels &px, size_t npixels, std::vector<ColorQuantizer::Bin> &histogram)
+{
+   std::vector< std::vector<ColorQuantizer::Bin> > partials(Parallel::ChunkCount(npixels, HistogramGrainSize));
+   
+   Parallel::For(npixels, HistogramGrainSize, HistogramTask(px, (partials.empty() ? 0 : &partials[0])));
+   
+   if (histogram.empty())
+   {
+      ColorQuantizer::Bin empty = {{0.0, 0.0, 0.0}, 0};
+      histogram.assign(HistogramSize, empty);
+   }
+   
+   // merge in chunk order so results don't depend on the thread count
+   for (size_t i=0; i<partials.size(); ++i)
+   {
+      const ColorQuantizer::Bin *src = &(partials[i][0]);
+      ColorQuantizer::Bin *dst = &histogram[0];
+      for (size_t j=0; j<HistogramSize; ++j)
+      {
+         if (src[j].count > 0)
+         {
+            dst[j].sum[0] += src[j].sum[0];
+            dst[j].sum[1] += src[j].sum[1];
+            dst[j].sum[2] += src[j].sum[2];
+            dst[j].count += src[j].count;
+         }
+      }
+   }
+}
+
+// ---
+
+// Median cut box over items [begin, end) of the permutation
+struct CutBox
+{
+   size_t begin;
+   size_t end;
+   int axis;
+   // count weighted sum of squared distances to the box mean
+   double error;
+};
+
+static void UpdateBox(CutBox &box, const std::vector<size_t> &order, const float *lab, const double *weights)
+{
+   double w = 0.0;
+   double s[3] = {0.0, 0.0, 0.0};
+   double s2[3] = {0.0, 0.0, 0.0};
+   
+   for (size_t i=box.begin; i<box.end; ++i)
+   {
+      const float *c = lab + 3 * order[i];
+      double wi = weights[order[i]];
+      w += wi;
+      for (int k=0; k<3; ++k)
+      {
+         s[k] += wi * c[k];
+         s2[k] += wi * c[k] * c[k];
+      }
+   }
+   
+   box.axis = 0;
+   box.error = 0.0;
+   
+   if (box.end - box.begin < 2)
+   {
+      return;
+   }
+   
+   double best = -1.0;
+   for (int k=0; k<3; ++k)
+   {
+      double var = std::max(0.0, s2[k] - s[k] * s[k] / w);
+      box.error += var;
+      if (var > best)
+      {
+         best = var;
+         box.axis = k;
+      }
+   }
+}
+
+class AxisLess
+{
+public:
+   AxisLess(const float *lab, int axis)
+      : mLab(lab), mAxis(axis)
+   {
+   }
+   
+   bool operator()(size_t i0, size_t i1) const
+   {
+      return mLab[3 * i0 + mAxis] < mLab[3 * i1 + mAxis];
+   }
+   
+private:
+   const float *mLab;
+   int mAxis;
+};
+
+// ---
+
+// Nearest center of each item by brute force (palettes are small), ties go to the lowest index
+class AssignTask
+{
+public:
+   // centers: 3 planes of count floats, padded to a multiple of 4 with far away values
+   AssignTask(const float *lab, const float *const centers[3], size_t count, unsigned int *assignment)
+      : mLab(lab), mCount(count), mAssignment(assignment)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         mCenters[c] = centers[c];
+      }
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         const float *p = mLab + 3 * i;
+         size_t j = 0;
+         float best = std::numeric_limits<float>::max();
+         unsigned int idx = 0;
+         
+#ifdef GMATH_SSE2
+         __m128 L = _mm_set1_ps(p[0]);
+         __m128 A = _mm_set1_ps(p[1]);
+         __m128 B = _mm_set1_ps(p[2]);
+         __m128 bestd = _mm_set1_ps(best);
+         __m128i besti = _mm_setzero_si128();
+         __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+         __m128i four = _mm_set1_epi32(4);
+         
+         for (; j+4<=mCount; j+=4)
+         {
+            __m128 dL = _mm_sub_ps(_mm_loadu_ps(mCenters[0] + j), L);
+            __m128 dA = _mm_sub_ps(_mm_loadu_ps(mCenters[1] + j), A);
+            __m128 dB = _mm_sub_ps(_mm_loadu_ps(mCenters[2] + j), B);
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dL, dL), _mm_mul_ps(dA, dA)), _mm_mul_ps(dB, dB));
+            __m128 closer = _mm_cmplt_ps(d, bestd);
+            bestd = _mm_min_ps(d, bestd);
+            besti = _mm_or_si128(_mm_and_si128(_mm_castps_si128(closer), lane), _mm_andnot_si128(_mm_castps_si128(closer), besti));
+            lane = _mm_add_epi32(lane, four);
+         }
+         
+         float ds[4];
+         unsigned int is[4];
+         _mm_storeu_ps(ds, bestd);
+         _mm_storeu_si128((__m128i*) is, besti);
+         for (int k=0; k<4; ++k)
+         {
+            if (ds[k] < best || (ds[k] == best && is[k] < idx))
+            {
+               best = ds[k];
+               idx = is[k];
+            }
+         }
+#endif
+         
+         for (; j<mCount; ++j)
+         {
+            float dL = mCenters[0][j] - p[0];
+            float dA = mCenters[1][j] - p[1];
+            float dB = mCenters[2][j] - p[2];
+            float d = dL * dL + dA * dA + dB * dB;
+            if (d < best)
+            {
+               best = d;
+               idx = (unsigned int) j;
+            }
+         }
+         
+         mAssignment[i] = idx;
+      }
+   }
+   
+private:
+   const float *mLab;
+   const float *mCenters[3];
+   size_t mCount;
+   unsigned int *mAssignment;
+};
+
+// ---
+
+template <class Pixels>
+class RemapTask
+{
+public:
+   RemapTask(const Pixels &px, size_t width, const unsigned char *table, float spread, unsigned char *indices)
+      : mPx(px), mWidth(width), mTable(table), mSpread(spread), mIndices(indices)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      
+      for (size_t i=begin; i<end; i+=batch::BlockSize)
+      {
+         size_t count = std::min(batch::BlockSize, end - i);
+         
+         batch::Load(mPx, i, count, storage, soa);
+         
+         if (mSpread > 0.0f)
+         {
+            size_t x = i % mWidth;
+            size_t y = i / mWidth;
+            
+            for (size_t j=0; j<count; ++j)
+            {
+               float offset = mSpread * ((float(Bayer8[y & 7][x & 7]) + 0.5f) / 64.0f - 0.5f);
+               mIndices[i + j] = mTable[TableCell(Clamp01(soa[0][j] + offset),
+                                                  Clamp01(soa[1][j] + offset),
+                                                  Clamp01(soa[2][j] + offset))];
+               if (++x == mWidth)
+               {
+                  x = 0;
+                  ++y;
+               }
+            }
+         }
+         else
+         {
+            for (size_t j=0; j<count; ++j)
+            {
+               mIndices[i + j] = mTable[TableCell(Clamp01(soa[0][j]), Clamp01(soa[1][j]), Clamp01(soa[2][j]))];
+            }
+         }
+      }
+   }
+   
+private:
+   Pixels mPx;
+   size_t mWidth;
+   const unsigned char *mTable;
+   float mSpread;
+   unsigned char *mIndices;
+};
+
+template <class Pixels>
+class DiffusionTask
+{
+public:
+   DiffusionTask(const Pixels &px, size_t width, size_t height, const unsigned char *table, const RGB *palette, unsigned char *indices)
+      : mPx(px), mWidth(width), mHeight(height), mTable(table), mPalette(palette), mIndices(indices)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      // row values, then current and next row errors with one pixel of padding on both sides
+      std::vector<float> row(3 * mWidth);
+      std::vector<float> errors(6 * (mWidth + 2));
+      float *plane[3] = {&row[0], &row[mWidth], &row[2 * mWidth]};
+      float storage[3 * batch::BlockSize];
+      float *soa[3];
+      
+      for (size_t band=begin; band<end; ++band)
+      {
+         size_t y0 = band * DiffusionBandRows;
+         size_t y1 = std::min(mHeight, y0 + DiffusionBandRows);
+         
+         std::fill(errors.begin(), errors.end(), 0.0f);
+         float *cur = &errors[0];
+         float *next = &errors[3 * (mWidth + 2)];
+         
+         for (size_t y=y0; y<y1; ++y)
+         {
+            size_t offset = y * mWidth;
+            
+            for (size_t x=0; x<mWidth; x+=batch::BlockSize)
+            {
+               size_t count = std::min(batch::BlockSize, mWidth - x);
+               batch::Load(mPx, offset + x, count, storage, soa);
+               for (int c=0; c<3; ++c)
+               {
+                  memcpy(plane[c] + x, soa[c], count * sizeof(float));
+               }
+            }
+            
+            // serpentine scan, error pixel x is at 3 * (x + 1)
+            bool forward = ((y - y0) % 2 == 0);
+            ptrdiff_t dir = (forward ? 3 : -3);
+            
+            for (size_t k=0; k<mWidth; ++k)
+            {
+               size_t x = (forward ? k : mWidth - 1 - k);
+               float *e = cur + 3 * (x + 1);
+               float *en = next + 3 * (x + 1);
+               
+               float r = Clamp01(plane[0][x] + e[0]);
+               float g = Clamp01(plane[1][x] + e[1]);
+               float b = Clamp01(plane[2][x] + e[2]);
+               
+               unsigned char idx = mTable[TableCell(r, g, b)];
+               mIndices[offset + x] = idx;
+               
+               const RGB &p = mPalette[idx];
+               float d[3] = {r - p.r, g - p.g, b - p.b};
+               
+               for (int c=0; c<3; ++c)
+               {
+                  e[dir + c] += d[c] * (7.0f / 16.0f);
+                  en[c - dir] += d[c] * (3.0f / 16.0f);
+                  en[c] += d[c] * (5.0f / 16.0f);
+                  en[c + dir] += d[c] * (1.0f / 16.0f);
+               }
+            }
+            
+            std::swap(cur, next);
+            std::fill(next, next + 3 * (mWidth + 2), 0.0f);
+         }
+      }
+   }
+   
+private:
+   Pixels mPx;
+   size_t mWidth;
+   size_t mHeight;
+   const unsigned char *mTable;
+   const RGB *mPalette;
+   unsigned char *mIndices;
+};
+
+// ---
+
+const size_t ColorQuantizer::MaxColors;
+
+ColorQuantizer::ColorQuantizer(const ColorSpace &cs, Gamma::Function gf)
+   : mColorSpace(cs)
+   , mGamma(gf)
+   , mPixelCount(0)
+{
+}
+
+ColorQuantizer::~ColorQuantizer()
+{
+}
+
+void ColorQuantizer::clear()
+{
+   clearHistogram();
+   mPalette.clear();
+   mIndex.clear();
+   mTable.clear();
+}
+
+void ColorQuantizer::clearHistogram()
+{
+   mHistogram.clear();
+   mPixelCount = 0;
+}
+
+void ColorQuantizer::toLAB(const float *rgb, float *lab, size_t n) const
+{
+   Gamma::Linearize(rgb, lab, 3 * n, mGamma);
+   mColorSpace.RGBtoXYZ(lab, lab, n);
+   mColorSpace.XYZtoLAB(lab, lab, n);
+}
+
+bool ColorQuantizer::addPixels(const float *rgb, size_t npixels, size_t stride)
+{
+   if (!rgb || stride < 3)
+   {
+      return false;
+   }
+   AccumulateHistogram(batch::Interleaved(rgb, stride), npixels, mHistogram);
+   mPixelCount += npixels;
+   return true;
+}
+
+bool ColorQuantizer::addPixels(const float *const rgb[3], size_t npixels)
+{
+   if (!rgb || !rgb[0] || !rgb[1] || !rgb[2])
+   {
+      return false;
+   }
+   AccumulateHistogram(batch::Planar(rgb), npixels, mHistogram);
+   mPixelCount += npixels;
+   return true;
+}
+
+size_t ColorQuantizer::getPixelCount() const
+{
+   return mPixelCount;
+}
+
+size_t ColorQuantizer::getHistogramColorCount() const
+{
+   size_t n = 0;
+   for (size_t i=0; i<mHistogram.size(); ++i)
+   {
+      n += (mHistogram[i].count > 0 ? 1 : 0);
+   }
+   return n;
+}
+
+bool ColorQuantizer::buildPalette(size_t ncolors, Method method, int iterations)
+{
+   if (ncolors == 0 || ncolors > MaxColors || mPixelCount == 0)
+   {
+      return false;
+   }
+   
+   // Non-empty bins: mean RGB, LAB and pixel count
+   std::vector<float> rgb;
+   std::vector<double> weights;
+   
+   for (size_t i=0; i<mHistogram.size(); ++i)
+   {
+      const Bin &bin = mHistogram[i];
+      if (bin.count > 0)
+      {
+         for (int c=0; c<3; ++c)
+         {
+            rgb.push_back(float(bin.sum[c] / bin.count));
+         }
+         weights.push_back(double(bin.count));
+      }
+   }
+   
+   size_t n = weights.size();
+   
+   std::vector<float> lab(3 * n);
+   toLAB(&rgb[0], &lab[0], n);
+   
+   // Median cut
+   std::vector<size_t> order(n);
+   for (size_t i=0; i<n; ++i)
+   {
+      order[i] = i;
+   }
+   
+   std::vector<CutBox> boxes(1);
+   boxes[0].begin = 0;
+   boxes[0].end = n;
+   UpdateBox(boxes[0], order, &lab[0], &weights[0]);
+   
+   while (boxes.size() < ncolors)
+   {
+      size_t best = 0;
+      for (size_t i=1; i<boxes.size(); ++i)
+      {
+         if (boxes[i].error > boxes[best].error)
+         {
+            best = i;
+         }
+      }
+      
+      CutBox box = boxes[best];
+      if (box.error <= 0.0)
+      {
+         break;
+      }
+      
+      std::sort(order.begin() + box.begin, order.begin() + box.end, AxisLess(&lab[0], box.axis));
+      
+      double total = 0.0;
+      for (size_t i=box.begin; i<box.end; ++i)
+      {
+         total += weights[order[i]];
+      }
+      
+      // first item past the weighted median, keeping both halves non-empty
+      size_t split = box.begin + 1;
+      double acc = weights[order[box.begin]];
+      while (split < box.end - 1 && acc < 0.5 * total)
+      {
+         acc += weights[order[split]];
+         ++split;
+      }
+      
+      CutBox upper = box;
+      box.end = split;
+      upper.begin = split;
+      UpdateBox(box, order, &lab[0], &weights[0]);
+      UpdateBox(upper, order, &lab[0], &weights[0]);
+      boxes[best] = box;
+      boxes.push_back(upper);
+   }
+   
+   size_t k = boxes.size();
+   
+   std::vector<unsigned int> assignment(n);
+   for (size_t b=0; b<k; ++b)
+   {
+      for (size_t i=boxes[b].begin; i<boxes[b].end; ++i)
+      {
+         assignment[order[i]] = (unsigned int) b;
+      }
+   }
+   
+   // K-means refinement
+   if (method == KMeans && k > 1)
+   {
+      size_t padded = (k + 3) & ~size_t(3);
+      std::vector<double> sums(4 * k);
+      // planar, padding never gets picked
+      std::vector<float> centers(3 * padded, 1e18f);
+      const float *planes[3] = {&centers[0], &centers[padded], &centers[2 * padded]};
+      std::vector<unsigned int> nearest(n);
+      
+      for (int it=0; it<=iterations; ++it)
+      {
+         std::fill(sums.begin(), sums.end(), 0.0);
+         for (size_t i=0; i<n; ++i)
+         {
+            double *s = &sums[4 * assignment[i]];
+            s[0] += weights[i] * lab[3 * i + 0];
+            s[1] += weights[i] * lab[3 * i + 1];
+            s[2] += weights[i] * lab[3 * i + 2];
+            s[3] += weights[i];
+         }
+         for (size_t c=0; c<k; ++c)
+         {
+            const double *s = &sums[4 * c];
+            // empty clusters keep their previous center
+            if (s[3] > 0.0)
+            {
+               centers[c] = float(s[0] / s[3]);
+               centers[padded + c] = float(s[1] / s[3]);
+               centers[2 * padded + c] = float(s[2] / s[3]);
+            }
+         }
+         
+         if (it == iterations)
+         {
+            break;
+         }
+         
+         Parallel::For(n, 256, AssignTask(&lab[0], planes, padded, &nearest[0]));
+         
+         if (nearest == assignment)
+         {
+            break;
+         }
+         assignment.swap(nearest);
+      }
+   }
+   
+   // Palette colors: RGB means of their bins
+   std::vector<double> sums(4 * k, 0.0);
+   size_t j = 0;
+   for (size_t i=0; i<mHistogram.size(); ++i)
+   {
+      const Bin &bin = mHistogram[i];
+      if (bin.count > 0)
+      {
+         double *s = &sums[4 * assignment[j++]];
+         s[0] += bin.sum[0];
+         s[1] += bin.sum[1];
+         s[2] += bin.sum[2];
+         s[3] += bin.count;
+      }
+   }
+   
+   mPalette.clear();
+   for (size_t c=0; c<k; ++c)
+   {
+      const double *s = &sums[4 * c];
+      if (s[3] > 0.0)
+      {
+         mPalette.push_back(RGB(float(s[0] / s[3]), float(s[1] / s[3]), float(s[2] / s[3])));
+      }
+   }
+   
+   updatePalette();
+   
+   return true;
+}
+
+bool ColorQuantizer::setPalette(const RGB *palette, size_t n)
+{
+   if (!palette || n == 0 || n > MaxColors)
+   {
+      return false;
+   }
+   
+   mPalette.resize(n);
+   for (size_t i=0; i<n; ++i)
+   {
+      mPalette[i] = RGB(Clamp01(palette[i].r), Clamp01(palette[i].g), Clamp01(palette[i].b));
+   }
+   
+   updatePalette();
+   
+   return true;
+}
+
+void ColorQuantizer::updatePalette()
+{
+   size_t n = mPalette.size();
+   
+   std::vector<float> lab(3 * n);
+   toLAB(&(mPalette[0].r), &lab[0], n);
+   mIndex.build(&lab[0], n);
+   
+   // Nearest palette color for every table cell center
+   size_t cells = size_t(1) << TableBits;
+   std::vector<float> centers(3 * TableSize);
+   for (size_t i=0; i<TableSize; ++i)
+   {
+      centers[3 * i + 0] = (float((i >> (2 * TableBits)) & (cells - 1)) + 0.5f) / float(cells);
+      centers[3 * i + 1] = (float((i >> TableBits) & (cells - 1)) + 0.5f) / float(cells);
+      centers[3 * i + 2] = (float(i & (cells - 1)) + 0.5f) / float(cells);
+   }
+   toLAB(&centers[0], &centers[0], TableSize);
+   
+   std::vector<unsigned int> indices(TableSize);
+   mIndex.nearest(&centers[0], TableSize, &indices[0]);
+   
+   mTable.resize(TableSize);
+   for (size_t i=0; i<TableSize; ++i)
+   {
+      mTable[i] = (unsigned char) indices[i];
+   }
+}
+
+size_t ColorQuantizer::getColorCount() const
+{
+   return mPalette.size();
+}
+
+RGB ColorQuantizer::getColor(size_t i) const
+{
+   return mPalette[i];
+}
+
+LAB ColorQuantizer::getColorLAB(size_t i) const
+{
+   return mIndex.getColor(i);
+}
+
+size_t ColorQuantizer::nearest(const RGB &rgb) const
+{
+   RGB c(Clamp01(rgb.r), Clamp01(rgb.g), Clamp01(rgb.b));
+   LAB lab = mColorSpace.XYZtoLAB(mColorSpace.RGBtoXYZ(Gamma::Linearize(c, mGamma)));
+   return mIndex.nearest(lab);
+}
+
+template <class Pixels>
+bool ColorQuantizer::remapPixels(const Pixels &px, size_t width, size_t height, unsigned char *indices, Dither dither) const
+{
+   if (!indices || mPalette.empty())
+   {
+      return false;
+   }
+   
+   if (width == 0 || height == 0)
+   {
+      return true;
+   }
+   
+   if (dither == FloydSteinberg)
+   {
+      size_t bands = (height + DiffusionBandRows - 1) / DiffusionBandRows;
+      Parallel::For(bands, 1, DiffusionTask<Pixels>(px, width, height, &mTable[0], &mPalette[0], indices));
+   }
+   else
+   {
+      // about the distance between palette colors along one channel
+      float spread = (dither == Ordered ? 1.0f / cbrtf(float(mPalette.size())) : 0.0f);
+      Parallel::For(width * height, batch::ChunkSize, RemapTask<Pixels>(px, width, &mTable[0], spread, indices));
+   }
+   
+   return true;
+}
+
+bool ColorQuantizer::remap(const float *rgb, size_t width, size_t height, unsigned char *indices, Dither dither, size_t stride) const
+{
+   if (!rgb || stride < 3)
+   {
+      return false;
+   }
+   return remapPixels(batch::Interleaved(rgb, stride), width, height, indices, dither);
+}
+
+bool ColorQuantizer::remap(const float *const rgb[3], size_t width, size_t height, unsigned char *indices, Dither dither) const
+{
+   if (!rgb || !rgb[0] || !rgb[1] || !rgb[2])
+   {
+      return false;
+   }
+   return remapPixels(batch::Planar(rgb), width, height, indices, dither);
+}
+
+}
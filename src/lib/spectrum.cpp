@@ -0,0 +1,488 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/spectrum.h>
+#include <gmath/parallel.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+// Smits basis spectra, 10 bins uniformly spaced over [380, 720]
+static const float SmitsSpectra[7][10] =
+{
+   {1.0000f, 1.0000f, 0.9999f, 0.9993f, 0.9992f, 0.9998f, 1.0000f, 1.0000f, 1.0000f, 1.0000f}, // white
+   {0.9710f, 0.9426f, 1.0007f, 1.0007f, 1.0007f, 1.0007f, 0.1564f, 0.0000f, 0.0000f, 0.0000f}, // cyan
+   {1.0000f, 1.0000f, 0.9685f, 0.2229f, 0.0000f, 0.0458f, 0.8369f, 1.0000f, 1.0000f, 0.9959f}, // magenta
+   {0.0001f, 0.0000f, 0.1088f, 0.6651f, 1.0000f, 1.0000f, 0.9996f, 0.9586f, 0.9685f, 0.9840f}, // yellow
+   {0.1012f, 0.0515f, 0.0000f, 0.0000f, 0.0000f, 0.0000f, 0.8325f, 1.0149f, 1.0149f, 1.0149f}, // red
+   {0.0000f, 0.0000f, 0.0273f, 0.7937f, 1.0000f, 0.9418f, 0.1719f, 0.0000f, 0.0000f, 0.0025f}, // green
+   {1.0000f, 1.0000f, 0.8916f, 0.3323f, 0.0000f, 0.0000f, 0.0003f, 0.0369f, 0.0483f, 0.0496f}  // blue
+};
+
+enum Basis
+{
+   White = 0,
+   Cyan,
+   Magenta,
+   Yellow,
+   Red,
+   Green,
+   Blue
+};
+
+// Standard observer channel c at lambda, linear between the 5nm entries, 0 outside [380, 780]
+static double Observer(const float stdobs[81][3], int c, double lambda)
+{
+   if (lambda < 380.0 || lambda > 780.0)
+   {
+      return 0.0;
+   }
+   double t = (lambda - 380.0) / 5.0;
+   int i = std::min(79, int(t));
+   double f = t - double(i);
+   return (1.0 - f) * stdobs[i][c] + f * stdobs[i + 1][c];
+}
+
+static float Smits(int basis, float lambda)
+{
+   float t = (lambda - 380.0f) * (9.0f / 340.0f);
+   if (t <= 0.0f)
+   {
+      return SmitsSpectra[basis][0];
+   }
+   if (t >= 9.0f)
+   {
+      return SmitsSpectra[basis][9];
+   }
+   int i = std::min(8, int(t));
+   float f = t - float(i);
+   return (1.0f - f) * SmitsSpectra[basis][i] + f * SmitsSpectra[basis][i + 1];
+}
+
+// ---
+
+SpectralProjection::SpectralProjection()
+   : mCount(0)
+   , mPadded(0)
+{
+}
+
+SpectralProjection::~SpectralProjection()
+{
+}
+
+void SpectralProjection::clear()
+{
+   mCount = 0;
+   mPadded = 0;
+   mWavelengths.clear();
+   mData.clear();
+}
+
+bool SpectralProjection::setup(size_t nsamples, float lambdaMin, float lambdaMax, const ColorSpace *cs, bool normalize, const float stdobs[81][3])
+{
+   if (nsamples < 2 || !(lambdaMax > lambdaMin))
+   {
+      return false;
+   }
+   
+   std::vector<float> wavelengths(nsamples);
+   for (size_t i=0; i<nsamples; ++i)
+   {
+      wavelengths[i] = lambdaMin + (lambdaMax - lambdaMin) * float(i) / float(nsamples - 1);
+   }
+   return setup(&wavelengths[0], nsamples, cs, normalize, stdobs);
+}
+
+bool SpectralProjection::setup(const float *wavelengths, size_t nsamples, const ColorSpace *cs, bool normalize, const float stdobs[81][3])
+{
+   if (!wavelengths || nsamples < 2)
+   {
+      return false;
+   }
+   for (size_t i=1; i<nsamples; ++i)
+   {
+      if (!(wavelengths[i] > wavelengths[i - 1]))
+      {
+         return false;
+      }
+   }
+   
+   if (stdobs == 0)
+   {
+      stdobs = StandardObserver::CIE1931;
+   }
+   
+   // Integrate each interval piece by piece, split at the observer entries: the product
+   // of the sample hat functions and the observer is quadratic on each piece, Simpson's
+   // rule is exact
+   std::vector<double> weights(3 * nsamples, 0.0);
+   std::vector<double> cuts;
+   
+   for (size_t k=0; k+1<nsamples; ++k)
+   {
+      double w0 = wavelengths[k];
+      double w1 = wavelengths[k + 1];
+      double a = std::max(w0, 380.0);
+      double b = std::min(w1, 780.0);
+      if (a >= b)
+      {
+         continue;
+      }
+      
+      cuts.clear();
+      cuts.push_back(a);
+      for (int j=int(ceil((a - 380.0) / 5.0)); j<=80; ++j)
+      {
+         double lambda = 380.0 + 5.0 * j;
+         if (lambda >= b)
+         {
+            break;
+         }
+         if (lambda > a)
+         {
+            cuts.push_back(lambda);
+         }
+      }
+      cuts.push_back(b);
+      
+      double ih = 1.0 / (w1 - w0);
+      
+      for (size_t p=0; p+1<cuts.size(); ++p)
+      {
+         double x[3] = {cuts[p], 0.5 * (cuts[p] + cuts[p + 1]), cuts[p + 1]};
+         double s[3] = {1.0, 4.0, 1.0};
+         double len = (cuts[p + 1] - cuts[p]) / 6.0;
+         
+         for (int q=0; q<3; ++q)
+         {
+            double h1 = (x[q] - w0) * ih;
+            double h0 = 1.0 - h1;
+            for (int c=0; c<3; ++c)
+            {
+               double o = len * s[q] * Observer(stdobs, c, x[q]);
+               weights[3 * k + c] += h0 * o;
+               weights[3 * (k + 1) + c] += h1 * o;
+            }
+         }
+      }
+   }
+   
+   // nm to m
+   double scale = 1e-9;
+   
+   if (normalize)
+   {
+      double Y = 0.0;
+      for (size_t i=0; i<nsamples; ++i)
+      {
+         Y += weights[3 * i + 1];
+      }
+      if (Y <= 0.0)
+      {
+         return false;
+      }
+      scale = 1.0 / Y;
+   }
+   
+   Matrix3 M;
+   if (cs)
+   {
+      M = cs->getXYZtoRGBMatrix();
+      if (normalize)
+      {
+         XYZ E(1.0f, 1.0f, 1.0f);
+         M = M * ChromaticAdaptationMatrix(E, ChromaticityYtoXYZ(cs->getWhitePoint(), 1.0f), CAT_VonKries);
+      }
+   }
+   
+   mCount = nsamples;
+   mPadded = (nsamples + 3) & ~size_t(3);
+   mWavelengths.assign(wavelengths, wavelengths + nsamples);
+   mData.assign(10 * mPadded, 0.0f);
+   
+   for (size_t i=0; i<nsamples; ++i)
+   {
+      double w[3] = {weights[3 * i] * scale, weights[3 * i + 1] * scale, weights[3 * i + 2] * scale};
+      for (int c=0; c<3; ++c)
+      {
+         mData[c * mPadded + i] = float(cs ? M(c, 0) * w[0] + M(c, 1) * w[1] + M(c, 2) * w[2] : w[c]);
+      }
+      for (int j=0; j<7; ++j)
+      {
+         mData[(3 + j) * mPadded + i] = Smits(j, wavelengths[i]);
+      }
+   }
+   
+   return true;
+}
+
+size_t SpectralProjection::getSampleCount() const
+{
+   return mCount;
+}
+
+float SpectralProjection::getWavelength(size_t i) const
+{
+   return (i < mCount ? mWavelengths[i] : 0.0f);
+}
+
+float SpectralProjection::getWeight(size_t i, int c) const
+{
+   return (i < mCount && c >= 0 && c < 3 ? mData[c * mPadded + i] : 0.0f);
+}
+
+// ---
+
+static void Project(const float *w, size_t padded, size_t n, const float *spectrum, float *out)
+{
+   const float *w0 = w;
+   const float *w1 = w + padded;
+   const float *w2 = w + 2 * padded;
+   
+   size_t i = 0;
+   float o0 = 0.0f, o1 = 0.0f, o2 = 0.0f;
+   
+#ifdef GMATH_SSE2
+   __m128 a0 = _mm_setzero_ps();
+   __m128 a1 = _mm_setzero_ps();
+   __m128 a2 = _mm_setzero_ps();
+   
+   for (; i+4<=n; i+=4)
+   {
+      __m128 s = _mm_loadu_ps(spectrum + i);
+      a0 = _mm_add_ps(a0, _mm_mul_ps(s, _mm_loadu_ps(w0 + i)));
+      a1 = _mm_add_ps(a1, _mm_mul_ps(s, _mm_loadu_ps(w1 + i)));
+      a2 = _mm_add_ps(a2, _mm_mul_ps(s, _mm_loadu_ps(w2 + i)));
+   }
+   
+   // transpose and add: lanes of the result are the 3 sums
+   __m128 t0 = _mm_unpacklo_ps(a0, a1);
+   __m128 t1 = _mm_unpackhi_ps(a0, a1);
+   __m128 t2 = _mm_unpacklo_ps(a2, _mm_setzero_ps());
+   __m128 t3 = _mm_unpackhi_ps(a2, _mm_setzero_ps());
+   __m128 sum = _mm_add_ps(_mm_add_ps(_mm_movelh_ps(t0, t2), _mm_movehl_ps(t2, t0)),
+                           _mm_add_ps(_mm_movelh_ps(t1, t3), _mm_movehl_ps(t3, t1)));
+   float tmp[4];
+   _mm_storeu_ps(tmp, sum);
+   o0 = tmp[0];
+   o1 = tmp[1];
+   o2 = tmp[2];
+#endif
+   
+   for (; i<n; ++i)
+   {
+      o0 += spectrum[i] * w0[i];
+      o1 += spectrum[i] * w1[i];
+      o2 += spectrum[i] * w2[i];
+   }
+   
+   out[0] = o0;
+   out[1] = o1;
+   out[2] = o2;
+}
+
+// spectrum = k0 * b0 + k1 * b1 + k2 * b2
+static void Combine(const float *b0, float k0, const float *b1, float k1, const float *b2, float k2, size_t n, float *spectrum)
+{
+   size_t i = 0;
+   
+#ifdef GMATH_SSE2
+   __m128 K0 = _mm_set1_ps(k0);
+   __m128 K1 = _mm_set1_ps(k1);
+   __m128 K2 = _mm_set1_ps(k2);
+   
+   for (; i+4<=n; i+=4)
+   {
+      __m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(K0, _mm_loadu_ps(b0 + i)),
+                                       _mm_mul_ps(K1, _mm_loadu_ps(b1 + i))),
+                            _mm_mul_ps(K2, _mm_loadu_ps(b2 + i)));
+      _mm_storeu_ps(spectrum + i, s);
+   }
+#endif
+   
+   for (; i<n; ++i)
+   {
+      spectrum[i] = k0 * b0[i] + k1 * b1[i] + k2 * b2[i];
+   }
+}
+
+static void Upsample(const float *basis, size_t padded, size_t n, float r, float g, float b, float *spectrum)
+{
+   #define BASIS(name) (basis + name * padded)
+   
+   if (r <= g && r <= b)
+   {
+      if (g <= b)
+      {
+         Combine(BASIS(White), r, BASIS(Cyan), g - r, BASIS(Blue), b - g, n, spectrum);
+      }
+      else
+      {
+         Combine(BASIS(White), r, BASIS(Cyan), b - r, BASIS(Green), g - b, n, spectrum);
+      }
+   }
+   else if (g <= r && g <= b)
+   {
+      if (r <= b)
+      {
+         Combine(BASIS(White), g, BASIS(Magenta), r - g, BASIS(Blue), b - r, n, spectrum);
+      }
+      else
+      {
+         Combine(BASIS(White), g, BASIS(Magenta), b - g, BASIS(Red), r - b, n, spectrum);
+      }
+   }
+   else
+   {
+      if (r <= g)
+      {
+         Combine(BASIS(White), b, BASIS(Yellow), r - b, BASIS(Green), g - r, n, spectrum);
+      }
+      else
+      {
+         Combine(BASIS(White), b, BASIS(Yellow), g - b, BASIS(Red), r - g, n, spectrum);
+      }
+   }
+   
+   #undef BASIS
+}
+
+class ProjectTask
+{
+public:
+   ProjectTask(const float *w, size_t padded, size_t n, const float *spectra, size_t sstride, float *out, size_t ostride)
+      : mW(w), mPadded(padded), mN(n), mSpectra(spectra), mSStride(sstride), mOut(out), mOStride(ostride)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         Project(mW, mPadded, mN, mSpectra + i * mSStride, mOut + i * mOStride);
+      }
+   }
+   
+private:
+   const float *mW;
+   size_t mPadded;
+   size_t mN;
+   const float *mSpectra;
+   size_t mSStride;
+   float *mOut;
+   size_t mOStride;
+};
+
+class UpsampleTask
+{
+public:
+   UpsampleTask(const float *basis, size_t padded, size_t n, const float *rgb, size_t rstride, float *spectra, size_t sstride)
+      : mBasis(basis), mPadded(padded), mN(n), mRGB(rgb), mRStride(rstride), mSpectra(spectra), mSStride(sstride)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         const float *c = mRGB + i * mRStride;
+         Upsample(mBasis, mPadded, mN, c[0], c[1], c[2], mSpectra + i * mSStride);
+      }
+   }
+   
+private:
+   const float *mBasis;
+   size_t mPadded;
+   size_t mN;
+   const float *mRGB;
+   size_t mRStride;
+   float *mSpectra;
+   size_t mSStride;
+};
+
+// Spectra per parallel chunk, about the work of ChunkSize pixels of a matrix transform
+static size_t SpectrumGrain(size_t nsamples)
+{
+   return std::max<size_t>(1, (3 * batch::ChunkSize) / nsamples);
+}
+
+void SpectralProjection::operator()(const float *spectrum, float out[3]) const
+{
+   if (mCount == 0)
+   {
+      out[0] = out[1] = out[2] = 0.0f;
+      return;
+   }
+   Project(&mData[0], mPadded, mCount, spectrum, out);
+}
+
+bool SpectralProjection::apply(const float *spectra, float *out, size_t nspectra, size_t spectrumStride, size_t outStride) const
+{
+   if (mCount == 0 || !spectra || !out || outStride < 3)
+   {
+      return false;
+   }
+   if (spectrumStride == 0)
+   {
+      spectrumStride = mCount;
+   }
+   else if (spectrumStride < mCount)
+   {
+      return false;
+   }
+   Parallel::For(nspectra, SpectrumGrain(mCount), ProjectTask(&mData[0], mPadded, mCount, spectra, spectrumStride, out, outStride));
+   return true;
+}
+
+void SpectralProjection::upsample(const RGB &rgb, float *spectrum) const
+{
+   if (mCount > 0)
+   {
+      Upsample(&mData[3 * mPadded], mPadded, mCount, rgb.r, rgb.g, rgb.b, spectrum);
+   }
+}
+
+bool SpectralProjection::upsample(const float *rgb, float *spectra, size_t n, size_t rgbStride, size_t spectrumStride) const
+{
+   if (mCount == 0 || !rgb || !spectra || rgbStride < 3)
+   {
+      return false;
+   }
+   if (spectrumStride == 0)
+   {
+      spectrumStride = mCount;
+   }
+   else if (spectrumStride < mCount)
+   {
+      return false;
+   }
+   Parallel::For(n, SpectrumGrain(mCount), UpsampleTask(&mData[3 * mPadded], mPadded, mCount, rgb, rgbStride, spectra, spectrumStride));
+   return true;
+}
+
+}
@@ -0,0 +1,356 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include "batch.h"
+
+namespace gmath
+{
+
+// Rows processed per parallel chunk for an image of the given width
+static size_t RowGrain(size_t width)
+{
+   return std::max<size_t>(1, batch::ChunkSize / std::max<size_t>(1, width));
+}
+
+// L = max(0, k * lum . rgb)
+class LuminanceTask
+{
+public:
+   LuminanceTask(const batch::Pixels &px, const float lum[3], float k, size_t width, float *L)
+      : mPx(px), mLum(lum), mK(k), mWidth(width), mL(L)
+   {
+   }
+   
+   void operator()(size_t y0, size_t y1) const
+   {
+      const float *r = mPx.ch[0];
+      const float *g = mPx.ch[1];
+      const float *b = mPx.ch[2];
+      
+      for (size_t i=y0*mWidth, o=y0*mWidth*mPx.stride; i<y1*mWidth; ++i, o+=mPx.stride)
+      {
+         float l = mK * (mLum[0] * r[o] + mLum[1] * g[o] + mLum[2] * b[o]);
+         mL[i] = (l > 0.0f ? l : 0.0f);
+      }
+   }
+   
+private:
+   batch::Pixels mPx;
+   const float *mLum;
+   float mK;
+   size_t mWidth;
+   float *mL;
+};
+
+// Separable gaussian blur, edges clamped
+class GaussianBlur
+{
+public:
+   GaussianBlur(float sigma)
+   {
+      int r = std::max(1, int(ceilf(3.0f * sigma)));
+      float sum = 0.0f;
+      mWeights.resize(2 * r + 1);
+      for (int i=-r; i<=r; ++i)
+      {
+         float w = expf(-0.5f * float(i * i) / (sigma * sigma));
+         mWeights[i + r] = w;
+         sum += w;
+      }
+      for (size_t i=0; i<mWeights.size(); ++i)
+      {
+         mWeights[i] /= sum;
+      }
+      mRadius = size_t(r);
+   }
+   
+   // out may not alias in, tmp is width * height floats
+   void operator()(const float *in, float *out, float *tmp, size_t width, size_t height) const
+   {
+      Parallel::For(height, RowGrain(width), RowsTask(*this, in, tmp, width));
+      Parallel::For(height, RowGrain(width), ColumnsTask(*this, tmp, out, width, height));
+   }
+   
+private:
+   class RowsTask
+   {
+   public:
+      RowsTask(const GaussianBlur &blur, const float *in, float *out, size_t width)
+         : mBlur(blur), mIn(in), mOut(out), mWidth(width)
+      {
+      }
+      
+      void operator()(size_t y0, size_t y1) const
+      {
+         size_t r = mBlur.mRadius;
+         const float *w = &(mBlur.mWeights[0]);
+         std::vector<float> line(mWidth + 2 * r);
+         
+         for (size_t y=y0; y<y1; ++y)
+         {
+            const float *src = mIn + y * mWidth;
+            float *dst = mOut + y * mWidth;
+            
+            for (size_t x=0; x<r; ++x)
+            {
+               line[x] = src[0];
+               line[r + mWidth + x] = src[mWidth - 1];
+            }
+            memcpy(&line[r], src, mWidth * sizeof(float));
+            
+            const float *l = &line[0];
+            
+            for (size_t x=0; x<mWidth; ++x)
+            {
+               dst[x] = w[0] * l[x];
+            }
+            for (size_t k=1; k<=2*r; ++k)
+            {
+               float wk = w[k];
+               const float *lk = l + k;
+               for (size_t x=0; x<mWidth; ++x)
+               {
+                  dst[x] += wk * lk[x];
+               }
+            }
+         }
+      }
+      
+   private:
+      const GaussianBlur &mBlur;
+      const float *mIn;
+      float *mOut;
+      size_t mWidth;
+   };
+   
+   class ColumnsTask
+   {
+   public:
+      ColumnsTask(const GaussianBlur &blur, const float *in, float *out, size_t width, size_t height)
+         : mBlur(blur), mIn(in), mOut(out), mWidth(width), mHeight(height)
+      {
+      }
+      
+      void operator()(size_t y0, size_t y1) const
+      {
+         long r = long(mBlur.mRadius);
+         long last = long(mHeight) - 1;
+         const float *w = &(mBlur.mWeights[0]);
+         
+         for (size_t y=y0; y<y1; ++y)
+         {
+            float *dst = mOut + y * mWidth;
+            
+            for (long k=-r; k<=r; ++k)
+            {
+               long sy = std::min(last, std::max(0L, long(y) + k));
+               const float *src = mIn + size_t(sy) * mWidth;
+               float wk = w[k + r];
+               
+               if (k == -r)
+               {
+                  for (size_t x=0; x<mWidth; ++x)
+                  {
+                     dst[x] = wk * src[x];
+                  }
+               }
+               else
+               {
+                  for (size_t x=0; x<mWidth; ++x)
+                  {
+                     dst[x] += wk * src[x];
+                  }
+               }
+            }
+         }
+      }
+      
+   private:
+      const GaussianBlur &mBlur;
+      const float *mIn;
+      float *mOut;
+      size_t mWidth;
+      size_t mHeight;
+   };
+   
+   std::vector<float> mWeights;
+   size_t mRadius;
+};
+
+// Keeps Ladapt = V1 for pixels whose center-surround difference stays below threshold
+//   V = (V1 - V2) / (2^phi * key / s^2 + V1)
+class ScaleSelectTask
+{
+public:
+   ScaleSelectTask(const float *V1, const float *V2, float bias, float threshold,
+                   float *Ladapt, unsigned char *active)
+      : mV1(V1), mV2(V2), mBias(bias), mThreshold(threshold), mLadapt(Ladapt), mActive(active)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         if (mActive[i])
+         {
+            float V = (mV1[i] - mV2[i]) / (mBias + mV1[i]);
+            if (Abs(V) < mThreshold)
+            {
+               mLadapt[i] = mV1[i];
+            }
+            else
+            {
+               mActive[i] = 0;
+            }
+         }
+      }
+   }
+   
+private:
+   const float *mV1;
+   const float *mV2;
+   float mBias;
+   float mThreshold;
+   float *mLadapt;
+   unsigned char *mActive;
+};
+
+// c' = c * k0 * (1 + L * k1) / (1 + Ladapt), white point fallback as the global kernel
+class LocalToneMapTask
+{
+public:
+   LocalToneMapTask(const batch::Pixels &in, const batch::Pixels &out, const float lum[3],
+                    const float sum[3], const float white[3], float k0, float k1,
+                    const float *Ladapt)
+      : mIn(in), mOut(out), mLum(lum), mSum(sum), mWhite(white), mK0(k0), mK1(k1), mLadapt(Ladapt)
+   {
+   }
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         size_t io = i * mIn.stride;
+         size_t oo = i * mOut.stride;
+         float R = mIn.ch[0][io];
+         float G = mIn.ch[1][io];
+         float B = mIn.ch[2][io];
+         float Y = mLum[0] * R + mLum[1] * G + mLum[2] * B;
+         float S = mSum[0] * R + mSum[1] * G + mSum[2] * B;
+         float k = mK0 * (1.0f + mK0 * Y * mK1) / (1.0f + mLadapt[i]);
+         if (S >= 0.000001f)
+         {
+            mOut.ch[0][oo] = R * k;
+            mOut.ch[1][oo] = G * k;
+            mOut.ch[2][oo] = B * k;
+         }
+         else
+         {
+            float Lo = Y * k;
+            mOut.ch[0][oo] = mWhite[0] * Lo;
+            mOut.ch[1][oo] = mWhite[1] * Lo;
+            mOut.ch[2][oo] = mWhite[2] * Lo;
+         }
+      }
+   }
+   
+private:
+   batch::Pixels mIn;
+   batch::Pixels mOut;
+   const float *mLum;
+   const float *mSum;
+   const float *mWhite;
+   float mK0;
+   float mK1;
+   const float *mLadapt;
+};
+
+static void LocalToneMap(const batch::Pixels &in, const batch::Pixels &out, size_t width, size_t height,
+                         const float lum[3], const float sum[3], const float white[3],
+                         float k0, float k1, float bias, float threshold)
+{
+   static const int NumScales = 8;
+   static const float ScaleRatio = 1.6f;
+   
+   size_t n = width * height;
+   
+   std::vector<float> L(n), V1(n), V2(n), tmp(n), Ladapt(n);
+   std::vector<unsigned char> active(n, 1);
+   
+   Parallel::For(height, RowGrain(width), LuminanceTask(in, lum, k0, width, &L[0]));
+   
+   // Reinhard et al. center kernel at scale s is a gaussian of standard deviation s / 4, and
+   //   the surround kernel at scale s the center kernel at the next scale s * 1.6
+   float s = 1.0f;
+   
+   GaussianBlur(0.25f * s)(&L[0], &V1[0], &tmp[0], width, height);
+   Ladapt = V1;
+   
+   for (int i=0; i<NumScales; ++i, s*=ScaleRatio)
+   {
+      GaussianBlur(0.25f * s * ScaleRatio)(&L[0], &V2[0], &tmp[0], width, height);
+      Parallel::For(n, batch::ChunkSize, ScaleSelectTask(&V1[0], &V2[0], bias / (s * s), threshold, &Ladapt[0], &active[0]));
+      V1.swap(V2);
+   }
+   
+   Parallel::For(n, batch::ChunkSize, LocalToneMapTask(in, out, lum, sum, white, k0, k1, &Ladapt[0]));
+}
+
+bool ToneMappingOperator::applyImage(const float *in, float *out, size_t width, size_t height, size_t stride) const
+{
+   if (!in || !out || stride < 3)
+   {
+      return false;
+   }
+   if (mMethod != ReinhardLocal || !mValid || width == 0 || height == 0)
+   {
+      return apply(in, out, width * height, stride);
+   }
+   LocalToneMap(batch::Interleaved(in, stride), batch::Interleaved(out, stride), width, height,
+                mCompiled.lum, mCompiled.sum, mCompiled.white,
+                mCompiled.k0, mCompiled.k1, mCompiled.k2, mCompiled.k3);
+   return true;
+}
+
+bool ToneMappingOperator::applyImage(const float *const in[3], float *const out[3], size_t width, size_t height) const
+{
+   if (!in || !out || !in[0] || !in[1] || !in[2] || !out[0] || !out[1] || !out[2])
+   {
+      return false;
+   }
+   if (mMethod != ReinhardLocal || !mValid || width == 0 || height == 0)
+   {
+      return apply(in, out, width * height);
+   }
+   LocalToneMap(batch::Planar(in), batch::Planar(out), width, height,
+                mCompiled.lum, mCompiled.sum, mCompiled.white,
+                mCompiled.k0, mCompiled.k1, mCompiled.k2, mCompiled.k3);
+   return true;
+}
+
+}
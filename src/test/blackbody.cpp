@@ -0,0 +1,115 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+struct LookupTask
+{
+   float *errors;
+   
+   void operator()(size_t begin, size_t end) const
+   {
+      for (size_t i=begin; i<end; ++i)
+      {
+         float temp = 1000.0f + 0.37f * float(i);
+         XYZ c = Blackbody::GetXYZ(temp);
+         XYZ r0 = IntegrateVisibleSpectrum(Blackbody(Floor(temp)));
+         XYZ r1 = IntegrateVisibleSpectrum(Blackbody(Floor(temp) + 1.0f));
+         XYZ r = r0 + (temp - Floor(temp)) * (r1 - r0);
+         float err = std::max(Abs(c.x - r.x), std::max(Abs(c.y - r.y), Abs(c.z - r.z)));
+         errors[i] = err / std::max(1e-20f, r.y);
+      }
+   }
+};
+
+int main(int, char**)
+{
+   clock_t t0 = clock();
+   XYZ first = Blackbody::GetXYZ(6500.0f);
+   clock_t t1 = clock();
+   XYZ second = Blackbody::GetXYZ(6500.5f);
+   clock_t t2 = clock();
+   
+   std::cout << "First call " << 1e6 * double(t1 - t0) / CLOCKS_PER_SEC << "us: " << first << std::endl;
+   std::cout << "Cached call " << 1e6 * double(t2 - t1) / CLOCKS_PER_SEC << "us: " << second << std::endl;
+   
+   // concurrent lookups over many chunks
+   size_t n = 20000;
+   std::vector<float> errors(n);
+   LookupTask task = {&errors[0]};
+   Parallel::SetThreadCount(4);
+   Parallel::For(n, 256, task);
+   Parallel::SetThreadCount(0);
+   
+   float maxErr = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      maxErr = std::max(maxErr, errors[i]);
+   }
+   std::cout << "Max relative error vs direct integration (" << n << " temperatures, 4 threads): " << maxErr << std::endl;
+   
+   // baked temperature to RGB table
+   BlackbodyTable table;
+   t0 = clock();
+   table.build(ColorSpace::Rec709);
+   t1 = clock();
+   
+   srand(1234);
+   n = 1 << 24;
+   std::vector<float> temps(n), rgb(3 * n);
+   for (size_t i=0; i<n; ++i)
+   {
+      temps[i] = 1000.0f + 39000.0f * float(rand()) / RAND_MAX;
+   }
+   
+   t2 = clock();
+   table.apply(&temps[0], &rgb[0], n);
+   clock_t t3 = clock();
+   
+   float tableErr = 0.0f;
+   float scalarErr = 0.0f;
+   for (size_t i=0; i<n; i+=n/20000)
+   {
+      RGB ref = Blackbody::GetRGB(temps[i], ColorSpace::Rec709);
+      RGB one = table(temps[i]);
+      tableErr = std::max(tableErr, std::max(Abs(rgb[3 * i] - ref.r), std::max(Abs(rgb[3 * i + 1] - ref.g), Abs(rgb[3 * i + 2] - ref.b))));
+      scalarErr = std::max(scalarErr, std::max(Abs(rgb[3 * i] - one.r), std::max(Abs(rgb[3 * i + 1] - one.g), Abs(rgb[3 * i + 2] - one.b))));
+   }
+   
+   double secs = double(t3 - t2) / CLOCKS_PER_SEC;
+   std::cout << "BlackbodyTable: built in " << 1e3 * double(t1 - t0) / CLOCKS_PER_SEC << "ms, " << n << " temperatures in " << 1e3 * secs << "ms ("
+             << (secs > 0.0 ? 1e-6 * double(n) / secs : 0.0) << " M/s, " << Parallel::GetThreadCount() << " thread(s))" << std::endl;
+   std::cout << "  max error vs GetRGB " << tableErr << ", batch vs single lookups " << scalarErr << std::endl;
+   std::cout << "  clamped: " << table(100.0f) << " " << table(1000.0f) << ", " << table(1e6f) << " " << table(40000.0f) << std::endl;
+   
+   return 0;
+}
@@ -0,0 +1,174 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/bvh.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+static float Random(float lo, float hi) {
+  return lo + (hi - lo) * float(rand()) / RAND_MAX;
+}
+
+// Brute force reference: entry distance in [0, tmax], origin inside counts as 0
+static bool HitBox(const Ray &ray, const AABox &b, float tmax, float &t) {
+  float tn = 0.0f;
+  float tf = tmax;
+  for (int k=0; k<3; ++k) {
+    float d = ray.getDirection()[k];
+    float o = ray.getOrigin()[k];
+    float inv = (Abs(d) > 1e-20f ? 1.0f / d : 1e30f);
+    float t0 = (b.getMin()[k] - o) * inv;
+    float t1 = (b.getMax()[k] - o) * inv;
+    tn = std::max(tn, std::min(t0, t1));
+    tf = std::min(tf, std::max(t0, t1));
+  }
+  t = tn;
+  return (tn <= tf);
+}
+
+static void MakeBoxes(std::vector<AABox> &boxes, float t) {
+  for (size_t i=0; i<boxes.size(); ++i) {
+    srand((unsigned int) i + 1);
+    Vector3 c(Random(-1000, 1000), Random(-1000, 1000), Random(-1000, 1000));
+    Vector3 e(Random(0.1f, 5), Random(0.1f, 5), Random(0.1f, 5));
+    Vector3 v(Random(-1, 1), Random(-1, 1), Random(-1, 1));
+    c += (t * 20.0f) * v;
+    boxes[i] = AABox(c - e, c + e);
+  }
+}
+
+static size_t CheckRays(const BVH &bvh, const std::vector<AABox> &boxes, size_t nrays, size_t &hits) {
+  size_t wrong = 0;
+  hits = 0;
+  srand(4321);
+  for (size_t r=0; r<nrays; ++r) {
+    Ray ray(Vector3(Random(-1000, 1000), Random(-1000, 1000), Random(-1000, 1000)),
+            Vector3(Random(-1, 1), Random(-1, 1), Random(-1, 1)));
+    float best = 5000.0f;
+    size_t ref = BVH::InvalidIndex;
+    for (size_t i=0; i<boxes.size(); ++i) {
+      float t;
+      if (HitBox(ray, boxes[i], best, t) && (ref == BVH::InvalidIndex || t < best)) {
+        best = t;
+        ref = i;
+      }
+    }
+    float dist = 0.0f;
+    size_t idx = bvh.closestHit(ray, 5000.0f, &dist);
+    bool any = bvh.anyHit(ray, 5000.0f);
+    // ties may pick another box at the same distance
+    if ((idx == BVH::InvalidIndex) != (ref == BVH::InvalidIndex) ||
+        (idx != BVH::InvalidIndex && dist != best) || any != (ref != BVH::InvalidIndex)) {
+      ++wrong;
+    }
+    hits += (ref != BVH::InvalidIndex ? 1 : 0);
+  }
+  return wrong;
+}
+
+int main(int, char**) {
+  size_t n = 200000;
+  std::vector<AABox> boxes(n);
+  MakeBoxes(boxes, 0.0f);
+  
+  double scale = 1000.0 / CLOCKS_PER_SEC;
+  std::cout << n << " boxes, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+  
+  BVH bvh;
+  clock_t t0 = clock();
+  bvh.build(&boxes[0], n);
+  clock_t t1 = clock();
+  std::cout << "build: " << (t1 - t0) * scale << "ms, " << bvh.getNodeCount() << " nodes (" << sizeof(BVH::Node) << " bytes each)" << std::endl;
+  
+  // Every box referenced once
+  std::vector<unsigned int> seen(bvh.getIndices(), bvh.getIndices() + bvh.getBoxCount());
+  std::sort(seen.begin(), seen.end());
+  bool complete = (seen.size() == n);
+  for (size_t i=0; complete && i<n; ++i) {
+    complete = (seen[i] == i);
+  }
+  std::cout << "indices: " << (complete ? "ok" : "wrong") << std::endl;
+  
+  size_t hits = 0;
+  size_t wrong = CheckRays(bvh, boxes, 200, hits);
+  std::cout << "rays: " << wrong << " wrong out of 200 (" << hits << " hits)" << std::endl;
+  
+  srand(99);
+  size_t nrays = 100000;
+  size_t found = 0;
+  t0 = clock();
+  for (size_t r=0; r<nrays; ++r) {
+    Ray ray(Vector3(Random(-1000, 1000), Random(-1000, 1000), Random(-1000, 1000)),
+            Vector3(Random(-1, 1), Random(-1, 1), Random(-1, 1)));
+    found += (bvh.closestHit(ray, 5000.0f) != BVH::InvalidIndex ? 1 : 0);
+  }
+  t1 = clock();
+  std::cout << nrays << " closest hit queries: " << (t1 - t0) * scale << "ms, " << found << " hits" << std::endl;
+  
+  // Frustum query versus Frustum::classify on every box
+  Frustum f(PM_PERSPECTIVE, 60.0f, 16.0f / 9.0f, 1.0f, 800.0f);
+  std::vector<size_t> result;
+  t0 = clock();
+  size_t count = bvh.query(f, result);
+  t1 = clock();
+  size_t ref = 0;
+  for (size_t i=0; i<n; ++i) {
+    ref += (f.classify(boxes[i]) != Frustum::OUTSIDE ? 1 : 0);
+  }
+  clock_t t2 = clock();
+  std::cout << "frustum query: " << (t1 - t0) * scale << "ms, " << count << " boxes (brute force " << ref << ", " << (t2 - t1) * scale << "ms)" << std::endl;
+  
+  // Box overlap query
+  AABox region(Vector3(-100, -50, -200), Vector3(150, 100, 0));
+  result.clear();
+  count = bvh.query(region, result);
+  ref = 0;
+  for (size_t i=0; i<n; ++i) {
+    ref += (region.intersect(boxes[i]) ? 1 : 0);
+  }
+  std::cout << "box query: " << count << " boxes (brute force " << ref << ")" << std::endl;
+  
+  // Refit after moving boxes
+  MakeBoxes(boxes, 1.0f);
+  t0 = clock();
+  bvh.refit(&boxes[0], n);
+  t1 = clock();
+  wrong = CheckRays(bvh, boxes, 200, hits);
+  result.clear();
+  count = bvh.query(region, result);
+  ref = 0;
+  for (size_t i=0; i<n; ++i) {
+    ref += (region.intersect(boxes[i]) ? 1 : 0);
+  }
+  std::cout << "refit: " << (t1 - t0) * scale << "ms, rays " << wrong << " wrong out of 200, box query " << count << " (brute force " << ref << ")" << std::endl;
+  
+  return 0;
+}
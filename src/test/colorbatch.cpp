@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+static float MaxError(size_t n, const float *a, size_t astride, const float *b, size_t bstride)
+{
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         err = std::max(err, Abs(a[i * astride + c] - b[i * bstride + c]));
+      }
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &cs = ColorSpace::Rec709;
+   
+   size_t n = 1920 * 1080;
+   
+   std::vector<float> rgb(3 * n), rgba(4 * n), ref(3 * n), out(3 * n), outa(4 * n);
+   std::vector<float> planes(3 * n), oplanes(3 * n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         float v = float(rand()) / RAND_MAX;
+         rgb[i * 3 + c] = v;
+         rgba[i * 4 + c] = v;
+         planes[c * n + i] = v;
+      }
+      rgba[i * 4 + 3] = 0.5f;
+   }
+   
+   const float *pin[3] = {&planes[0], &planes[n], &planes[2 * n]};
+   float *pout[3] = {&oplanes[0], &oplanes[n], &oplanes[2 * n]};
+   
+   clock_t t0 = clock();
+   for (size_t i=0; i<n; ++i)
+   {
+      XYZ xyz = cs.RGBtoXYZ(RGB(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]));
+      ref[i * 3] = xyz.x;
+      ref[i * 3 + 1] = xyz.y;
+      ref[i * 3 + 2] = xyz.z;
+   }
+   clock_t t1 = clock();
+   cs.RGBtoXYZ(&rgb[0], &out[0], n);
+   clock_t t2 = clock();
+   cs.RGBtoXYZ(&rgba[0], &outa[0], n, 4);
+   clock_t t3 = clock();
+   cs.RGBtoXYZ(pin, pout, n);
+   clock_t t4 = clock();
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   
+   std::cout << "RGBtoXYZ, " << n << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   std::cout << "  per pixel calls  " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  interleaved RGB  " << (t2 - t1) * scale << "ms, error " << MaxError(n, &out[0], 3, &ref[0], 3) << std::endl;
+   std::cout << "  interleaved RGBA " << (t3 - t2) * scale << "ms, error " << MaxError(n, &outa[0], 4, &ref[0], 3) << std::endl;
+   
+   float perr = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         perr = std::max(perr, Abs(pout[c][i] - ref[i * 3 + c]));
+      }
+   }
+   std::cout << "  planar           " << (t4 - t3) * scale << "ms, error " << perr << std::endl;
+   
+   // alpha untouched
+   bool alphaOk = true;
+   for (size_t i=0; i<n; ++i)
+   {
+      alphaOk = alphaOk && (rgba[i * 4 + 3] == 0.5f);
+   }
+   std::cout << "  alpha preserved: " << (alphaOk ? "yes" : "no") << std::endl;
+   
+   // round trips, in-place
+   cs.XYZtoRGB(&out[0], &out[0], n);
+   std::cout << "XYZtoRGB round trip error " << MaxError(n, &out[0], 3, &rgb[0], 3) << std::endl;
+   
+   cs.RGBtoYUV(&rgb[0], &out[0], 16);
+   float yerr = 0.0f;
+   for (size_t i=0; i<16; ++i)
+   {
+      YUV yuv = cs.RGBtoYUV(RGB(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2]));
+      yerr = std::max(yerr, Abs(yuv.y - out[i * 3]));
+      yerr = std::max(yerr, Abs(yuv.u - out[i * 3 + 1]));
+      yerr = std::max(yerr, Abs(yuv.v - out[i * 3 + 2]));
+   }
+   std::cout << "RGBtoYUV error vs per pixel call " << yerr << std::endl;
+   
+   cs.YUVtoRGB(&out[0], &out[0], 16);
+   std::cout << "YUVtoRGB round trip error " << MaxError(16, &out[0], 3, &rgb[0], 3) << std::endl;
+   
+   return 0;
+}
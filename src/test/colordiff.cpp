@@ -0,0 +1,177 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colordiff.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+static float Rand(float a, float b)
+{
+   return a + (b - a) * float(rand()) / RAND_MAX;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   // Sharma et al. test data
+   struct
+   {
+      float lab0[3];
+      float lab1[3];
+      float dE;
+   } pairs[] = {{{50.0f, 2.6772f, -79.7751f}, {50.0f, 0.0f, -82.7485f}, 2.0425f},
+                {{50.0f, 3.1571f, -77.2803f}, {50.0f, 0.0f, -82.7485f}, 2.8615f},
+                {{50.0f, 2.8361f, -74.0200f}, {50.0f, 0.0f, -82.7485f}, 3.4412f},
+                {{50.0f, 0.0f, 0.0f}, {50.0f, -1.0f, 2.0f}, 2.3669f},
+                {{50.0f, 2.5f, 0.0f}, {73.0f, 25.0f, -18.0f}, 27.1492f},
+                {{60.2574f, -34.0099f, 36.2677f}, {60.4626f, -34.1751f, 39.4387f}, 1.2644f},
+                {{2.0776f, 0.0795f, -1.1350f}, {0.9033f, -0.0636f, -0.5514f}, 0.9082f}};
+   
+   float err = 0.0f;
+   for (size_t i=0; i<sizeof(pairs)/sizeof(pairs[0]); ++i)
+   {
+      LAB c0(pairs[i].lab0);
+      LAB c1(pairs[i].lab1);
+      err = std::max(err, Abs(DeltaE2000(c0, c1) - pairs[i].dE));
+      // symmetric
+      err = std::max(err, Abs(DeltaE2000(c1, c0) - pairs[i].dE));
+   }
+   std::cout << "CIEDE2000 max error vs reference data " << err << std::endl;
+   std::cout << "CIE76 " << DeltaE76(LAB(50.0f, 0.0f, 0.0f), LAB(53.0f, 4.0f, 0.0f)) << " (expected 5)" << std::endl;
+   std::cout << "CIE94 gray " << DeltaE94(LAB(50.0f, 0.0f, 0.0f), LAB(53.0f, 0.0f, 4.0f)) << " (expected 5)" << std::endl;
+   
+   size_t n = 3840 * 2160;
+   std::vector<float> lab(3 * n), lab1(3 * n), dE(n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      lab[3 * i] = Rand(0.0f, 100.0f);
+      lab[3 * i + 1] = Rand(-90.0f, 90.0f);
+      lab[3 * i + 2] = Rand(-90.0f, 90.0f);
+      for (int c=0; c<3; ++c)
+      {
+         lab1[3 * i + c] = lab[3 * i + c] + Rand(-3.0f, 3.0f);
+      }
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   
+   std::cout << n << " colors, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   
+   const char *names[] = {"CIE76", "CIE94", "CIEDE2000"};
+   for (int f=0; f<3; ++f)
+   {
+      clock_t t0 = clock();
+      DeltaE(DeltaEFormula(f), &lab[0], &lab1[0], &dE[0], n);
+      clock_t t1 = clock();
+      float berr = 0.0f;
+      for (size_t i=0; i<n; i+=97)
+      {
+         berr = std::max(berr, Abs(dE[i] - DeltaE(DeltaEFormula(f), LAB(&lab[3 * i]), LAB(&lab1[3 * i]))));
+      }
+      std::cout << "  batch " << names[f] << " " << (t1 - t0) * scale << "ms, error vs scalar " << berr << std::endl;
+   }
+   
+   // palette search
+   size_t np = 4096;
+   std::vector<float> palette(3 * np);
+   for (size_t i=0; i<np; ++i)
+   {
+      palette[3 * i] = Rand(0.0f, 100.0f);
+      palette[3 * i + 1] = Rand(-80.0f, 80.0f);
+      palette[3 * i + 2] = Rand(-80.0f, 80.0f);
+   }
+   
+   PaletteIndex index;
+   clock_t t0 = clock();
+   index.build(&palette[0], np);
+   clock_t t1 = clock();
+   std::vector<unsigned int> nearest(n);
+   std::vector<float> distances(n);
+   index.nearest(&lab[0], n, &nearest[0], &distances[0]);
+   clock_t t2 = clock();
+   
+   // smooth image, neighbour pixels hit the same cells
+   std::vector<float> image(3 * n);
+   for (size_t y=0, i=0; y<2160; ++y)
+   {
+      for (size_t x=0; x<3840; ++x, ++i)
+      {
+         image[3 * i] = 100.0f * float(y) / 2160.0f;
+         image[3 * i + 1] = 80.0f * sinf(float(x) * 0.002f);
+         image[3 * i + 2] = 80.0f * cosf(float(x + y) * 0.001f);
+      }
+   }
+   clock_t t3 = clock();
+   index.nearest(&image[0], n, &nearest[0]);
+   clock_t t4 = clock();
+   
+   std::cout << "Palette of " << np << " colors, build " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  " << n << " random colors " << (t2 - t1) * scale << "ms" << std::endl;
+   std::cout << "  3840x2160 image " << (t4 - t3) * scale << "ms" << std::endl;
+   
+   // brute force check on a subset, including out of range colors
+   size_t mismatches = 0;
+   size_t checked = 0;
+   for (size_t i=0; i<n; i+=997, ++checked)
+   {
+      LAB c(&lab[3 * i]);
+      if (checked % 10 == 0)
+      {
+         c = LAB(Rand(-20.0f, 120.0f), Rand(-200.0f, 200.0f), Rand(-200.0f, 200.0f));
+      }
+      unsigned int best = 0;
+      float bd = DeltaE76(c, index.getColor(0));
+      for (size_t j=1; j<np; ++j)
+      {
+         float d = DeltaE76(c, index.getColor(j));
+         if (d < bd)
+         {
+            bd = d;
+            best = (unsigned int) j;
+         }
+      }
+      float d = 0.0f;
+      size_t idx = index.nearest(c, &d);
+      if (idx != best && Abs(d - bd) > 1e-5f)
+      {
+         ++mismatches;
+      }
+   }
+   std::cout << "Nearest mismatches vs brute force: " << mismatches << " / " << checked << std::endl;
+   
+   PaletteIndex empty;
+   float ed = 0.0f;
+   size_t ei = empty.nearest(LAB(50.0f, 0.0f, 0.0f), &ed);
+   std::cout << "Empty palette: index " << ei << " (size " << empty.size() << "), distance " << ed << std::endl;
+   
+   return 0;
+}
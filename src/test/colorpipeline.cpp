@@ -0,0 +1,170 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colorpipeline.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &src = ColorSpace::AlexaWide;
+   const ColorSpace &dst = ColorSpace::Rec709;
+   
+   ToneMappingOperator tmo(dst);
+   Params params;
+   params.set("key", 0.18f);
+   params.set("Lavg", 0.25f);
+   params.set("Lwht", 4.0f);
+   tmo.setMethod(ToneMappingOperator::Reinhard, params);
+   
+   Matrix3 cat = ChromaticAdaptationMatrix(ChromaticityYtoXYZ(src.getWhitePoint(), 1.0f),
+                                           ChromaticityYtoXYZ(dst.getWhitePoint(), 1.0f),
+                                           CAT_Bradford);
+   
+   ColorPipeline pipeline;
+   pipeline.linearize(Gamma::LogC)
+           .RGBtoXYZ(src)
+           .adapt(ChromaticityYtoXYZ(src.getWhitePoint(), 1.0f),
+                  ChromaticityYtoXYZ(dst.getWhitePoint(), 1.0f),
+                  CAT_Bradford)
+           .XYZtoRGB(dst)
+           .toneMap(tmo)
+           .unlinearize(Gamma::sRGB);
+   
+   // linearize, 1 matrix, tone map (RGB), unlinearize
+   std::cout << "Stages: " << pipeline.getStageCount() << " (expected 4)" << std::endl;
+   
+   ColorPipeline identity;
+   identity.RGBtoXYZ(dst).XYZtoRGB(dst);
+   std::cout << "RGBtoXYZ + XYZtoRGB stages: " << identity.getStageCount() << " (expected 0)" << std::endl;
+   
+   size_t n = 1920 * 1080;
+   std::vector<float> in(4 * n), ref(4 * n), out(4 * n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         in[i * 4 + c] = 0.6f * float(rand()) / RAND_MAX;
+      }
+      in[i * 4 + 3] = 1.0f;
+   }
+   
+   clock_t t0 = clock();
+   for (size_t i=0; i<n; ++i)
+   {
+      RGB c = Gamma::Linearize(RGB(in[i * 4], in[i * 4 + 1], in[i * 4 + 2]), Gamma::LogC);
+      XYZ xyz = src.RGBtoXYZ(c);
+      xyz = XYZ(cat * Vector3(xyz));
+      c = tmo(dst.XYZtoRGB(xyz));
+      c = Gamma::Unlinearize(c, Gamma::sRGB);
+      ref[i * 4] = c.r;
+      ref[i * 4 + 1] = c.g;
+      ref[i * 4 + 2] = c.b;
+   }
+   clock_t t1 = clock();
+   pipeline.apply(&in[0], &out[0], n, 4);
+   clock_t t2 = clock();
+   
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         // relative to the value magnitude, wide gamut inputs go far out of the Rec. 709 gamut
+         err = std::max(err, Abs(out[i * 4 + c] - ref[i * 4 + c]) / std::max(1.0f, Abs(ref[i * 4 + c])));
+      }
+   }
+   
+   RGB one = pipeline(RGB(in[0], in[1], in[2]));
+   float err1 = std::max(Abs(one.r - ref[0]), std::max(Abs(one.g - ref[1]), Abs(one.b - ref[2])));
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << n << " pixels" << std::endl;
+   std::cout << "  separate calls " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  pipeline       " << (t2 - t1) * scale << "ms, max relative error " << err << std::endl;
+   std::cout << "  single pixel error " << err1 << std::endl;
+   
+   // Cached RGB to RGB matrices, built-in pair and a copy (looked up by primaries)
+   Matrix3 direct = dst.getXYZtoRGBMatrix() * cat * src.getRGBtoXYZMatrix();
+   ColorSpace srcCopy(src);
+   
+   size_t ncalls = 1000000;
+   float merr = 0.0f;
+   t0 = clock();
+   for (size_t i=0; i<ncalls; ++i)
+   {
+      Matrix3 M = RGBtoRGBMatrix(src, dst, CAT_Bradford);
+      merr = std::max(merr, Abs(M(i % 3, (i / 3) % 3) - direct(i % 3, (i / 3) % 3)));
+   }
+   t1 = clock();
+   for (size_t i=0; i<ncalls; ++i)
+   {
+      Matrix3 M = RGBtoRGBMatrix(srcCopy, dst, CAT_Bradford);
+      merr = std::max(merr, Abs(M(i % 3, (i / 3) % 3) - direct(i % 3, (i / 3) % 3)));
+   }
+   t2 = clock();
+   clock_t t3 = clock();
+   for (size_t i=0; i<ncalls; ++i)
+   {
+      Matrix3 M = dst.getXYZtoRGBMatrix() * ChromaticAdaptationMatrix(ChromaticityYtoXYZ(src.getWhitePoint(), 1.0f),
+                                                                      ChromaticityYtoXYZ(dst.getWhitePoint(), 1.0f),
+                                                                      CAT_Bradford) * src.getRGBtoXYZMatrix();
+      merr = std::max(merr, Abs(M(i % 3, (i / 3) % 3) - direct(i % 3, (i / 3) % 3)));
+   }
+   clock_t t4 = clock();
+   
+   std::cout << "RGBtoRGBMatrix, " << ncalls << " calls" << std::endl;
+   std::cout << "  built-in pair  " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  other pair     " << (t2 - t1) * scale << "ms" << std::endl;
+   std::cout << "  uncached       " << (t4 - t3) * scale << "ms, max error " << merr << std::endl;
+   
+   ColorPipeline rgb2rgb;
+   rgb2rgb.RGBtoRGB(src, dst);
+   RGB c0 = rgb2rgb(RGB(0.2f, 0.5f, 0.7f));
+   RGB c1 = dst.XYZtoRGB(src.RGBtoXYZ(RGB(0.2f, 0.5f, 0.7f)));
+   std::cout << "  RGBtoRGB stage without adaptation error " << std::max(Abs(c0.r - c1.r), std::max(Abs(c0.g - c1.g), Abs(c0.b - c1.b))) << std::endl;
+   
+   // out of range adaptation falls back to CAT_XYZ, as ChromaticAdaptationMatrix
+   Matrix3 mxyz = RGBtoRGBMatrix(src, dst, CAT_XYZ);
+   Matrix3 mbad = RGBtoRGBMatrix(src, dst, ChromaticAdaptationTransform(CAT_XYZ + 5));
+   float berr = 0.0f;
+   for (int r=0; r<3; ++r)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         berr = std::max(berr, Abs(mbad(r, c) - mxyz(r, c)));
+      }
+   }
+   std::cout << "  unknown adaptation vs CAT_XYZ error " << berr << std::endl;
+   
+   return 0;
+}
@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/colorstats.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &cs = ColorSpace::Rec709;
+   
+   size_t n = 1920 * 1080;
+   std::vector<float> rgb(3 * n), L(n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      // roughly log-uniform scene values
+      float e = -8.0f + 12.0f * float(rand()) / RAND_MAX;
+      for (int c=0; c<3; ++c)
+      {
+         rgb[3 * i + c] = powf(2.0f, e) * (0.5f + float(rand()) / RAND_MAX);
+      }
+   }
+   
+   // serial reference
+   clock_t t0 = clock();
+   double sum = 0.0;
+   double logSum = 0.0;
+   float Lmin = rgb[0];
+   float Lmax = rgb[0];
+   for (size_t i=0; i<n; ++i)
+   {
+      float l = cs.luminance(RGB(&rgb[3 * i]));
+      L[i] = l;
+      sum += l;
+      logSum += log(LuminanceStats::LogDelta + std::max(0.0f, l));
+      Lmin = std::min(Lmin, l);
+      Lmax = std::max(Lmax, l);
+   }
+   std::vector<float> sorted(L);
+   std::sort(sorted.begin(), sorted.end());
+   clock_t t1 = clock();
+   
+   LuminanceStats stats;
+   stats.compute(cs, &rgb[0], n);
+   clock_t t2 = clock();
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << n << " pixels: serial loop + sort " << (t1 - t0) * scale << "ms, LuminanceStats " << (t2 - t1) * scale << "ms" << std::endl;
+   std::cout << "  min         " << stats.getMin() << " (" << Lmin << ")" << std::endl;
+   std::cout << "  max         " << stats.getMax() << " (" << Lmax << ")" << std::endl;
+   std::cout << "  average     " << stats.getAverage() << " (" << sum / n << ")" << std::endl;
+   std::cout << "  log-average " << stats.getLogAverage() << " (" << exp(logSum / n) << ")" << std::endl;
+   
+   float percentiles[] = {1.0f, 50.0f, 90.0f, 99.0f, 99.9f};
+   for (int i=0; i<5; ++i)
+   {
+      size_t idx = std::min(n - 1, size_t(percentiles[i] * 0.01f * n));
+      std::cout << "  " << percentiles[i] << "%  " << stats.getPercentile(percentiles[i]) << " (" << sorted[idx] << ")" << std::endl;
+   }
+   
+   // thread count independence
+   LuminanceStats stats1, stats4;
+   Parallel::SetThreadCount(1);
+   stats1.compute(L.data(), n);
+   Parallel::SetThreadCount(4);
+   stats4.compute(L.data(), n);
+   Parallel::SetThreadCount(0);
+   bool same = (stats1.getLogAverage() == stats4.getLogAverage() &&
+                stats1.getAverage() == stats4.getAverage() &&
+                stats1.getPercentile(99.0f) == stats4.getPercentile(99.0f));
+   std::cout << "1 vs 4 threads identical: " << (same ? "yes" : "no") << std::endl;
+   
+   ToneMappingOperator tmo(cs);
+   tmo.setMethod(ToneMappingOperator::Reinhard);
+   bool valid = stats.updateToneMapping(tmo);
+   ToneMappingOperator::ReinhardParams p;
+   tmo.getParams(p);
+   std::cout << "Reinhard valid: " << valid << ", Lavg " << float(p.Lavg) << ", Lwht " << float(p.Lwht) << std::endl;
+   
+   return 0;
+}
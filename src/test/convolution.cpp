@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/convolution.h>
+#include <cstdlib>
+
+using namespace gmath;
+
+static float MaxError(size_t n, const float *a, const float *b)
+{
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      err = std::max(err, Abs(a[i] - b[i]));
+   }
+   return err;
+}
+
+static void Randomize(size_t n, float *data)
+{
+   for (size_t i=0; i<n; ++i)
+   {
+      data[i] = float(rand()) / float(RAND_MAX) - 0.5f;
+   }
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   Convolver<float> conv;
+   
+   // 1D
+   {
+      const int N = 1000;
+      const int K = 37;
+      std::vector<float> sig(N), ker(K), direct(N + K - 1), spectral(N + K - 1);
+      
+      Randomize(N, &sig[0]);
+      Randomize(K, &ker[0]);
+      
+      conv.setKernel(K, &ker[0]);
+      conv.setMethod(Convolver<float>::Direct);
+      conv.convolve(N, &sig[0], &direct[0]);
+      conv.setMethod(Convolver<float>::Spectral);
+      conv.convolve(N, &sig[0], &spectral[0]);
+      std::cout << "1D convolution direct vs FFT max error: " << MaxError(direct.size(), &direct[0], &spectral[0]) << std::endl;
+      
+      conv.setKernel(K, &ker[0], Convolver<float>::Correlation);
+      conv.setMethod(Convolver<float>::Auto);
+      conv.convolve(N, &sig[0], &spectral[0]);
+      float lag0 = 0.0f;
+      for (int j=0; j<K; ++j)
+      {
+         lag0 += sig[j] * ker[j];
+      }
+      std::cout << "1D correlation at lag 0: " << spectral[K - 1] << " (expected " << lag0 << ")" << std::endl;
+      
+      // Streaming, feed the signal followed by enough zeros to flush the full output
+      conv.setKernel(K, &ker[0]);
+      conv.setMethod(Convolver<float>::Spectral);
+      int latency = conv.getLatency();
+      int total = N + K - 1 + latency;
+      std::vector<float> stream(total, 0.0f), streamed(total);
+      std::copy(sig.begin(), sig.end(), stream.begin());
+      for (int i=0; i<total; i+=100)
+      {
+         int n = std::min(100, total - i);
+         conv.process(n, &stream[i], &streamed[i]);
+      }
+      std::cout << "1D overlap-add streaming (latency " << latency << ") max error: " << MaxError(direct.size(), &direct[0], &streamed[latency]) << std::endl;
+      
+      conv.setMethod(Convolver<float>::Direct);
+      conv.process(total, &stream[0], &streamed[0]);
+      std::cout << "1D direct streaming (latency " << conv.getLatency() << ") max error: " << MaxError(direct.size(), &direct[0], &streamed[0]) << std::endl;
+   }
+   
+   // 2D
+   {
+      const int W = 120, H = 90, KW = 15, KH = 11;
+      std::vector<float> img(W * H), ker(KW * KH), direct(W * H), spectral(W * H);
+      
+      Randomize(img.size(), &img[0]);
+      Randomize(ker.size(), &ker[0]);
+      
+      conv.setKernel(KW, KH, &ker[0]);
+      conv.setMethod(Convolver<float>::Direct);
+      conv.convolve(W, H, &img[0], &direct[0], Convolver<float>::Same);
+      conv.setMethod(Convolver<float>::Spectral);
+      conv.convolve(W, H, &img[0], &spectral[0], Convolver<float>::Same);
+      std::cout << "2D convolution (same) direct vs FFT max error: " << MaxError(direct.size(), &direct[0], &spectral[0]) << std::endl;
+   }
+   
+   // 3D
+   {
+      const int W = 20, H = 16, D = 12, KW = 5, KH = 4, KD = 3;
+      const int FW = W + KW - 1, FH = H + KH - 1, FD = D + KD - 1;
+      std::vector<float> vol(W * H * D), ker(KW * KH * KD), direct(FW * FH * FD), spectral(FW * FH * FD);
+      
+      Randomize(vol.size(), &vol[0]);
+      Randomize(ker.size(), &ker[0]);
+      
+      conv.setKernel(KW, KH, KD, &ker[0]);
+      conv.setMethod(Convolver<float>::Direct);
+      conv.convolve(W, H, D, &vol[0], &direct[0]);
+      conv.setMethod(Convolver<float>::Spectral);
+      conv.convolve(W, H, D, &vol[0], &spectral[0]);
+      std::cout << "3D convolution direct vs FFT max error: " << MaxError(direct.size(), &direct[0], &spectral[0]) << std::endl;
+   }
+   
+   return 0;
+}
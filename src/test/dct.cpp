@@ -0,0 +1,176 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/dct.h>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+// naive O(N^2) DCT-II (sine = false) or DST-II (sine = true)
+static void NaiveForward(int N, const double *x, double *X, bool sine)
+{
+   for (int k=0; k<N; ++k)
+   {
+      double sum = 0.0;
+      for (int n=0; n<N; ++n)
+      {
+         double a = M_PI * (2 * n + 1) * (sine ? k + 1 : k) / (2.0 * N);
+         sum += x[n] * (sine ? sin(a) : cos(a));
+      }
+      X[k] = sum;
+   }
+}
+
+static double MaxError(int n, const float *a, const double *b)
+{
+   double err = 0.0;
+   for (int i=0; i<n; ++i)
+   {
+      err = std::max(err, fabs(double(a[i]) - b[i]));
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   std::cout << "1D transforms: max error vs naive double precision and round trip error" << std::endl;
+   
+   for (int log2N=0; log2N<=10; log2N+=2)
+   {
+      int N = 1 << log2N;
+      
+      std::vector<float> x(N), X(N), back(N);
+      std::vector<double> dx(N), ref(N);
+      
+      for (int i=0; i<N; ++i)
+      {
+         x[i] = float(rand()) / RAND_MAX - 0.5f;
+         dx[i] = x[i];
+      }
+      
+      DCT<float> dct(N);
+      
+      dct.forward(&x[0], &X[0]);
+      NaiveForward(N, &dx[0], &ref[0], false);
+      double errC = MaxError(N, &X[0], &ref[0]);
+      dct.inverse(&X[0], &back[0]);
+      double rtC = MaxError(N, &back[0], &dx[0]);
+      
+      dct.forwardSine(&x[0], &X[0]);
+      NaiveForward(N, &dx[0], &ref[0], true);
+      double errS = MaxError(N, &X[0], &ref[0]);
+      // in-place
+      dct.inverseSine(&X[0], &X[0]);
+      double rtS = MaxError(N, &X[0], &dx[0]);
+      
+      std::cout << "  N = " << N << std::endl;
+      std::cout << "    DCT-II error " << errC << ", round trip " << rtC << std::endl;
+      std::cout << "    DST-II error " << errS << ", round trip " << rtS << std::endl;
+   }
+   
+   std::cout << "2D transforms" << std::endl;
+   
+   int W = 64;
+   int H = 16;
+   std::vector<float> img(W * H), coefs(W * H), back(W * H);
+   std::vector<double> dimg(W * H), tmp(W * H), ref(W * H);
+   std::vector<double> lin(std::max(W, H)), lout(std::max(W, H));
+   
+   for (int i=0; i<W*H; ++i)
+   {
+      img[i] = float(rand()) / RAND_MAX - 0.5f;
+      dimg[i] = img[i];
+   }
+   
+   for (int y=0; y<H; ++y)
+   {
+      NaiveForward(W, &dimg[y * W], &tmp[y * W], false);
+   }
+   for (int x=0; x<W; ++x)
+   {
+      for (int y=0; y<H; ++y)
+      {
+         lin[y] = tmp[y * W + x];
+      }
+      NaiveForward(H, &lin[0], &lout[0], false);
+      for (int y=0; y<H; ++y)
+      {
+         ref[y * W + x] = lout[y];
+      }
+   }
+   
+   DCT<float> dct2(W, H);
+   
+   for (size_t nt=1; nt<=4; nt*=4)
+   {
+      Parallel::SetThreadCount(nt);
+      dct2.forward(&img[0], &coefs[0]);
+      double err = MaxError(W * H, &coefs[0], &ref[0]);
+      dct2.inverse(&coefs[0], &back[0]);
+      double rt = MaxError(W * H, &back[0], &dimg[0]);
+      std::cout << "  " << W << "x" << H << " (" << nt << " thread(s)) DCT-II error " << err << ", round trip " << rt << std::endl;
+   }
+   Parallel::SetThreadCount(0);
+   
+   std::cout << "Timing (N = 4096)" << std::endl;
+   
+   int N = 4096;
+   int reps = 1000;
+   std::vector<float> x(N), X(N);
+   for (int i=0; i<N; ++i)
+   {
+      x[i] = float(rand()) / RAND_MAX - 0.5f;
+   }
+   
+   DCT<float> dct(N);
+   std::vector<Complex<float> > cx(2 * N), cX(2 * N);
+   
+   clock_t t0 = clock();
+   for (int r=0; r<reps; ++r)
+   {
+      dct.forward(&x[0], &X[0]);
+   }
+   clock_t t1 = clock();
+   for (int r=0; r<reps; ++r)
+   {
+      // mirrored 2N points complex FFT
+      for (int i=0; i<N; ++i)
+      {
+         cx[i] = cx[2 * N - 1 - i] = Complex<float>(x[i], 0.0f);
+      }
+      FFT::Forward(2 * N, &cx[0], &cX[0]);
+   }
+   clock_t t2 = clock();
+   
+   double scale = 1e6 / (double(CLOCKS_PER_SEC) * reps);
+   std::cout << "  DCT (N/2 complex FFT)    " << (t1 - t0) * scale << "us" << std::endl;
+   std::cout << "  mirrored 2N complex FFT  " << (t2 - t1) * scale << "us" << std::endl;
+   
+   return 0;
+}
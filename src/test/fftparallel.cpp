@@ -0,0 +1,105 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/fft.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using namespace gmath;
+
+typedef Complex<float> fComplex;
+
+static double MaxError(int n, const fComplex *a, const fComplex *b)
+{
+   double err = 0.0;
+   for (int i=0; i<n; ++i)
+   {
+      double e = sqrt(double((a[i] - b[i]).squaredNorm()));
+      if (e > err)
+      {
+         err = e;
+      }
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   const int W = 64;
+   const int H = 32;
+   const int D = 16;
+   const int N = W * H * D;
+   
+   fComplex *input = new fComplex[N];
+   fComplex *output1 = new fComplex[N];
+   fComplex *outputN = new fComplex[N];
+   fComplex *roundtrip = new fComplex[N];
+   
+   srand(1234);
+   for (int i=0; i<N; ++i)
+   {
+      input[i].re = float(rand()) / float(RAND_MAX);
+      input[i].im = 0.0f;
+   }
+   
+   std::cout << "=== 3D FFT (" << W << "x" << H << "x" << D << ")" << std::endl;
+   
+   size_t defaultThreads = Parallel::GetThreadCount();
+   
+   Parallel::SetThreadCount(1);
+   clock_t t0 = clock();
+   FFT::Forward(W, H, D, input, output1);
+   clock_t t1 = clock();
+   std::cout << "  1 thread: " << (double(t1 - t0) / CLOCKS_PER_SEC) << "s (cpu)" << std::endl;
+   
+   Parallel::SetThreadCount(4);
+   FFT::Forward(W, H, D, input, outputN);
+   std::cout << "  4 threads: " << (memcmp(output1, outputN, N * sizeof(fComplex)) == 0 ? "identical" : "DIFFERENT") << std::endl;
+   
+   Parallel::SetThreadCount(defaultThreads);
+   FFT::Inverse(W, H, D, outputN, roundtrip);
+   std::cout << "  round trip max error: " << MaxError(N, input, roundtrip) << std::endl;
+   
+   std::cout << "=== Batched 1D FFT (" << H*D << " x " << W << ")" << std::endl;
+   
+   for (int i=0, off=0; i<H*D; ++i, off+=W)
+   {
+      FFT::Forward(W, input+off, output1+off);
+   }
+   FFT::ForwardBatch(W, H*D, input, outputN);
+   std::cout << "  batch vs loop: " << (memcmp(output1, outputN, N * sizeof(fComplex)) == 0 ? "identical" : "DIFFERENT") << std::endl;
+   
+   FFT::InverseBatch(W, H*D, outputN);
+   std::cout << "  in-place round trip max error: " << MaxError(N, input, outputN) << std::endl;
+   
+   delete[] input;
+   delete[] output1;
+   delete[] outputN;
+   delete[] roundtrip;
+   
+   return 0;
+}
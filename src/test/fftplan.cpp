@@ -0,0 +1,132 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/fft.h>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+typedef Complex<float> fComplex;
+typedef Complex<double> dComplex;
+
+static double MaxError(int n, const fComplex *a, const dComplex *b)
+{
+   double err = 0.0;
+   for (int i=0; i<n; ++i)
+   {
+      double dr = double(a[i].re) - b[i].re;
+      double di = double(a[i].im) - b[i].im;
+      err = std::max(err, sqrt(dr * dr + di * di));
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   std::cout << "Out-of-place forward FFT: error vs double precision, time per transform and memory passes" << std::endl;
+   
+   for (int log2N=4; log2N<=20; log2N+=4)
+   {
+      int N = 1 << log2N;
+      int reps = std::max(1, (1 << 22) / (N * log2N));
+      
+      std::vector<fComplex> src(N), dst(N);
+      std::vector<dComplex> dsrc(N), ref(N);
+      
+      for (int i=0; i<N; ++i)
+      {
+         src[i] = fComplex(float(rand()) / RAND_MAX - 0.5f, float(rand()) / RAND_MAX - 0.5f);
+         dsrc[i] = dComplex(src[i].re, src[i].im);
+      }
+      FFT::Forward(N, &dsrc[0], &ref[0]);
+      
+      FFTPlan<float> bitrev(N, FFTPlan<float>::BitReversal);
+      FFTPlan<float> stockham(N, FFTPlan<float>::Stockham);
+      
+      clock_t t0 = clock();
+      for (int r=0; r<reps; ++r)
+      {
+         FFT::Forward(N, &src[0], &dst[0]);
+      }
+      clock_t t1 = clock();
+      double errFFT = MaxError(N, &dst[0], &ref[0]);
+      
+      for (int r=0; r<reps; ++r)
+      {
+         bitrev.forward(&src[0], &dst[0]);
+      }
+      clock_t t2 = clock();
+      double errBitRev = MaxError(N, &dst[0], &ref[0]);
+      
+      for (int r=0; r<reps; ++r)
+      {
+         stockham.forward(&src[0], &dst[0]);
+      }
+      clock_t t3 = clock();
+      double errStockham = MaxError(N, &dst[0], &ref[0]);
+      
+      double scale = 1e6 / (double(CLOCKS_PER_SEC) * reps);
+      
+      // passes over the N samples: permutation + log2(N) butterfly passes vs log2(N) self-sorting passes
+      std::cout << "  N = " << N << std::endl;
+      std::cout << "    FFT::Forward          " << (t1 - t0) * scale << "us, error " << errFFT << ", " << (log2N + 1) << " passes" << std::endl;
+      std::cout << "    FFTPlan (BitReversal) " << (t2 - t1) * scale << "us, error " << errBitRev << ", " << (log2N + 1) << " passes" << std::endl;
+      std::cout << "    FFTPlan (Stockham)    " << (t3 - t2) * scale << "us, error " << errStockham << ", " << log2N << " passes" << std::endl;
+      
+      // round trips (out-of-place and in-place, even and odd pass count)
+      std::vector<fComplex> back(N);
+      stockham.inverse(&dst[0], &back[0]);
+      stockham.forward(&back[0]);
+      stockham.inverse(&back[0]);
+      float rtErr = 0.0f;
+      for (int i=0; i<N; ++i)
+      {
+         rtErr = std::max(rtErr, Sqrt((back[i] - src[i]).squaredNorm()));
+      }
+      std::cout << "    Stockham round trip error " << rtErr << std::endl;
+   }
+   
+   // odd pass count in-place
+   FFTPlan<float> p8(8);
+   fComplex a[8], b[8];
+   for (int i=0; i<8; ++i)
+   {
+      a[i] = b[i] = fComplex(float(i), float(-i));
+   }
+   p8.forward(a);
+   FFT::Forward(8, b);
+   float err8 = 0.0f;
+   for (int i=0; i<8; ++i)
+   {
+      err8 = std::max(err8, Sqrt((a[i] - b[i]).squaredNorm()));
+   }
+   std::cout << "  N = 8 in-place Stockham vs FFT::Forward error " << err8 << std::endl;
+   
+   return 0;
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/frustum.h>
+#include <gmath/aabox.h>
+#include <gmath/obox.h>
+#include <gmath/sphere.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+static float Random(float lo, float hi) {
+  return lo + (hi - lo) * float(rand()) / RAND_MAX;
+}
+
+// Reference: sample points of the volume against the frustum
+static Frustum::Visibility Sampled(const Frustum &f, const AABox &b) {
+  int in = 0;
+  int total = 0;
+  for (int i=0; i<=8; ++i) {
+    for (int j=0; j<=8; ++j) {
+      for (int k=0; k<=8; ++k, ++total) {
+        Vector3 t(i / 8.0f, j / 8.0f, k / 8.0f);
+        Vector3 p = b.getMin() + t * (b.getMax() - b.getMin());
+        in += (f.isPointInside(p) ? 1 : 0);
+      }
+    }
+  }
+  return (in == 0 ? Frustum::OUTSIDE : (in == total ? Frustum::INSIDE : Frustum::INTERSECTING));
+}
+
+int main(int, char**) {
+  srand(1234);
+  
+  Frustum f(PM_PERSPECTIVE, 60.0f, 16.0f / 9.0f, 1.0f, 500.0f);
+  
+  std::cout << "Center " << f.classify(Sphere(Vector3(0, 0, -50), 1)) << " (expected " << Frustum::INSIDE << ")" << std::endl;
+  std::cout << "Behind " << f.classify(Sphere(Vector3(0, 0, 10), 1)) << " (expected " << Frustum::OUTSIDE << ")" << std::endl;
+  std::cout << "Near plane " << f.classify(AABox(Vector3(-1, -1, -2), Vector3(1, 1, 0))) << " (expected " << Frustum::INTERSECTING << ")" << std::endl;
+  
+  // Classification must agree with point sampling, except that boxes near frustum
+  // edges may be conservatively reported as intersecting
+  size_t n = 100000;
+  std::vector<float> center[3], extents[3], radius(n);
+  std::vector<AABox> boxes(n);
+  for (int c=0; c<3; ++c) {
+    center[c].resize(n);
+    extents[c].resize(n);
+  }
+  for (size_t i=0; i<n; ++i) {
+    Vector3 c(Random(-400, 400), Random(-250, 250), Random(-550, 50));
+    Vector3 e(Random(0.5f, 20), Random(0.5f, 20), Random(0.5f, 20));
+    boxes[i] = AABox(c - e, c + e);
+    center[0][i] = c.x; center[1][i] = c.y; center[2][i] = c.z;
+    extents[0][i] = e.x; extents[1][i] = e.y; extents[2][i] = e.z;
+    radius[i] = e.getLength();
+  }
+  
+  size_t wrong = 0;
+  size_t conservative = 0;
+  size_t checked = 0;
+  for (size_t i=0; i<n; i+=50, ++checked) {
+    Frustum::Visibility v = f.classify(boxes[i]);
+    Frustum::Visibility r = Sampled(f, boxes[i]);
+    if (v != r) {
+      if (v == Frustum::INTERSECTING && r == Frustum::OUTSIDE) {
+        ++conservative;
+      } else {
+        ++wrong;
+      }
+    }
+  }
+  std::cout << "AABox: " << wrong << " wrong, " << conservative << " conservative out of " << checked << std::endl;
+  
+  // OBox with identity orientation and AABox must agree
+  size_t mismatch = 0;
+  for (size_t i=0; i<n; i+=10) {
+    OBox ob(boxes[i].getMin(), boxes[i].getMax());
+    mismatch += (f.classify(ob) != f.classify(boxes[i]) ? 1 : 0);
+  }
+  std::cout << "OBox vs AABox: " << mismatch << " mismatch" << std::endl;
+  
+  // Batch versus scalar
+  std::vector<unsigned char> results(n);
+  const float *cp[3] = {&center[0][0], &center[1][0], &center[2][0]};
+  const float *ep[3] = {&extents[0][0], &extents[1][0], &extents[2][0]};
+  
+  double scale = 1000.0 / CLOCKS_PER_SEC;
+  int repeat = 20;
+  
+  clock_t t0 = clock();
+  size_t visible = 0;
+  for (int r=0; r<repeat; ++r) {
+    visible = 0;
+    for (size_t i=0; i<n; ++i) {
+      visible += (f.classify(boxes[i]) != Frustum::OUTSIDE ? 1 : 0);
+    }
+  }
+  clock_t t1 = clock();
+  size_t bvisible = 0;
+  for (int r=0; r<repeat; ++r) {
+    bvisible = f.classify(cp, ep, n, &results[0]);
+  }
+  clock_t t2 = clock();
+  
+  mismatch = 0;
+  for (size_t i=0; i<n; ++i) {
+    mismatch += (results[i] != f.classify(boxes[i]) ? 1 : 0);
+  }
+  std::cout << n << " boxes, " << visible << " visible" << std::endl;
+  std::cout << "  scalar " << (t1 - t0) * scale / repeat << "ms" << std::endl;
+  std::cout << "  batch  " << (t2 - t1) * scale / repeat << "ms, " << bvisible << " visible, " << mismatch << " mismatch" << std::endl;
+  
+  mismatch = 0;
+  bvisible = f.classify(cp, &radius[0], n, &results[0]);
+  for (size_t i=0; i<n; ++i) {
+    Sphere s(Vector3(center[0][i], center[1][i], center[2][i]), radius[i]);
+    mismatch += (results[i] != f.classify(s) ? 1 : 0);
+  }
+  std::cout << "  spheres " << bvisible << " visible, " << mismatch << " mismatch" << std::endl;
+  
+  // Plane masks: with the masks left by a first pass, a second pass gives the same results
+  std::vector<unsigned char> masks(n, Frustum::ALL_PLANES_MASK), again(n);
+  f.classify(cp, ep, n, &results[0], &masks[0]);
+  f.classify(cp, ep, n, &again[0], &masks[0]);
+  mismatch = 0;
+  for (size_t i=0; i<n; ++i) {
+    mismatch += (results[i] != again[i] ? 1 : 0);
+  }
+  std::cout << "  masked second pass " << mismatch << " mismatch" << std::endl;
+  
+  // Hierarchical scalar version
+  mismatch = 0;
+  unsigned char last = 0;
+  for (size_t i=0; i<n; ++i) {
+    unsigned char mask = Frustum::ALL_PLANES_MASK;
+    mismatch += (f.classify(boxes[i], mask, last) != f.classify(boxes[i]) ? 1 : 0);
+  }
+  std::cout << "  coherent scalar " << mismatch << " mismatch" << std::endl;
+  
+  return 0;
+}
@@ -0,0 +1,157 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+struct NamedFunction
+{
+   const char *name;
+   Gamma::Function gf;
+};
+
+static float MaxError(size_t n, const float *values, const float *ref)
+{
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      if (ref[i] != ref[i])
+      {
+         continue;
+      }
+      err = std::max(err, Abs(values[i] - ref[i]) / std::max(1.0f, Abs(ref[i])));
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   NamedFunction functions[] =
+   {
+      {"Power22", Gamma::Power22},
+      {"Power24", Gamma::Power24},
+      {"sRGB", Gamma::sRGB},
+      {"Rec709", Gamma::Rec709},
+      {"Rec2020", Gamma::Rec2020},
+      {"LogCv2 EL160", Gamma::Function(Gamma::LogCv2 + Gamma::EL160)},
+      {"LogCv2", Gamma::LogCv2},
+      {"LogCv3 EL160", Gamma::Function(Gamma::LogCv3 + Gamma::EL160)},
+      {"LogCv3", Gamma::LogCv3},
+      {"LogCv3 EL1600", Gamma::Function(Gamma::LogCv3 + Gamma::EL1600)},
+      {"Cineon", Gamma::Cineon}
+   };
+   size_t nfuncs = sizeof(functions) / sizeof(NamedFunction);
+   
+   // encoded values: dense sampling of [0, 1], linear values: log sampling of [2^-16, 2^8] and [0, 1]
+   size_t n = 1 << 20;
+   std::vector<float> encoded(n), linear(2 * n), out(2 * n), ref(2 * n);
+   for (size_t i=0; i<n; ++i)
+   {
+      encoded[i] = float(i) / float(n - 1);
+      linear[i] = powf(2.0f, -16.0f + 24.0f * float(i) / float(n - 1));
+      linear[n + i] = float(i) / float(n - 1);
+   }
+   
+   std::cout << "Max error vs scalar functions (relative to max(1, |value|)), scalar / batch time" << std::endl;
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   
+   for (size_t f=0; f<nfuncs; ++f)
+   {
+      Gamma::Function gf = functions[f].gf;
+      
+      clock_t t0 = clock();
+      for (size_t i=0; i<n; i+=3)
+      {
+         RGB c = Gamma::Linearize(RGB(encoded[i], encoded[i + 1 < n ? i + 1 : i], encoded[i + 2 < n ? i + 2 : i]), gf);
+         ref[i] = c.r;
+         if (i + 1 < n) ref[i + 1] = c.g;
+         if (i + 2 < n) ref[i + 2] = c.b;
+      }
+      clock_t t1 = clock();
+      Gamma::Linearize(&encoded[0], &out[0], n, gf);
+      clock_t t2 = clock();
+      float lerr = MaxError(n, &out[0], &ref[0]);
+      
+      for (size_t i=0; i<2*n; ++i)
+      {
+         ref[i] = Gamma::Unlinearize(RGB(linear[i]), gf).r;
+      }
+      Gamma::Unlinearize(&linear[0], &out[0], 2 * n, gf);
+      float uerr = MaxError(2 * n, &out[0], &ref[0]);
+      
+      std::cout << "  " << functions[f].name << std::endl;
+      std::cout << "    Linearize   error " << lerr << ", " << (t1 - t0) * scale << "ms / " << (t2 - t1) * scale << "ms" << std::endl;
+      std::cout << "    Unlinearize error " << uerr << std::endl;
+      
+      // integer codes are exact
+      bool exact = true;
+      for (int bits=8; bits<=16; bits+=2)
+      {
+         size_t count = size_t(1) << bits;
+         std::vector<unsigned short> codes(count);
+         std::vector<float> values(count);
+         for (size_t i=0; i<count; ++i)
+         {
+            codes[i] = (unsigned short) i;
+         }
+         Gamma::Linearize(&codes[0], bits, &values[0], count, gf);
+         for (size_t i=0; i<count; ++i)
+         {
+            float v = Gamma::Linearize(RGB(float(i) / float(count - 1)), gf).r;
+            exact = exact && (v == values[i] || (v != v && values[i] != values[i]));
+         }
+      }
+      unsigned char codes8[256];
+      float values8[256];
+      for (int i=0; i<256; ++i)
+      {
+         codes8[i] = (unsigned char) i;
+      }
+      Gamma::Linearize(codes8, values8, 256, gf);
+      for (int i=0; i<256; ++i)
+      {
+         float v = Gamma::Linearize(RGB(float(i) / 255.0f), gf).r;
+         exact = exact && (v == values8[i] || (v != v && values8[i] != values8[i]));
+      }
+      std::cout << "    Integer codes exact: " << (exact ? "yes" : "no") << std::endl;
+      
+      // 8 bits round trip (Rec2020 has no Linearize and Cineon clamps codes below black)
+      Gamma::Unlinearize(values8, codes8, 256, gf);
+      int maxDiff = 0;
+      for (int i=0; i<256; ++i)
+      {
+         maxDiff = std::max(maxDiff, std::abs(int(codes8[i]) - i));
+      }
+      std::cout << "    8 bits round trip max code difference: " << maxDiff << std::endl;
+   }
+   
+   return 0;
+}
@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/gamut.h>
+#include <gmath/colorpipeline.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &src = ColorSpace::ACES_AP0;
+   const ColorSpace &dst = ColorSpace::Rec709;
+   
+   // Wide gamut colors seen in Rec. 709, about half of them out of gamut
+   size_t n = 1920 * 1080;
+   std::vector<float> in(3 * n), out(3 * n);
+   for (size_t i=0; i<3*n; ++i)
+   {
+      in[i] = float(rand()) / RAND_MAX;
+   }
+   ColorPipeline toDst;
+   toDst.RGBtoRGB(src, dst, CAT_Bradford);
+   toDst.apply(&in[0], &in[0], n);
+   
+   GamutMapper gm(dst);
+   
+   std::vector<unsigned char> mask(n);
+   clock_t t0 = clock();
+   size_t nout = gm.classify(&in[0], &mask[0], n);
+   clock_t t1 = clock();
+   
+   size_t nref = 0;
+   bool maskOk = true;
+   for (size_t i=0; i<n; ++i)
+   {
+      bool o = !gm.inGamut(RGB(&in[3 * i]));
+      nref += (o ? 1 : 0);
+      maskOk = maskOk && (mask[i] == (o ? 1 : 0));
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << n << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   std::cout << "classify: " << (t1 - t0) * scale << "ms, " << nout << " out of gamut (expected " << nref << "), mask " << (maskOk ? "ok" : "wrong") << std::endl;
+   
+   const char *names[] = {"Clip", "Desaturate", "Compress"};
+   
+   for (int m=0; m<3; ++m)
+   {
+      gm.setMethod(GamutMapper::Method(m));
+      
+      t0 = clock();
+      for (size_t i=0; i<n; ++i)
+      {
+         RGB c = gm(RGB(&in[3 * i]));
+         out[3 * i] = c.r;
+         out[3 * i + 1] = c.g;
+         out[3 * i + 2] = c.b;
+      }
+      t1 = clock();
+      std::vector<float> bout(3 * n);
+      gm.apply(&in[0], &bout[0], n);
+      clock_t t2 = clock();
+      
+      float err = 0.0f;
+      size_t stillOut = 0;
+      size_t changedIn = 0;
+      float dL = 0.0f;
+      float dh = 0.0f;
+      for (size_t i=0; i<n; ++i)
+      {
+         for (int c=0; c<3; ++c)
+         {
+            err = std::max(err, Abs(out[3 * i + c] - bout[3 * i + c]));
+         }
+         RGB o(&bout[3 * i]);
+         RGB c(&in[3 * i]);
+         stillOut += (gm.inGamut(o) ? 0 : 1);
+         if (!mask[i])
+         {
+            changedIn += (o.r != c.r || o.g != c.g || o.b != c.b ? 1 : 0);
+         }
+         else if (m == GamutMapper::Desaturate && dst.luminance(c) > 0.01f)
+         {
+            LAB l0 = dst.XYZtoLAB(dst.RGBtoXYZ(c));
+            LAB l1 = dst.XYZtoLAB(dst.RGBtoXYZ(o));
+            dL = std::max(dL, Abs(l0.l - l1.l));
+            float C0 = sqrtf(l0.a * l0.a + l0.b * l0.b);
+            float C1 = sqrtf(l1.a * l1.a + l1.b * l1.b);
+            if (C0 > 1.0f && C1 > 1.0f)
+            {
+               // hue difference as the cross product of unit chroma vectors
+               dh = std::max(dh, Abs(l0.a * l1.b - l0.b * l1.a) / (C0 * C1));
+            }
+         }
+      }
+      
+      std::cout << names[m] << std::endl;
+      std::cout << "  per pixel calls " << (t1 - t0) * scale << "ms" << std::endl;
+      std::cout << "  batch           " << (t2 - t1) * scale << "ms, error " << err << std::endl;
+      std::cout << "  out of gamut after mapping: " << stillOut << ", in gamut pixels changed: " << changedIn << std::endl;
+      if (m == GamutMapper::Desaturate)
+      {
+         std::cout << "  max lightness change " << dL << ", max sin(hue change) " << dh << std::endl;
+      }
+   }
+   
+   // Compression: distance limits map to 1 (gamut boundary), below threshold is untouched
+   gm.setMethod(GamutMapper::Compress);
+   RGB atLimit(1.0f, 1.0f - 1.264f, 1.0f - 1.312f);
+   RGB below(0.5f, 0.5f, 1.0f);
+   std::cout << "Compress " << atLimit << " -> " << gm(atLimit) << ", " << below << " -> " << gm(below) << std::endl;
+   
+   // Bounded
+   GamutMapper bounded(dst, GamutMapper::Desaturate, true);
+   RGB bright(1.5f, 0.2f, 0.1f);
+   std::cout << "Bounded desaturate " << bright << " -> " << bounded(bright) << std::endl;
+   
+   return 0;
+}
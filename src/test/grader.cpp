@@ -0,0 +1,200 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/grader.h>
+#include <gmath/colorpipeline.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <cfloat>
+#include <ctime>
+
+using namespace gmath;
+
+static float MaxError(const std::vector<float> &a, const std::vector<float> &b, bool relative)
+{
+   float err = 0.0f;
+   for (size_t i=0; i<a.size(); ++i)
+   {
+      float d = float(fabs(a[i] - b[i]));
+      if (relative)
+      {
+         d /= std::max(float(fabs(b[i])), 1e-3f);
+      }
+      err = std::max(err, d);
+   }
+   return err;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   RGB black(0.02f, 0.01f, 0.03f);
+   RGB white(0.95f, 1.05f, 0.9f);
+   RGB lift(0.05f, 0.0f, 0.02f);
+   RGB gain(1.1f, 0.95f, 1.0f);
+   RGB gamma(1.2f, 1.0f, 0.8f);
+   
+   size_t n = 1920 * 1080;
+   std::vector<float> in(3 * n), out(3 * n), ref(3 * n);
+   for (size_t i=0; i<3*n; ++i)
+   {
+      in[i] = 2.0f * float(rand()) / RAND_MAX - 0.1f;
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << n << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   
+   // Without gamma: same as Grade()
+   clock_t t0 = clock();
+   for (size_t i=0; i<n; ++i)
+   {
+      RGB c = Grade(RGB(&in[3 * i]), black, white, lift, gain);
+      ref[3 * i + 0] = c.r;
+      ref[3 * i + 1] = c.g;
+      ref[3 * i + 2] = c.b;
+   }
+   clock_t t1 = clock();
+   
+   Grader linear(black, white, lift, gain);
+   clock_t t2 = clock();
+   linear.apply(&in[0], &out[0], n);
+   clock_t t3 = clock();
+   
+   std::cout << "Grade: " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "Grader: " << (t3 - t2) * scale << "ms, max error " << MaxError(out, ref, false) << std::endl;
+   
+   // With gamma: compared to powf on the linear grade
+   Grader graded(black, white, lift, gain, gamma);
+   for (size_t i=0; i<3*n; ++i)
+   {
+      float g = gamma[i % 3];
+      ref[i] = (out[i] > 0.0f ? powf(out[i], 1.0f / g) : out[i]);
+   }
+   
+   t0 = clock();
+   graded.apply(&in[0], &out[0], n);
+   t1 = clock();
+   std::cout << "Grader (gamma): " << (t1 - t0) * scale << "ms, max relative error " << MaxError(out, ref, true) << std::endl;
+   
+   // Planar and half float
+   std::vector<float> planes(3 * n);
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         planes[c * n + i] = in[3 * i + c];
+      }
+   }
+   float *p[3] = {&planes[0], &planes[n], &planes[2 * n]};
+   graded.apply(p, p, n);
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         out[3 * i + c] = p[c][i];
+      }
+   }
+   std::cout << "Grader (gamma, planar): max relative error " << MaxError(out, ref, true) << std::endl;
+   
+   std::vector<Half> hin(3 * n), hout(3 * n);
+   FloatToHalf(&in[0], &hin[0], 3 * n);
+   graded.apply(&hin[0], &hout[0], n);
+   HalfToFloat(&hout[0], &out[0], 3 * n);
+   HalfToFloat(&hin[0], &planes[0], 3 * n);
+   for (size_t i=0; i<3*n; ++i)
+   {
+      ref[i] = graded(RGB(&planes[3 * (i / 3)]))[i % 3];
+   }
+   std::cout << "Grader (gamma, half): max relative error " << MaxError(out, ref, true) << std::endl;
+   
+   // tiny and huge values: subnormal inputs and results beyond the Exp2 range
+   {
+      const float tiny[8] = {1e-40f, 1e-39f, 0.5f * FLT_MIN, FLT_MIN, 1e-30f, 1e-20f, 1e20f, 1e30f};
+      float terr = 0.0f;
+      for (int k=0; k<2; ++k)
+      {
+         float g = (k == 0 ? 0.5f : 2.0f);
+         Grader tg(RGB(0.0f, 0.0f, 0.0f), RGB(1.0f, 1.0f, 1.0f), RGB(0.0f, 0.0f, 0.0f), RGB(1.0f, 1.0f, 1.0f), RGB(g, g, g));
+         std::vector<float> tin(3 * 8), tout(3 * 8);
+         for (size_t i=0; i<tin.size(); ++i)
+         {
+            tin[i] = tiny[i % 8];
+         }
+         tg.apply(&tin[0], &tout[0], 8);
+         for (size_t i=0; i<tin.size(); ++i)
+         {
+            float r = powf(tin[i], 1.0f / g);
+            float d = float(fabs(tout[i] - r));
+            terr = std::max(terr, (r > 0.0f ? d / r : d));
+         }
+      }
+      std::cout << "Grader (gamma, tiny and huge values): max relative error " << terr << std::endl;
+   }
+   
+   std::cout << "Invalid setup rejected: " << (!linear.set(black, black, lift, gain) ? "yes" : "no") << std::endl;
+   
+   // Fusion: a grade without gamma between color space conversions folds into a single stage
+   const ColorSpace &cs = ColorSpace::UHDTV;
+   
+   ColorPipeline pl;
+   pl.XYZtoRGB(cs).grade(linear).RGBtoXYZ(cs);
+   std::cout << "Pipeline (no gamma): " << pl.getStageCount() << " stage(s)" << std::endl;
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      RGB c = Grade(cs.XYZtoRGB(XYZ(&in[3 * i])), black, white, lift, gain);
+      XYZ x = cs.RGBtoXYZ(c);
+      ref[3 * i + 0] = x.x;
+      ref[3 * i + 1] = x.y;
+      ref[3 * i + 2] = x.z;
+   }
+   t0 = clock();
+   pl.apply(&in[0], &out[0], n);
+   t1 = clock();
+   std::cout << "  " << (t1 - t0) * scale << "ms, max error " << MaxError(out, ref, false) << std::endl;
+   
+   pl.clear();
+   pl.XYZtoRGB(cs).grade(graded).RGBtoXYZ(cs);
+   std::cout << "Pipeline (gamma): " << pl.getStageCount() << " stage(s)" << std::endl;
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      XYZ x = cs.RGBtoXYZ(graded(cs.XYZtoRGB(XYZ(&in[3 * i]))));
+      ref[3 * i + 0] = x.x;
+      ref[3 * i + 1] = x.y;
+      ref[3 * i + 2] = x.z;
+   }
+   t0 = clock();
+   pl.apply(&in[0], &out[0], n);
+   t1 = clock();
+   std::cout << "  " << (t1 - t0) * scale << "ms, max error " << MaxError(out, ref, false) << std::endl;
+   
+   return 0;
+}
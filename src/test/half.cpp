@@ -0,0 +1,241 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/colorpipeline.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+// Straightforward bit manipulation version, round to nearest even
+static unsigned short ReferenceFloatToHalf(float f)
+{
+   unsigned int bits;
+   memcpy(&bits, &f, sizeof(float));
+   
+   unsigned short sign = (unsigned short)((bits >> 16) & 0x8000);
+   unsigned int a = bits & 0x7FFFFFFF;
+   
+   if (a >= 0x7F800000)
+   {
+      return sign | 0x7C00 | (a > 0x7F800000 ? 0x200 | ((a >> 13) & 0x3FF) : 0);
+   }
+   if (a >= 0x477FF000)
+   {
+      return sign | 0x7C00;
+   }
+   if (a < 0x38800000)
+   {
+      float v;
+      memcpy(&v, &a, sizeof(float));
+      v += 0.5f;
+      unsigned int vb;
+      memcpy(&vb, &v, sizeof(float));
+      return sign | (unsigned short)(vb - 0x3F000000);
+   }
+   unsigned int odd = (a >> 13) & 1;
+   a += 0xC8000FFF + odd;
+   return sign | (unsigned short)(a >> 13);
+}
+
+static unsigned int RandomBits()
+{
+   return ((unsigned int)(rand() & 0xFFFF) << 16) | (unsigned int)(rand() & 0xFFFF);
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   std::cout << "F16C: " << (HasF16C() ? "yes" : "no") << std::endl;
+   
+   // All halves to float and back
+   std::vector<Half> h(65536), h2(65536);
+   std::vector<float> f(65536);
+   for (size_t i=0; i<65536; ++i)
+   {
+      h[i].bits = (unsigned short) i;
+   }
+   HalfToFloat(&h[0], &f[0], h.size());
+   FloatToHalf(&f[0], &h2[0], f.size());
+   
+   size_t mismatches = 0;
+   size_t roundTripErrors = 0;
+   for (size_t i=0; i<65536; ++i)
+   {
+      // bit exact, NaNs included (signaling NaNs come out quiet on both paths)
+      float s = HalfToFloat(h[i]);
+      if (memcmp(&s, &f[i], sizeof(float)) != 0)
+      {
+         ++mismatches;
+      }
+      bool nan = (s != s);
+      if (h2[i].bits != (nan ? (h[i].bits | 0x0200) : h[i].bits))
+      {
+         ++roundTripErrors;
+      }
+   }
+   std::cout << "Half to float, array vs scalar mismatches: " << mismatches << std::endl;
+   std::cout << "Half to float to half round trip errors: " << roundTripErrors << std::endl;
+   
+   // Random bit patterns over all exponents, plus values halfway between two halves
+   size_t n = 1 << 22;
+   std::vector<float> in(n);
+   std::vector<Half> out(n);
+   for (size_t i=0; i<n; ++i)
+   {
+      if (i % 2 == 0)
+      {
+         unsigned int bits = RandomBits();
+         memcpy(&in[i], &bits, sizeof(float));
+      }
+      else
+      {
+         unsigned int bits;
+         float hf = f[rand() & 0x7BFF];
+         memcpy(&bits, &hf, sizeof(float));
+         bits += (hf < 6.103515625e-05f ? 0 : 0x1000);
+         memcpy(&in[i], &bits, sizeof(float));
+         if (hf < 6.103515625e-05f)
+         {
+            in[i] += 2.98023223876953125e-08f;
+         }
+      }
+   }
+   
+   clock_t t0 = clock();
+   FloatToHalf(&in[0], &out[0], n);
+   clock_t t1 = clock();
+   
+   size_t arrayErrors = 0;
+   size_t scalarErrors = 0;
+   for (size_t i=0; i<n; ++i)
+   {
+      unsigned short r = ReferenceFloatToHalf(in[i]);
+      unsigned short s = FloatToHalf(in[i]).bits;
+      if (in[i] != in[i])
+      {
+         // NaN payloads may differ, only check NaN-ness
+         arrayErrors += ((out[i].bits & 0x7C00) != 0x7C00 || (out[i].bits & 0x3FF) == 0 ? 1 : 0);
+         scalarErrors += ((s & 0x7C00) != 0x7C00 || (s & 0x3FF) == 0 ? 1 : 0);
+         continue;
+      }
+      arrayErrors += (out[i].bits != r ? 1 : 0);
+      scalarErrors += (s != r ? 1 : 0);
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   
+   std::cout << "Float to half, " << n << " values, " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  array errors: " << arrayErrors << std::endl;
+   std::cout << "  scalar errors: " << scalarErrors << std::endl;
+   std::cout << "  65519 -> " << HalfToFloat(FloatToHalf(65519.0f)) << ", 65520 -> " << HalfToFloat(FloatToHalf(65520.0f)) << std::endl;
+   
+   // Batch color conversions on RGBA half pixels
+   const ColorSpace &cs = ColorSpace::Rec709;
+   
+   size_t npixels = 1920 * 1080;
+   std::vector<Half> rgba(4 * npixels), xyza(4 * npixels);
+   std::vector<float> frgba(4 * npixels), fxyza(4 * npixels);
+   for (size_t i=0; i<4*npixels; ++i)
+   {
+      rgba[i] = FloatToHalf(i % 4 == 3 ? 0.5f : 4.0f * float(rand()) / RAND_MAX);
+   }
+   HalfToFloat(&rgba[0], &frgba[0], rgba.size());
+   
+   t0 = clock();
+   cs.RGBtoXYZ(&rgba[0], &xyza[0], npixels, 4);
+   t1 = clock();
+   cs.RGBtoXYZ(&frgba[0], &fxyza[0], npixels, 4);
+   
+   // float results rounded to half must match exactly
+   size_t diffs = 0;
+   bool alphaOk = true;
+   for (size_t i=0; i<npixels; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         diffs += (FloatToHalf(fxyza[4 * i + c]).bits != xyza[4 * i + c].bits ? 1 : 0);
+      }
+      alphaOk = alphaOk && (xyza[4 * i + 3].bits == 0);
+   }
+   std::cout << "RGBtoXYZ half RGBA, " << npixels << " pixels, " << Parallel::GetThreadCount() << " thread(s): " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  differences with float path: " << diffs << std::endl;
+   std::cout << "  alpha untouched: " << (alphaOk ? "yes" : "no") << std::endl;
+   
+   // Planar, in place, round trip
+   std::vector<Half> planes(3 * npixels);
+   for (size_t i=0; i<npixels; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         planes[c * npixels + i] = rgba[4 * i + c];
+      }
+   }
+   Half *pp[3] = {&planes[0], &planes[npixels], &planes[2 * npixels]};
+   cs.RGBtoXYZ(pp, pp, npixels);
+   cs.XYZtoRGB(pp, pp, npixels);
+   float err = 0.0f;
+   for (size_t i=0; i<npixels; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         float v = HalfToFloat(rgba[4 * i + c]);
+         err = std::max(err, Abs(HalfToFloat(pp[c][i]) - v) / std::max(v, 1.0f));
+      }
+   }
+   std::cout << "Planar half RGB to XYZ to RGB relative error: " << err << std::endl;
+   
+   // Tone mapping
+   ToneMappingOperator tmo(cs);
+   tmo.setMethod(ToneMappingOperator::Reinhard);
+   tmo.validate();
+   ColorPipeline pipeline;
+   pipeline.toneMap(tmo).unlinearize(Gamma::sRGB);
+   
+   std::vector<Half> display(rgba);
+   std::vector<float> fdisplay(frgba);
+   t0 = clock();
+   pipeline.apply(&display[0], &display[0], npixels, 4);
+   t1 = clock();
+   pipeline.apply(&fdisplay[0], &fdisplay[0], npixels, 4);
+   
+   diffs = 0;
+   for (size_t i=0; i<npixels; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         diffs += (FloatToHalf(fdisplay[4 * i + c]).bits != display[4 * i + c].bits ? 1 : 0);
+      }
+   }
+   std::cout << "Tone map + sRGB pipeline, half RGBA in place: " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  differences with float path: " << diffs << std::endl;
+   
+   return 0;
+}
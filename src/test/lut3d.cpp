@@ -0,0 +1,147 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/lut3d.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+static float MaxError(size_t n, const float *a, const float *b)
+{
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      err = std::max(err, Abs(a[i] - b[i]));
+   }
+   return err;
+}
+
+static void Grade(const float *in, float *out, size_t npixels, void *)
+{
+   RGB black(0.02f), white(0.9f, 0.95f, 1.0f), lift(0.0f), gain(1.0f);
+   for (size_t i=0; i<npixels; ++i, in+=3, out+=3)
+   {
+      RGB c = gmath::Grade(RGB(in), black, white, lift, gain);
+      c = Gamma::Unlinearize(c, Gamma::sRGB);
+      out[0] = c.r;
+      out[1] = c.g;
+      out[2] = c.b;
+   }
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   size_t n = 1920 * 1080;
+   std::vector<float> in(3 * n), ref(3 * n), out(3 * n);
+   
+   // identity
+   LUT3D identity;
+   identity.setup(17, -1.0f, 2.0f);
+   for (size_t i=0; i<3*n; ++i)
+   {
+      in[i] = -1.0f + 3.0f * float(rand()) / RAND_MAX;
+   }
+   identity.apply(&in[0], &out[0], n);
+   std::cout << "Identity LUT error " << MaxError(3 * n, &out[0], &in[0]) << std::endl;
+   
+   // display transform from scene linear ALEXA Wide Gamut (LogC shaper)
+   const ColorSpace &src = ColorSpace::AlexaWide;
+   const ColorSpace &dst = ColorSpace::Rec709;
+   
+   ToneMappingOperator tmo(dst);
+   Params params;
+   params.set("Lavg", 0.18f);
+   params.set("Lwht", 8.0f);
+   tmo.setMethod(ToneMappingOperator::Reinhard, params);
+   
+   ColorPipeline pipeline;
+   pipeline.RGBtoXYZ(src)
+           .adapt(ChromaticityYtoXYZ(src.getWhitePoint(), 1.0f), ChromaticityYtoXYZ(dst.getWhitePoint(), 1.0f), CAT_Bradford)
+           .XYZtoRGB(dst)
+           .toneMap(tmo)
+           .unlinearize(Gamma::Rec709);
+   
+   for (size_t i=0; i<3*n; ++i)
+   {
+      // mostly in gamut scene values
+      in[i] = 0.02f + 2.0f * powf(float(rand()) / RAND_MAX, 3.0f);
+   }
+   
+   clock_t t0 = clock();
+   pipeline.apply(&in[0], &ref[0], n);
+   clock_t t1 = clock();
+   
+   LUT3D lut;
+   lut.bake(pipeline, 33, Gamma::LogC, 0.0f, 16.0f);
+   clock_t t2 = clock();
+   lut.apply(&in[0], &out[0], n);
+   clock_t t3 = clock();
+   float tetraErr = MaxError(3 * n, &out[0], &ref[0]);
+   
+   lut.setInterpolation(LUT3D::Trilinear);
+   lut.apply(&in[0], &out[0], n);
+   clock_t t4 = clock();
+   float triErr = MaxError(3 * n, &out[0], &ref[0]);
+   lut.setInterpolation(LUT3D::Tetrahedral);
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << "Display transform, " << n << " pixels" << std::endl;
+   std::cout << "  pipeline            " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  bake (33^3, LogC)   " << (t2 - t1) * scale << "ms" << std::endl;
+   std::cout << "  apply tetrahedral   " << (t3 - t2) * scale << "ms, max error " << tetraErr << std::endl;
+   std::cout << "  apply trilinear     " << (t4 - t3) * scale << "ms, max error " << triErr << std::endl;
+   
+   // .cube round trip (shaper + 3D)
+   lut.write("lut3d_test.cube", "gmath test");
+   LUT3D loaded;
+   bool ok = loaded.read("lut3d_test.cube");
+   loaded.apply(&in[0], &ref[0], n);
+   lut.apply(&in[0], &out[0], n);
+   std::cout << ".cube (shaper) read: " << (ok ? "ok" : "failed") << ", error vs baked " << MaxError(3 * n, &out[0], &ref[0]) << std::endl;
+   
+   // custom function, no shaper
+   for (size_t i=0; i<3*n; ++i)
+   {
+      in[i] = float(rand()) / RAND_MAX;
+   }
+   Grade(&in[0], &ref[0], n, 0);
+   LUT3D graded;
+   graded.bake(Grade, 0, 65);
+   graded.apply(&in[0], &out[0], n);
+   std::cout << "Grade + sRGB (65^3) max error " << MaxError(3 * n, &out[0], &ref[0]) << std::endl;
+   
+   graded.write("lut3d_test.cube");
+   ok = loaded.read("lut3d_test.cube");
+   loaded.apply(&in[0], &ref[0], n);
+   std::cout << ".cube read: " << (ok ? "ok" : "failed") << ", error vs baked " << MaxError(3 * n, &out[0], &ref[0]) << std::endl;
+   remove("lut3d_test.cube");
+   
+   return 0;
+}
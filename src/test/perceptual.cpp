@@ -0,0 +1,178 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+template <class In, class Out>
+static void Check(const char *name, const std::vector<float> &in, Out (*scalar)(const In&), bool (*batch)(const float*, float*, size_t, size_t), bool hue=false)
+{
+   size_t n = in.size() / 3;
+   std::vector<float> out(in.size());
+   
+   clock_t t0 = clock();
+   float err = 0.0f;
+   for (size_t i=0; i<n; ++i)
+   {
+      Out o = scalar(In(in[3 * i], in[3 * i + 1], in[3 * i + 2]));
+      out[3 * i] = o[0];
+      out[3 * i + 1] = o[1];
+      out[3 * i + 2] = o[2];
+   }
+   clock_t t1 = clock();
+   std::vector<float> bout(in.size());
+   batch(&in[0], &bout[0], n, 3);
+   clock_t t2 = clock();
+   
+   for (size_t i=0; i<in.size(); ++i)
+   {
+      float d = Abs(out[i] - bout[i]);
+      if (hue && i % 3 == 0)
+      {
+         d = std::min(d, 1.0f - d);
+      }
+      err = std::max(err, d);
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << name << ": per pixel " << (t1 - t0) * scale << "ms, batch " << (t2 - t1) * scale << "ms, max error " << err << std::endl;
+}
+
+// ColorSpace members bound to Rec709
+static LAB XYZtoLAB(const XYZ &c) { return ColorSpace::Rec709.XYZtoLAB(c); }
+static XYZ LABtoXYZ(const LAB &c) { return ColorSpace::Rec709.LABtoXYZ(c); }
+static LUV XYZtoLUV(const XYZ &c) { return ColorSpace::Rec709.XYZtoLUV(c); }
+static XYZ LUVtoXYZ(const LUV &c) { return ColorSpace::Rec709.LUVtoXYZ(c); }
+static bool XYZtoLAB(const float *i, float *o, size_t n, size_t s) { return ColorSpace::Rec709.XYZtoLAB(i, o, n, s); }
+static bool LABtoXYZ(const float *i, float *o, size_t n, size_t s) { return ColorSpace::Rec709.LABtoXYZ(i, o, n, s); }
+static bool XYZtoLUV(const float *i, float *o, size_t n, size_t s) { return ColorSpace::Rec709.XYZtoLUV(i, o, n, s); }
+static bool LUVtoXYZ(const float *i, float *o, size_t n, size_t s) { return ColorSpace::Rec709.LUVtoXYZ(i, o, n, s); }
+
+static HSV ToHSV(const RGB &c) { return RGBtoHSV(c); }
+static HSL ToHSL(const RGB &c) { return RGBtoHSL(c); }
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &cs = ColorSpace::Rec709;
+   
+   size_t n = 1920 * 1080;
+   
+   // in gamut RGB (with some grays and blacks), and the matching XYZ, LAB, LUV, HSV and HSL
+   std::vector<float> rgb(3 * n), xyz(3 * n), lab(3 * n), luv(3 * n), hsv(3 * n), hsl(3 * n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      float *c = &rgb[3 * i];
+      c[0] = float(rand()) / RAND_MAX;
+      c[1] = (i % 97 == 0 ? c[0] : float(rand()) / RAND_MAX);
+      c[2] = (i % 97 == 0 ? c[0] : float(rand()) / RAND_MAX);
+      if (i % 1013 == 0)
+      {
+         c[0] = c[1] = c[2] = 0.0f;
+      }
+   }
+   
+   cs.RGBtoXYZ(&rgb[0], &xyz[0], n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      XYZ c(&xyz[3 * i]);
+      LAB l = cs.XYZtoLAB(c);
+      LUV u = cs.XYZtoLUV(c);
+      HSV v = RGBtoHSV(RGB(&rgb[3 * i]));
+      HSL s = RGBtoHSL(RGB(&rgb[3 * i]));
+      for (int k=0; k<3; ++k)
+      {
+         lab[3 * i + k] = l[k];
+         // scalar LUV is undefined for black
+         luv[3 * i + k] = (c.y > 0.0f ? u[k] : 0.0f);
+         hsv[3 * i + k] = v[k];
+         hsl[3 * i + k] = s[k];
+      }
+   }
+   
+   std::cout << n << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   
+   Check<XYZ, LAB>("XYZtoLAB", xyz, XYZtoLAB, XYZtoLAB);
+   Check<LAB, XYZ>("LABtoXYZ", lab, LABtoXYZ, LABtoXYZ);
+   
+   // skip black for the scalar LUV reference
+   std::vector<float> xyznb, luvnb;
+   for (size_t i=0; i<n; ++i)
+   {
+      if (xyz[3 * i + 1] > 0.0f)
+      {
+         xyznb.insert(xyznb.end(), &xyz[3 * i], &xyz[3 * i + 3]);
+         luvnb.insert(luvnb.end(), &luv[3 * i], &luv[3 * i + 3]);
+      }
+   }
+   Check<XYZ, LUV>("XYZtoLUV", xyznb, XYZtoLUV, XYZtoLUV);
+   Check<LUV, XYZ>("LUVtoXYZ", luvnb, LUVtoXYZ, LUVtoXYZ);
+   
+   Check<RGB, HSV>("RGBtoHSV", rgb, ToHSV, RGBtoHSV, true);
+   Check<HSV, RGB>("HSVtoRGB", hsv, HSVtoRGB, HSVtoRGB);
+   Check<RGB, HSL>("RGBtoHSL", rgb, ToHSL, RGBtoHSL, true);
+   Check<HSL, RGB>("HSLtoRGB", hsl, HSLtoRGB, HSLtoRGB);
+   
+   // round trips through the batch functions, planar
+   std::vector<float> planes(3 * n), tmp(3 * n);
+   for (size_t i=0; i<n; ++i)
+   {
+      for (int c=0; c<3; ++c)
+      {
+         planes[c * n + i] = xyz[3 * i + c];
+      }
+   }
+   const float *pin[3] = {&planes[0], &planes[n], &planes[2 * n]};
+   float *pout[3] = {&tmp[0], &tmp[n], &tmp[2 * n]};
+   
+   cs.XYZtoLUV(pin, pout, n);
+   cs.LUVtoXYZ(pout, pout, n);
+   float lerr = 0.0f;
+   for (size_t i=0; i<3*n; ++i)
+   {
+      lerr = std::max(lerr, Abs(planes[i] - tmp[i]));
+   }
+   std::cout << "LUV planar round trip error " << lerr << std::endl;
+   
+   cs.XYZtoLAB(pin, pout, n);
+   cs.LABtoXYZ(pout, pout, n);
+   lerr = 0.0f;
+   for (size_t i=0; i<3*n; ++i)
+   {
+      lerr = std::max(lerr, Abs(planes[i] - tmp[i]));
+   }
+   std::cout << "LAB planar round trip error " << lerr << std::endl;
+   
+   return 0;
+}
@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/quantizer.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+
+using namespace gmath;
+
+// Smooth gradients with some noise and a few flat areas
+static void MakeImage(std::vector<float> &img, size_t w, size_t h)
+{
+   img.resize(3 * w * h);
+   for (size_t y=0; y<h; ++y)
+   {
+      for (size_t x=0; x<w; ++x)
+      {
+         float *p = &img[3 * (y * w + x)];
+         float u = float(x) / w;
+         float v = float(y) / h;
+         float noise = 0.02f * (float(rand()) / RAND_MAX - 0.5f);
+         if ((x / 256 + y / 256) % 5 == 0)
+         {
+            p[0] = 0.8f;
+            p[1] = 0.1f;
+            p[2] = 0.2f;
+         }
+         else
+         {
+            p[0] = u + noise;
+            p[1] = 0.5f + 0.5f * sinf(6.0f * v) * u + noise;
+            p[2] = 1.0f - v + noise;
+         }
+      }
+   }
+}
+
+static double MeanDeltaE(const ColorQuantizer &q, const std::vector<float> &img, const std::vector<unsigned char> &indices, const ColorSpace &cs)
+{
+   // averaged over 2x2 blocks so dithering counts as what the eye sees
+   double sum = 0.0;
+   size_t n = 0;
+   for (size_t i=0; i+4<=indices.size(); i+=4*97)
+   {
+      RGB a(0.0f), b(0.0f);
+      for (size_t k=0; k<4; ++k)
+      {
+         a += RGB(&img[3 * (i + k)]);
+         b += q.getColor(indices[i + k]);
+      }
+      a /= 4.0f;
+      b /= 4.0f;
+      LAB la = cs.XYZtoLAB(cs.RGBtoXYZ(Gamma::Linearize(a, Gamma::sRGB)));
+      LAB lb = cs.XYZtoLAB(cs.RGBtoXYZ(Gamma::Linearize(b, Gamma::sRGB)));
+      sum += DeltaE76(la, lb);
+      ++n;
+   }
+   return sum / n;
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &cs = ColorSpace::Rec709;
+   size_t w = 3840;
+   size_t h = 2160;
+   size_t n = w * h;
+   
+   std::vector<float> img;
+   MakeImage(img, w, h);
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << w << "x" << h << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   
+   ColorQuantizer q(cs);
+   
+   clock_t t0 = clock();
+   q.addPixels(&img[0], n);
+   clock_t t1 = clock();
+   std::cout << "histogram: " << (t1 - t0) * scale << "ms, " << q.getHistogramColorCount() << " colors" << std::endl;
+   
+   const char *methods[] = {"median cut", "k-means"};
+   const char *dithers[] = {"none", "ordered", "Floyd-Steinberg"};
+   std::vector<unsigned char> indices(n);
+   
+   for (int m=0; m<2; ++m)
+   {
+      t0 = clock();
+      q.buildPalette(256, ColorQuantizer::Method(m));
+      t1 = clock();
+      std::cout << methods[m] << ": " << (t1 - t0) * scale << "ms, " << q.getColorCount() << " colors" << std::endl;
+      
+      for (int d=0; d<3; ++d)
+      {
+         t0 = clock();
+         q.remap(&img[0], w, h, &indices[0], ColorQuantizer::Dither(d));
+         t1 = clock();
+         std::cout << "  remap (" << dithers[d] << "): " << (t1 - t0) * scale << "ms, mean delta E " << MeanDeltaE(q, img, indices, cs) << std::endl;
+      }
+   }
+   
+   // Table lookup versus exact nearest color
+   size_t mismatch = 0;
+   size_t checked = 0;
+   double extra = 0.0;
+   q.remap(&img[0], w, h, &indices[0]);
+   for (size_t i=0; i<n; i+=1013, ++checked)
+   {
+      RGB c(&img[3 * i]);
+      size_t e = q.nearest(c);
+      if (e != indices[i])
+      {
+         ++mismatch;
+         LAB lc = cs.XYZtoLAB(cs.RGBtoXYZ(Gamma::Linearize(RGB(std::min(1.0f, std::max(0.0f, c.r)), std::min(1.0f, std::max(0.0f, c.g)), std::min(1.0f, std::max(0.0f, c.b))), Gamma::sRGB)));
+         extra += DeltaE76(lc, q.getColorLAB(indices[i])) - DeltaE76(lc, q.getColorLAB(e));
+      }
+   }
+   std::cout << "table lookup: " << mismatch << "/" << checked << " differ from exact nearest, mean extra delta E " << (mismatch ? extra / mismatch : 0.0) << std::endl;
+   
+   // Explicit palette
+   RGB bw[2] = {RGB(0.0f, 0.0f, 0.0f), RGB(1.0f, 1.0f, 1.0f)};
+   q.setPalette(bw, 2);
+   std::cout << "black/white palette: " << q.nearest(RGB(0.2f, 0.2f, 0.2f)) << " " << q.nearest(RGB(0.8f, 0.9f, 0.7f)) << " (expected 0 1)" << std::endl;
+   
+   return 0;
+}
@@ -0,0 +1,172 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/spectrum.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   // 5nm sampling against IntegrateVisibleSpectrum
+   SpectralProjection proj;
+   proj.setup(81, 380.0f, 780.0f);
+   
+   float temps[] = {2000.0f, 4000.0f, 6500.0f, 10000.0f};
+   for (size_t t=0; t<sizeof(temps)/sizeof(float); ++t)
+   {
+      Blackbody bb(temps[t]);
+      float spectrum[81];
+      for (int i=0; i<81; ++i)
+      {
+         spectrum[i] = bb(proj.getWavelength(i));
+      }
+      float out[3];
+      proj(spectrum, out);
+      XYZ ref = IntegrateVisibleSpectrum(bb);
+      float err = 0.0f;
+      for (int c=0; c<3; ++c)
+      {
+         err = std::max(err, Abs(out[c] - ref[c]) / ref.y);
+      }
+      std::cout << "Blackbody " << temps[t] << "K, 5nm samples: " << XYZ(out) << " (reference " << ref << ", relative error " << err << ")" << std::endl;
+   }
+   
+   // Coarse non uniform sampling of a smooth spectrum against 1nm sampling
+   SpectralProjection fine, coarse;
+   fine.setup(401, 380.0f, 780.0f, &ColorSpace::Rec709, true);
+   float coarseWavelengths[] = {380.0f, 410.0f, 430.0f, 450.0f, 470.0f, 490.0f, 510.0f, 530.0f, 550.0f,
+                                570.0f, 590.0f, 610.0f, 630.0f, 660.0f, 700.0f, 780.0f};
+   coarse.setup(coarseWavelengths, 16, &ColorSpace::Rec709, true);
+   {
+      std::vector<float> fs(401), cs(16);
+      for (size_t i=0; i<401; ++i)
+      {
+         float l = fine.getWavelength(i);
+         fs[i] = 0.5f + 0.4f * sinf((l - 380.0f) / 60.0f);
+      }
+      for (size_t i=0; i<16; ++i)
+      {
+         float l = coarse.getWavelength(i);
+         cs[i] = 0.5f + 0.4f * sinf((l - 380.0f) / 60.0f);
+      }
+      float fo[3], co[3];
+      fine(&fs[0], fo);
+      coarse(&cs[0], co);
+      std::cout << "Smooth spectrum RGB, 1nm: " << RGB(fo) << ", 16 samples: " << RGB(co) << std::endl;
+      
+      float flat[401];
+      for (int i=0; i<401; ++i)
+      {
+         flat[i] = 1.0f;
+      }
+      fine(flat, fo);
+      std::cout << "Constant spectrum RGB (normalized): " << RGB(fo) << std::endl;
+   }
+   
+   // Batch projection
+   size_t nsamples = 32;
+   size_t n = 1 << 20;
+   SpectralProjection render;
+   render.setup(nsamples, 400.0f, 700.0f, &ColorSpace::Rec709, true);
+   
+   std::vector<float> spectra(n * nsamples);
+   for (size_t i=0; i<spectra.size(); ++i)
+   {
+      spectra[i] = float(rand()) / RAND_MAX;
+   }
+   std::vector<float> out(3 * n), ref(3 * n);
+   
+   clock_t t0 = clock();
+   for (size_t i=0; i<n; ++i)
+   {
+      const float *s = &spectra[i * nsamples];
+      for (int c=0; c<3; ++c)
+      {
+         float sum = 0.0f;
+         for (size_t j=0; j<nsamples; ++j)
+         {
+            sum += s[j] * render.getWeight(j, c);
+         }
+         ref[3 * i + c] = sum;
+      }
+   }
+   clock_t t1 = clock();
+   render.apply(&spectra[0], &out[0], n);
+   clock_t t2 = clock();
+   
+   float err = 0.0f;
+   for (size_t i=0; i<3*n; ++i)
+   {
+      err = std::max(err, Abs(out[i] - ref[i]));
+   }
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   std::cout << n << " spectra of " << nsamples << " samples, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   std::cout << "  per spectrum loop " << (t1 - t0) * scale << "ms" << std::endl;
+   std::cout << "  batch             " << (t2 - t1) * scale << "ms, error " << err << std::endl;
+   
+   // RGB to spectrum to RGB
+   std::vector<float> rgb(3 * n);
+   for (size_t i=0; i<rgb.size(); ++i)
+   {
+      rgb[i] = float(rand()) / RAND_MAX;
+   }
+   t0 = clock();
+   render.upsample(&rgb[0], &spectra[0], n);
+   t1 = clock();
+   render.apply(&spectra[0], &out[0], n);
+   
+   err = 0.0f;
+   float smin = 1.0f, smax = 0.0f;
+   for (size_t i=0; i<3*n; ++i)
+   {
+      err = std::max(err, Abs(out[i] - rgb[i]));
+   }
+   for (size_t i=0; i<n*nsamples; ++i)
+   {
+      smin = std::min(smin, spectra[i]);
+      smax = std::max(smax, spectra[i]);
+   }
+   std::cout << "  upsample          " << (t1 - t0) * scale << "ms, round trip error " << err << ", spectra in [" << smin << ", " << smax << "]" << std::endl;
+   
+   float primaries[][3] = {{1, 1, 1}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {0.5f, 0.5f, 0.5f}};
+   for (int p=0; p<5; ++p)
+   {
+      RGB c(primaries[p]);
+      float o[3];
+      render.upsample(c, &spectra[0]);
+      render(&spectra[0], o);
+      std::cout << "  " << c << " -> " << RGB(o) << std::endl;
+   }
+   
+   return 0;
+}
@@ -0,0 +1,119 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/stft.h>
+
+using namespace gmath;
+
+struct Resynthesis
+{
+   ISTFT<float> *istft;
+   std::vector<float> *output;
+   int peakBin;
+};
+
+static void OnFrame(const Complex<float> *bins, int nbins, long frame, void *userData)
+{
+   Resynthesis *rs = (Resynthesis*) userData;
+   
+   if (frame == 8)
+   {
+      float peak = 0.0f;
+      for (int k=0; k<nbins; ++k)
+      {
+         if (bins[k].squaredNorm() > peak)
+         {
+            peak = bins[k].squaredNorm();
+            rs->peakBin = k;
+         }
+      }
+   }
+   
+   size_t off = rs->output->size();
+   rs->output->resize(off + rs->istft->getHopSize());
+   rs->istft->process(bins, &((*rs->output)[off]));
+}
+
+int main(int, char**)
+{
+   const int N = 512;
+   const int hop = 128;
+   const int length = 20000;
+   const float freq = 40.0f / N; // cycles per sample, bin 40
+   
+   std::vector<float> signal(length);
+   for (int i=0; i<length; ++i)
+   {
+      signal[i] = 0.7f * sin(2.0f * PI * freq * i) + 0.2f * sin(0.013f * i);
+   }
+   
+   WindowFunction windows[] = {WF_Hann, WF_Blackman, WF_BlackmanHarris};
+   const char* names[] = {"Hann", "Blackman", "Blackman-Harris"};
+   
+   for (int w=0; w<3; ++w)
+   {
+      STFT<float> stft;
+      ISTFT<float> istft;
+      std::vector<float> output;
+      Resynthesis rs = {&istft, &output, -1};
+      
+      output.reserve(length);
+      
+      stft.setup(N, hop, windows[w]);
+      istft.setup(N, hop, windows[w]);
+      stft.setCallback(OnFrame, &rs);
+      
+      // feed odd sized chunks, half of them through the zero-copy interface
+      int frames = 0;
+      for (int i=0, chunk=0; i<length; i+=chunk)
+      {
+         chunk = std::min(333, length - i);
+         if ((i / 333) % 2 == 0)
+         {
+            frames += stft.push(chunk, &signal[i]);
+         }
+         else
+         {
+            int available = 0;
+            float *buffer = stft.getWriteBuffer(available);
+            chunk = std::min(chunk, available);
+            std::copy(signal.begin() + i, signal.begin() + i + chunk, buffer);
+            frames += stft.commit(chunk);
+         }
+      }
+      
+      float err = 0.0f;
+      for (size_t i=N-hop; i<output.size(); ++i)
+      {
+         err = std::max(err, Abs(output[i] - signal[i]));
+      }
+      
+      std::cout << names[w] << " window: " << frames << " frames, peak bin " << rs.peakBin << " (expected 40), ";
+      std::cout << "resynthesis max error " << err << std::endl;
+   }
+   
+   return 0;
+}
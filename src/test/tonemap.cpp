@@ -0,0 +1,254 @@
+/*
+MIT License
+
+Copyright (c) 2026 Gaetan Guidet
+
+This file is part of gmath.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gmath/color.h>
+#include <gmath/parallel.h>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+
+using namespace gmath;
+
+// Chromaticity based reference (keep x, y and replace Y)
+static RGB Reference(const ToneMappingOperator &tmo, float Lout(float, const Params&), const Params &params, const RGB &rgb)
+{
+   const ColorSpace &cs = tmo.getColorSpace();
+   XYZ xyz = cs.RGBtoXYZ(rgb);
+   Chromaticity c = XYZtoChromaticity(xyz, cs.getWhitePoint());
+   return cs.XYZtoRGB(ChromaticityYtoXYZ(c, Lout(xyz.y, params)));
+}
+
+static float SimpleL(float L, const Params &)
+{
+   return L / (1.0f + L);
+}
+
+static float LinearL(float L, const Params &p)
+{
+   float Lmax = 1.0f;
+   p.get("Lmax", Lmax);
+   return L / Lmax;
+}
+
+static float GammaL(float L, const Params &p)
+{
+   float gain = 1.0f, gamma = 1.0f;
+   p.get("gain", gain);
+   p.get("gamma", gamma);
+   return gain * powf(L, gamma);
+}
+
+static float ReinhardL(float L, const Params &p)
+{
+   float key = 0.18f, Lavg = 1.0f, Lwht = 0.0f;
+   p.get("key", key);
+   p.get("Lavg", Lavg);
+   p.get("Lwht", Lwht);
+   L = key * L / Lavg;
+   return (Lwht > 0.000001f ? L * (1.0f + L / (Lwht * Lwht)) / (1.0f + L) : L / (1.0f + L));
+}
+
+int main(int, char**)
+{
+   srand(1234);
+   
+   const ColorSpace &cs = ColorSpace::Rec709;
+   
+   size_t n = 1920 * 1080;
+   
+   std::vector<RGB> in(n), out(n), ref(n);
+   
+   for (size_t i=0; i<n; ++i)
+   {
+      // HDR values, a few black pixels to hit the white point fallback
+      float s = (i % 1000 == 0 ? 0.0f : 8.0f);
+      in[i] = RGB(s * float(rand()) / RAND_MAX, s * float(rand()) / RAND_MAX, s * float(rand()) / RAND_MAX);
+   }
+   
+   struct
+   {
+      const char *name;
+      ToneMappingOperator::Method method;
+      float (*Lout)(float, const Params&);
+   } methods[] = {{"Simple", ToneMappingOperator::Simple, SimpleL},
+                  {"Linear", ToneMappingOperator::Linear, LinearL},
+                  {"Gamma", ToneMappingOperator::Gamma, GammaL},
+                  {"Reinhard", ToneMappingOperator::Reinhard, ReinhardL}};
+   
+   Params params;
+   params.set("Lmax", 8.0f);
+   params.set("gain", 0.8f);
+   params.set("gamma", 0.45f);
+   params.set("key", 0.18f);
+   params.set("Lavg", 0.5f);
+   params.set("Lwht", 6.0f);
+   
+   double scale = 1000.0 / CLOCKS_PER_SEC;
+   
+   std::cout << n << " pixels, " << Parallel::GetThreadCount() << " thread(s)" << std::endl;
+   
+   for (int m=0; m<4; ++m)
+   {
+      ToneMappingOperator tmo(cs);
+      tmo.setMethod(methods[m].method, params);
+      
+      clock_t t0 = clock();
+      for (size_t i=0; i<n; ++i)
+      {
+         ref[i] = tmo(in[i]);
+      }
+      clock_t t1 = clock();
+      out = in;
+      tmo.apply(&out[0], n);
+      clock_t t2 = clock();
+      
+      // relative to the output luminance, with an absolute floor for dark pixels
+      float err = 0.0f;
+      float rerr = 0.0f;
+      for (size_t i=0; i<n; ++i)
+      {
+         RGB r = Reference(tmo, methods[m].Lout, params, in[i]);
+         float d = 0.0f;
+         float e = 0.0f;
+         for (int c=0; c<3; ++c)
+         {
+            d = std::max(d, Abs(out[i][c] - ref[i][c]));
+            e = std::max(e, Abs(out[i][c] - r[c]));
+         }
+         float Y = std::max(cs.luminance(r), 0.01f);
+         err = std::max(err, d / Y);
+         rerr = std::max(rerr, e / Y);
+      }
+      
+      std::cout << methods[m].name << std::endl;
+      std::cout << "  per pixel calls " << (t1 - t0) * scale << "ms" << std::endl;
+      std::cout << "  batch apply     " << (t2 - t1) * scale << "ms, error " << err << " (vs chromaticity reference " << rerr << ")" << std::endl;
+   }
+   
+   // black pixels with gamma < 1 (L^(gamma - 1) is infinite at L = 0)
+   {
+      Params gp;
+      gp.set("gain", 1.0f);
+      gp.set("gamma", 0.5f);
+      ToneMappingOperator tmo(cs);
+      tmo.setMethod(ToneMappingOperator::Gamma, gp);
+      
+      std::vector<float> black(3 * 8, 0.0f);
+      tmo.apply(&black[0], &black[0], 8);
+      RGB single = tmo(RGB(0.0f, 0.0f, 0.0f));
+      
+      bool ok = (single.r == 0.0f && single.g == 0.0f && single.b == 0.0f);
+      for (size_t i=0; i<black.size(); ++i)
+      {
+         ok = ok && (black[i] == 0.0f);
+      }
+      std::cout << "Gamma 0.5 keeps black: " << (ok ? "yes" : "no") << " (" << single.r << " " << single.g << " " << single.b << ")" << std::endl;
+   }
+   
+   // switching back to Undefined leaves pixels untouched
+   {
+      Params rp;
+      rp.set("Lavg", 0.5f);
+      ToneMappingOperator tmo(cs);
+      tmo.setMethod(ToneMappingOperator::Reinhard, rp);
+      tmo.setMethod(ToneMappingOperator::Undefined);
+      
+      std::vector<float> in(3 * 8);
+      std::vector<float> out(3 * 8, -1.0f);
+      for (size_t i=0; i<in.size(); ++i)
+      {
+         in[i] = 0.25f * float(i);
+      }
+      tmo.apply(&in[0], &out[0], 8);
+      std::cout << "Reinhard -> Undefined apply is identity: " << (out == in ? "yes" : "no") << std::endl;
+   }
+   
+   // local operator
+   {
+      size_t w = 1920;
+      size_t h = 1080;
+      std::vector<float> img(3 * w * h), lout(3 * w * h);
+      
+      // dark room with a bright window
+      for (size_t y=0; y<h; ++y)
+      {
+         for (size_t x=0; x<w; ++x)
+         {
+            bool window = (x > w / 2 && x < 3 * w / 4 && y > h / 4 && y < h / 2);
+            float v = (window ? 50.0f : 0.05f) * (0.5f + 0.5f * float(rand()) / RAND_MAX);
+            for (int c=0; c<3; ++c)
+            {
+               img[3 * (y * w + x) + c] = v * (c == 0 ? 1.0f : 0.8f);
+            }
+         }
+      }
+      
+      ToneMappingOperator local(cs);
+      ToneMappingOperator global(cs);
+      local.setMethod(ToneMappingOperator::ReinhardLocal, params);
+      global.setMethod(ToneMappingOperator::Reinhard, params);
+      
+      clock_t t0 = clock();
+      local.applyImage(&img[0], &lout[0], w, h);
+      clock_t t1 = clock();
+      
+      std::cout << "ReinhardLocal " << w << "x" << h << " " << (t1 - t0) * scale << "ms" << std::endl;
+      
+      Parallel::SetThreadCount(1);
+      std::vector<float> lout1(3 * w * h);
+      local.applyImage(&img[0], &lout1[0], w, h);
+      Parallel::SetThreadCount(4);
+      std::vector<float> lout4(3 * w * h);
+      local.applyImage(&img[0], &lout4[0], w, h);
+      std::cout << "  1 vs 4 threads identical: " << (lout1 == lout4 && lout1 == lout ? "yes" : "no") << std::endl;
+      
+      // constant image: no neighbourhood effect, same as global Reinhard
+      std::vector<float> flat(3 * 64 * 64, 0.3f), flout(3 * 64 * 64), fgout(3 * 64 * 64);
+      local.applyImage(&flat[0], &flout[0], 64, 64);
+      global.applyImage(&flat[0], &fgout[0], 64, 64);
+      float ferr = 0.0f;
+      for (size_t i=0; i<flat.size(); ++i)
+      {
+         ferr = std::max(ferr, Abs(flout[i] - fgout[i]));
+      }
+      std::cout << "  flat image error vs Reinhard " << ferr << std::endl;
+   }
+   
+   // invalid operator leaves pixels untouched, planar layout
+   ToneMappingOperator invalid(cs);
+   invalid.setMethod(ToneMappingOperator::Reinhard);
+   std::vector<float> planes(3 * 16), oplanes(3 * 16, -1.0f);
+   for (size_t i=0; i<planes.size(); ++i)
+   {
+      planes[i] = float(i);
+   }
+   const float *pin[3] = {&planes[0], &planes[16], &planes[32]};
+   float *pout[3] = {&oplanes[0], &oplanes[16], &oplanes[32]};
+   invalid.apply(pin, pout, 16);
+   std::cout << "Invalid operator is identity: " << (planes == oplanes ? "yes" : "no") << std::endl;
+   
+   return 0;
+}